@@ -14,6 +14,10 @@ list(APPEND JR_DEPENDENCY_LIBS ${ROOT_LIBRARIES})
 include(${ROOT_USE_FILE})
 message(STATUS "Found ROOT")
 
+## threads - used by the ParallelReader
+find_package(Threads REQUIRED)
+list(APPEND JR_DEPENDENCY_LIBS ${CMAKE_THREAD_LIBS_INIT})
+
 ## StPicoEvent
 add_subdirectory(third_party/StPicoEvent)
 list(APPEND JR_DEPENDENCY_LIBS ${PICO_LIBS})
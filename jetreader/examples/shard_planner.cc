@@ -0,0 +1,58 @@
+// plans the split of a picoDst chain into balanced batch jobs. Prints the
+// entry range of each shard; a job can then read its shard with
+// Reader::setShard(index, count), which computes the same plan, or with
+// Reader::setEntryRange(begin, end).
+//
+// usage: shard_planner <input file or file list> <number of shards>
+//                      [bad run list]
+//
+// When a bad run list is given, the run IDs of the chain are scanned (and
+// saved as a run index next to the input, see Reader::useRunIndex()), and
+// entries in bad runs are counted as cheap.
+
+#include "jetreader/reader/reader.h"
+#include "jetreader/reader/shard_planner.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+int main(int argc, char *argv[]) {
+  if (argc < 3 || argc > 4) {
+    std::cerr << "usage: " << argv[0]
+              << " <input file or file list> <number of shards> "
+                 "[bad run list]"
+              << std::endl;
+    return 1;
+  }
+
+  std::string input = argv[1];
+  int count = std::atoi(argv[2]);
+  if (count <= 0) {
+    std::cerr << "number of shards must be positive" << std::endl;
+    return 1;
+  }
+
+  jetreader::Reader reader(input);
+  if (argc == 4) {
+    reader.eventSelector()->addBadRuns(std::string(argv[3]));
+    reader.useRunIndex(true);
+  }
+  reader.init();
+
+  jetreader::ShardPlanner planner;
+  if (reader.runIndexActive())
+    planner.addRuns(reader.runIndex(), reader.eventSelector()->badRuns());
+  else
+    planner.addEntries(reader.entries());
+
+  std::cout << "# " << planner.entries() << " entries, estimated cost "
+            << planner.cost() << std::endl;
+  std::cout << "# shard begin end cost" << std::endl;
+  for (int i = 0; i < count; ++i) {
+    auto shard = planner.shard(i, count);
+    std::cout << i << " " << shard.begin << " " << shard.end << " "
+              << shard.cost << std::endl;
+  }
+  return 0;
+}
@@ -31,13 +31,16 @@ int main() {
 
   reader.towerSelector()->setEtMax(30.0);
 
-  // turn off branches that don't exist in this tree (not necessary) and
-  // initialize the reader
-  reader.SetStatus("BEmcSmdEHit", false);
-  reader.SetStatus("BEmcSmdPHit", false);
-  reader.Init();
+  // initialize the reader - branches that aren't used to build events are
+  // turned off
+  reader.init();
   reader.writeConfig("example.yaml");
 
+  std::cout << "active branches:";
+  for (auto &branch : reader.activeBranches())
+    std::cout << " " << branch;
+  std::cout << std::endl;
+
   std::cout << "number of events in chain: " << reader.tree()->GetEntries()
             << std::endl;
 
@@ -0,0 +1,122 @@
+#ifndef JETREADER_LIB_BOUNDED_QUEUE_H
+#define JETREADER_LIB_BOUNDED_QUEUE_H
+
+// a fixed-capacity, thread-safe FIFO queue used to hand off work between
+// threads. Producers block when the queue is full, consumers block when it is
+// empty. Once the queue is closed, push() fails and pop() drains the remaining
+// elements before failing. The elements are stored in a ring buffer that is
+// allocated once, so T must be default constructible, and pushing and popping
+// never allocate.
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace jetreader {
+
+template <typename T> class BoundedQueue {
+public:
+  explicit BoundedQueue(size_t capacity)
+      : slots_(capacity > 0 ? capacity : 1), head_(0), size_(0),
+        closed_(false) {}
+
+  // adds value to the end of the queue, blocking while the queue is full.
+  // Returns false if the queue has been closed, in which case value is
+  // discarded
+  bool push(T &&value) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_full_.wait(lock,
+                   [this] { return closed_ || size_ < slots_.size(); });
+    if (closed_)
+      return false;
+    pushBack(std::move(value));
+    lock.unlock();
+    not_empty_.notify_one();
+    return true;
+  }
+
+  // as push(), but returns false instead of blocking if the queue is full
+  bool tryPush(T &&value) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (closed_ || size_ == slots_.size())
+      return false;
+    pushBack(std::move(value));
+    lock.unlock();
+    not_empty_.notify_one();
+    return true;
+  }
+
+  // removes the first element of the queue and moves it into value, blocking
+  // while the queue is empty. Returns false when the queue is closed and no
+  // elements remain
+  bool pop(T &value) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_empty_.wait(lock, [this] { return closed_ || size_ > 0; });
+    if (size_ == 0)
+      return false;
+    popFront(value);
+    lock.unlock();
+    not_full_.notify_one();
+    return true;
+  }
+
+  // as pop(), but returns false instead of blocking if the queue is empty
+  bool tryPop(T &value) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (size_ == 0)
+      return false;
+    popFront(value);
+    lock.unlock();
+    not_full_.notify_one();
+    return true;
+  }
+
+  // closes the queue and wakes up all waiting producers and consumers
+  void close() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closed_ = true;
+    }
+    not_full_.notify_all();
+    not_empty_.notify_all();
+  }
+
+  bool closed() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return closed_;
+  }
+
+  size_t size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return size_;
+  }
+
+  size_t capacity() const { return slots_.size(); }
+
+private:
+  // must be called with mutex_ held
+  void pushBack(T &&value) {
+    slots_[(head_ + size_) % slots_.size()] = std::move(value);
+    ++size_;
+  }
+  void popFront(T &value) {
+    value = std::move(slots_[head_]);
+    head_ = (head_ + 1) % slots_.size();
+    --size_;
+  }
+
+  std::vector<T> slots_;
+  size_t head_;
+  size_t size_;
+  bool closed_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable not_full_;
+  std::condition_variable not_empty_;
+};
+
+} // namespace jetreader
+
+#endif // JETREADER_LIB_BOUNDED_QUEUE_H
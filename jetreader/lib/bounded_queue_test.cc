@@ -0,0 +1,91 @@
+#include "gtest/gtest.h"
+
+#include <thread>
+#include <vector>
+
+#include "jetreader/lib/bounded_queue.h"
+
+TEST(BoundedQueue, FIFO) {
+  jetreader::BoundedQueue<int> queue(5);
+  for (int i = 0; i < 5; ++i)
+    EXPECT_TRUE(queue.push(int(i)));
+  EXPECT_EQ(queue.size(), 5);
+
+  int value = -1;
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_TRUE(queue.pop(value));
+    EXPECT_EQ(value, i);
+  }
+  EXPECT_EQ(queue.size(), 0);
+}
+
+TEST(BoundedQueue, Close) {
+  jetreader::BoundedQueue<int> queue(5);
+  queue.push(1);
+  queue.push(2);
+  queue.close();
+
+  EXPECT_TRUE(queue.closed());
+  EXPECT_FALSE(queue.push(3));
+
+  int value = -1;
+  EXPECT_TRUE(queue.pop(value));
+  EXPECT_EQ(value, 1);
+  EXPECT_TRUE(queue.pop(value));
+  EXPECT_EQ(value, 2);
+  EXPECT_FALSE(queue.pop(value));
+}
+
+TEST(BoundedQueue, ProducerConsumer) {
+  const int n_producers = 4;
+  const int n_values = 1000;
+  jetreader::BoundedQueue<int> queue(8);
+
+  std::vector<std::thread> producers;
+  for (int i = 0; i < n_producers; ++i) {
+    producers.emplace_back([&queue, i, n_values] {
+      for (int j = 0; j < n_values; ++j)
+        queue.push(int(i * n_values + j));
+    });
+  }
+
+  std::thread closer([&producers, &queue] {
+    for (auto &producer : producers)
+      producer.join();
+    queue.close();
+  });
+
+  std::vector<int> seen(n_producers * n_values, 0);
+  int value = -1;
+  while (queue.pop(value))
+    seen[value]++;
+  closer.join();
+
+  for (auto &count : seen)
+    EXPECT_EQ(count, 1);
+}
+
+TEST(BoundedQueue, TryPushTryPop) {
+  jetreader::BoundedQueue<int> queue(2);
+  int value = -1;
+  EXPECT_FALSE(queue.tryPop(value));
+  EXPECT_EQ(value, -1);
+
+  EXPECT_TRUE(queue.tryPush(1));
+  EXPECT_TRUE(queue.tryPush(2));
+  EXPECT_FALSE(queue.tryPush(3));
+  EXPECT_EQ(queue.size(), 2);
+
+  // the ring buffer wraps around
+  EXPECT_TRUE(queue.tryPop(value));
+  EXPECT_EQ(value, 1);
+  EXPECT_TRUE(queue.tryPush(4));
+  EXPECT_TRUE(queue.tryPop(value));
+  EXPECT_EQ(value, 2);
+  EXPECT_TRUE(queue.tryPop(value));
+  EXPECT_EQ(value, 4);
+  EXPECT_FALSE(queue.tryPop(value));
+
+  queue.close();
+  EXPECT_FALSE(queue.tryPush(5));
+}
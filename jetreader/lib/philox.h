@@ -0,0 +1,48 @@
+#ifndef JETREADER_LIB_PHILOX_H
+#define JETREADER_LIB_PHILOX_H
+
+// the Philox4x32-10 counter-based random number generator, from Salmon et al.,
+// "Parallel random numbers: as easy as 1, 2, 3" (SC11). Each output is a pure
+// function of a 128 bit counter and a 64 bit key, so random numbers can be
+// drawn for any counter in any order, from any thread, without shared state.
+
+#include <array>
+#include <cstdint>
+
+namespace jetreader {
+
+typedef std::array<uint32_t, 4> PhiloxCounter;
+typedef std::array<uint32_t, 2> PhiloxKey;
+
+namespace philox_detail {
+
+inline void Round(PhiloxCounter &ctr, const PhiloxKey &key) {
+  uint64_t product0 = (uint64_t)0xD2511F53 * ctr[0];
+  uint64_t product1 = (uint64_t)0xCD9E8D57 * ctr[2];
+  uint32_t hi0 = product0 >> 32, lo0 = (uint32_t)product0;
+  uint32_t hi1 = product1 >> 32, lo1 = (uint32_t)product1;
+  ctr = {{hi1 ^ ctr[1] ^ key[0], lo1, hi0 ^ ctr[3] ^ key[1], lo0}};
+}
+
+} // namespace philox_detail
+
+// four random 32 bit words for counter and key
+inline PhiloxCounter Philox4x32(PhiloxCounter ctr, PhiloxKey key) {
+  philox_detail::Round(ctr, key);
+  for (int round = 1; round < 10; ++round) {
+    key[0] += 0x9E3779B9;
+    key[1] += 0xBB67AE85;
+    philox_detail::Round(ctr, key);
+  }
+  return ctr;
+}
+
+// a uniform double in [0, 1) from the 53 high bits of two random words
+inline double PhiloxUniform(uint32_t hi, uint32_t lo) {
+  uint64_t bits = ((uint64_t)hi << 32 | lo) >> 11;
+  return bits * (1.0 / 9007199254740992.0); // 2^-53
+}
+
+} // namespace jetreader
+
+#endif // JETREADER_LIB_PHILOX_H
@@ -0,0 +1,43 @@
+#include "gtest/gtest.h"
+
+#include "jetreader/lib/philox.h"
+
+#include <cstdint>
+#include <set>
+
+TEST(Philox, KnownAnswers) {
+  // known answer tests of the Random123 reference implementation
+  EXPECT_EQ(jetreader::Philox4x32({{0, 0, 0, 0}}, {{0, 0}}),
+            (jetreader::PhiloxCounter{
+                {0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}}));
+  EXPECT_EQ(jetreader::Philox4x32(
+                {{0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}},
+                {{0xffffffff, 0xffffffff}}),
+            (jetreader::PhiloxCounter{
+                {0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}}));
+  EXPECT_EQ(jetreader::Philox4x32(
+                {{0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}},
+                {{0xa4093822, 0x299f31d0}}),
+            (jetreader::PhiloxCounter{
+                {0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}}));
+}
+
+TEST(Philox, Uniform) {
+  EXPECT_EQ(jetreader::PhiloxUniform(0, 0), 0.0);
+  EXPECT_LT(jetreader::PhiloxUniform(0xffffffff, 0xffffffff), 1.0);
+  EXPECT_EQ(jetreader::PhiloxUniform(0x80000000, 0), 0.5);
+
+  // neighbouring counters give unrelated values, spread over [0, 1)
+  std::set<double> values;
+  double sum = 0.0;
+  for (uint32_t i = 0; i < 10000; ++i) {
+    auto words = jetreader::Philox4x32({{i, 0, 0, 0}}, {{1, 2}});
+    double value = jetreader::PhiloxUniform(words[0], words[1]);
+    EXPECT_GE(value, 0.0);
+    EXPECT_LT(value, 1.0);
+    values.insert(value);
+    sum += value;
+  }
+  EXPECT_EQ(values.size(), 10000);
+  EXPECT_NEAR(sum / 10000, 0.5, 0.01);
+}
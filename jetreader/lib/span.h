@@ -0,0 +1,37 @@
+#ifndef JETREADER_LIB_SPAN_H
+#define JETREADER_LIB_SPAN_H
+
+// a non-owning view of a contiguous array, in the spirit of C++20 std::span.
+// The viewed memory must outlive the Span.
+
+#include <cstddef>
+
+namespace jetreader {
+
+template <typename T> class Span {
+public:
+  typedef T value_type;
+  typedef T *iterator;
+
+  Span() : data_(nullptr), size_(0) {}
+  Span(T *data, size_t size) : data_(data), size_(size) {}
+
+  T *data() const { return data_; }
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  T &operator[](size_t i) const { return data_[i]; }
+  T &front() const { return data_[0]; }
+  T &back() const { return data_[size_ - 1]; }
+
+  iterator begin() const { return data_; }
+  iterator end() const { return data_ + size_; }
+
+private:
+  T *data_;
+  size_t size_;
+};
+
+} // namespace jetreader
+
+#endif // JETREADER_LIB_SPAN_H
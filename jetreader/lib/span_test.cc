@@ -0,0 +1,25 @@
+#include "gtest/gtest.h"
+
+#include "jetreader/lib/span.h"
+
+#include <numeric>
+#include <vector>
+
+TEST(Span, View) {
+  std::vector<int> values{1, 2, 3, 4, 5};
+  jetreader::Span<const int> span(values.data() + 1, 3);
+  EXPECT_EQ(span.size(), 3);
+  EXPECT_FALSE(span.empty());
+  EXPECT_EQ(span.front(), 2);
+  EXPECT_EQ(span.back(), 4);
+  EXPECT_EQ(span[1], 3);
+  EXPECT_EQ(std::accumulate(span.begin(), span.end(), 0), 9);
+
+  // the span views the original memory
+  values[2] = 10;
+  EXPECT_EQ(span[1], 10);
+
+  jetreader::Span<int> empty;
+  EXPECT_TRUE(empty.empty());
+  EXPECT_EQ(empty.begin(), empty.end());
+}
@@ -2,100 +2,292 @@
 
 #include "jetreader/lib/assert.h"
 
+#include <array>
 #include <cmath>
 
 namespace jetreader {
 
-BemcHelper::BemcHelper()
-    : modules_(120), tow_per_module_phi_(2), tow_per_module_eta_(20),
-      eta_min_(0.0035), eta_max_(0.984), barrel_radius_(225.405),
-      half_width_module_(11.174) {
+constexpr unsigned BemcHelper::TOWERS;
+constexpr unsigned BemcHelper::ETA_RINGS;
+constexpr unsigned BemcHelper::PHI_COLUMNS;
+constexpr unsigned BemcHelper::MAX_NEIGHBOURS;
 
-  tow_per_module_ = tow_per_module_eta_ * tow_per_module_phi_;
-  towers_ = tow_per_module_ * modules_;
+namespace {
 
-  eta_bounds_.resize(tow_per_module_eta_ + 1);
-  for (int i = 0; i <= tow_per_module_eta_; ++i)
-    eta_bounds_[i] = 0.05 * i;
-  eta_bounds_[0] = eta_min_;
-  eta_bounds_[tow_per_module_eta_] = eta_max_;
+constexpr unsigned modules = 120;           // total number of modules
+constexpr unsigned tow_per_module_phi = 2;  // towers in module in phi
+constexpr unsigned tow_per_module_eta = 20; // towers in module in eta
+constexpr unsigned tow_per_module = tow_per_module_eta * tow_per_module_phi;
+constexpr unsigned towers = tow_per_module * modules;
+static_assert(towers == BemcHelper::TOWERS, "unexpected BEMC layout");
 
-  eta_center_.resize(tow_per_module_eta_);
-  for (int i = 0; i < tow_per_module_eta_; ++i)
-    eta_center_[i] = (eta_bounds_[i] + eta_bounds_[i + 1]) / 2.0;
+// detector length constants
+constexpr double barrel_radius = 225.405;    // radius of barrel
+constexpr double half_width_module = 11.174; // half-width of module
 
+// internal and external boundaries for the modules in eta
+constexpr double eta_min = 0.0035;
+constexpr double eta_max = 0.984;
+
+// the integer layout of the barrel, and the tower eta, which only needs
+// arithmetic, are generated at compile time
+struct Layout {
+  std::array<unsigned char, towers> module;
+  std::array<unsigned char, towers> module_eta;
+  std::array<unsigned char, towers> module_phi;
+  std::array<unsigned char, towers> eta_ring;
+  std::array<unsigned char, towers> phi_column;
+  std::array<double, towers> eta;
+  // tower id at (eta ring, phi column)
+  std::array<unsigned, BemcHelper::ETA_RINGS * BemcHelper::PHI_COLUMNS> grid;
+  std::array<unsigned, towers * BemcHelper::MAX_NEIGHBOURS> neighbours;
+  std::array<unsigned char, towers> neighbour_count;
+};
+
+constexpr Layout MakeLayout() {
+  // tower boundaries and centers in eta, on one side of the TPC
+  double eta_bounds[tow_per_module_eta + 1] = {};
+  for (unsigned i = 0; i <= tow_per_module_eta; ++i)
+    eta_bounds[i] = 0.05 * i;
+  eta_bounds[0] = eta_min;
+  eta_bounds[tow_per_module_eta] = eta_max;
+
+  Layout layout = {};
+  for (unsigned idx = 0; idx < towers; ++idx) {
+    unsigned module = idx / tow_per_module;
+    unsigned local_tower_id = idx - tow_per_module * module;
+    unsigned module_phi = local_tower_id / tow_per_module_eta;
+    unsigned module_eta = local_tower_id % tow_per_module_eta;
+    layout.module[idx] = module;
+    layout.module_eta[idx] = module_eta;
+    layout.module_phi[idx] = module_phi;
+
+    double eta =
+        (eta_bounds[module_eta] + eta_bounds[module_eta + 1]) / 2.0;
+    // modules 0-59 cover positive eta, 60-119 negative eta. Phi decreases with
+    // the module on the positive side, starting at 72 degrees, and increases
+    // on the negative side, starting at 108 degrees. Modules are 6 degrees, or
+    // 2 columns, wide
+    int column = 0;
+    if (module < modules / 2) {
+      layout.eta_ring[idx] = tow_per_module_eta + module_eta;
+      column = (72 + 180) / 3 - 2 * (int)module - (int)module_phi;
+    } else {
+      eta *= -1.0;
+      layout.eta_ring[idx] = tow_per_module_eta - 1 - module_eta;
+      column = (108 + 180) / 3 + 2 * (int)(module - modules / 2) +
+               (int)module_phi - 1;
+    }
+    column = (column % (int)BemcHelper::PHI_COLUMNS +
+              (int)BemcHelper::PHI_COLUMNS) %
+             (int)BemcHelper::PHI_COLUMNS;
+    layout.phi_column[idx] = column;
+    layout.eta[idx] = eta;
+    layout.grid[layout.eta_ring[idx] * BemcHelper::PHI_COLUMNS + column] =
+        idx + 1;
+  }
+
+  for (unsigned idx = 0; idx < towers; ++idx) {
+    int ring = layout.eta_ring[idx];
+    int column = layout.phi_column[idx];
+    unsigned count = 0;
+    for (int d_ring = -1; d_ring <= 1; ++d_ring) {
+      if (ring + d_ring < 0 || ring + d_ring >= (int)BemcHelper::ETA_RINGS)
+        continue;
+      for (int d_column = -1; d_column <= 1; ++d_column) {
+        if (d_ring == 0 && d_column == 0)
+          continue;
+        int neighbour_column =
+            (column + d_column + (int)BemcHelper::PHI_COLUMNS) %
+            (int)BemcHelper::PHI_COLUMNS;
+        layout.neighbours[idx * BemcHelper::MAX_NEIGHBOURS + count++] =
+            layout.grid[(ring + d_ring) * BemcHelper::PHI_COLUMNS +
+                        neighbour_column];
+      }
+    }
+    layout.neighbour_count[idx] = count;
+  }
+  return layout;
+}
+
+constexpr Layout layout = MakeLayout();
+
+} // namespace
+
+// everything that needs the math library is computed once, on first use
+struct BemcHelper::Geometry {
+  Geometry();
+
+  std::array<double, towers> phi;
+  std::array<double, towers> z;
+};
+
+BemcHelper::Geometry::Geometry() {
   const double pi = M_PI;
-  phi_offset_ = {72.0 / 180.0 * pi, 108.0 / 180.0 * pi};
+  // phi offset from zero for first module, and width between modules in phi
+  const double phi_offset[2] = {72.0 / 180.0 * pi, 108.0 / 180.0 * pi};
+  const double phi_module_step_width[2] = {-pi * 2.0 / (modules / 2.0),
+                                           pi * 2.0 / (modules / 2.0)};
+  // phi center for towers inside a module
+  const double phi_center[2] = {
+      atan2(-1.0 * half_width_module / 2.0, barrel_radius),
+      atan2(half_width_module / 2.0, barrel_radius)};
+
+  for (unsigned idx = 0; idx < towers; ++idx) {
+    unsigned module_idx = layout.module[idx];
+    int detector_side, module_on_side;
+    double tower_phi = phi_center[layout.module_phi[idx]];
+    if (module_idx < modules / 2) {
+      tower_phi *= -1.0;
+      detector_side = 0;
+      module_on_side = module_idx;
+    } else {
+      detector_side = 1;
+      module_on_side = module_idx - modules / 2;
+    }
+    tower_phi += phi_offset[detector_side];
+    tower_phi += phi_module_step_width[detector_side] * module_on_side;
+    while (tower_phi < -1.0 * pi)
+      tower_phi += 2.0 * pi;
+    while (tower_phi >= pi)
+      tower_phi -= 2.0 * pi;
+    phi[idx] = tower_phi;
 
-  phi_module_step_width_ = {-pi * 2.0 / (modules_ / 2.0),
-                            pi * 2.0 / (modules_ / 2.0)};
+    double tower_eta = layout.eta[idx];
+    double tower_theta = 2.0 * atan(exp(-tower_eta));
+    z[idx] = 0.0;
+    if (tower_eta != 0.0)
+      z[idx] = barrel_radius / tan(tower_theta);
+  }
+}
 
-  phi_center_y_ = {-1.0 * half_width_module_ / 2.0, half_width_module_ / 2.0};
+namespace {
 
-  phi_center_ = {atan2(phi_center_y_[0], barrel_radius_),
-                 atan2(phi_center_y_[1], barrel_radius_)};
+// throws unless tow_id is in [1, 4800], and returns its table index
+unsigned TowerIndex(unsigned tow_id) {
+  if (tow_id - 1 >= towers)
+    JETREADER_THROW("tower index out of bounds: ", tow_id,
+                    " requested, but tower index range is [1, ", towers, "]");
+  return tow_id - 1;
 }
 
-double BemcHelper::towerEta(unsigned tow_id) {
-  unsigned module_idx, module_eta, module_phi;
-  hardwareLocation(tow_id, module_idx, module_eta, module_phi);
+} // namespace
 
-  double eta = eta_center_[module_eta];
-  if (module_idx >= modules_ / 2.0)
-    eta *= -1.0;
-  return eta;
+BemcHelper::BemcHelper() {
+  static const Geometry geometry;
+  geometry_ = &geometry;
 }
 
-double BemcHelper::towerPhi(unsigned tow_id) {
-  unsigned module_idx, module_eta, module_phi;
-  hardwareLocation(tow_id, module_idx, module_eta, module_phi);
+double BemcHelper::towerEta(unsigned tow_id) const {
+  return layout.eta[TowerIndex(tow_id)];
+}
 
-  int detector_side, module_on_side;
-  double phi = phi_center_[module_phi];
-  if (module_idx < modules_ / 2) {
-    phi *= -1.0;
-    detector_side = 0;
-    module_on_side = module_idx;
-  } else {
-    detector_side = 1;
-    module_on_side = module_idx - modules_ / 2;
-  }
-  phi += phi_offset_[detector_side];
-  phi += phi_module_step_width_[detector_side] * module_on_side;
-
-  double pi = M_PI;
-  while (phi < -1.0 * pi)
-    phi += 2.0 * pi;
-  while (phi >= pi)
-    phi -= 2.0 * pi;
-
-  return phi;
-}
-
-double BemcHelper::vertexCorrectedEta(unsigned tow_id, double vz) {
-  double tower_eta = towerEta(tow_id);
-  double tower_theta = 2.0 * atan(exp(-tower_eta));
-  double z = 0.0;
-  if (tower_eta != 0.0)
-    z = barrel_radius_ / tan(tower_theta);
-  double z_diff = z - vz;
-  double theta_corr = atan2(barrel_radius_, z_diff);
+double BemcHelper::towerPhi(unsigned tow_id) const {
+  return geometry_->phi[TowerIndex(tow_id)];
+}
+
+double BemcHelper::towerZ(unsigned tow_id) const {
+  return geometry_->z[TowerIndex(tow_id)];
+}
+
+double BemcHelper::vertexCorrectedEta(unsigned tow_id, double vz) const {
+  double z_diff = towerZ(tow_id) - vz;
+  double theta_corr = atan2(barrel_radius, z_diff);
   double eta_corr = -log(tan(theta_corr / 2.0));
   return eta_corr;
 }
 
 void BemcHelper::hardwareLocation(unsigned soft_id, unsigned &module,
-                                  unsigned &eta, unsigned &phi) {
+                                  unsigned &eta, unsigned &phi) const {
+  unsigned idx = TowerIndex(soft_id);
+  module = layout.module[idx];
+  eta = layout.module_eta[idx];
+  phi = layout.module_phi[idx];
+}
+
+unsigned BemcHelper::towerEtaRing(unsigned tow_id) const {
+  return layout.eta_ring[TowerIndex(tow_id)];
+}
 
-  if (soft_id <= 0 || soft_id > towers_)
-    JETREADER_THROW("tower index out of bounds: ", soft_id,
-                    " requested, but tower index range is [1, ", towers_, "]");
+unsigned BemcHelper::towerPhiColumn(unsigned tow_id) const {
+  return layout.phi_column[TowerIndex(tow_id)];
+}
+
+Span<const unsigned> BemcHelper::towerNeighbours(unsigned tow_id) const {
+  unsigned idx = TowerIndex(tow_id);
+  return Span<const unsigned>(&layout.neighbours[idx * MAX_NEIGHBOURS],
+                              layout.neighbour_count[idx]);
+}
 
-  int tower_idx = soft_id - 1;
-  module = tower_idx / tow_per_module_;
-  int local_tower_id = tower_idx - tow_per_module_ * module;
-  phi = local_tower_id / tow_per_module_eta_;
-  eta = local_tower_id % tow_per_module_eta_;
+unsigned BemcHelper::towerAt(unsigned eta_ring, unsigned phi_column) const {
+  JETREADER_ASSERT(eta_ring < ETA_RINGS && phi_column < PHI_COLUMNS,
+                   "no tower at eta ring ", eta_ring, ", phi column ",
+                   phi_column);
+  return layout.grid[eta_ring * PHI_COLUMNS + phi_column];
 }
 
-} // namespace jetreader
\ No newline at end of file
+unsigned BemcHelper::towerContaining(double eta, double phi) const {
+  // also rejects NaN
+  if (!(std::abs(eta) < eta_max))
+    return 0;
+  // towers are 0.05 wide in eta, apart from the outermost edges. Columns are
+  // numbered from phi = -pi, and towers sit close to the center of their cell
+  int ring = (int)std::floor(eta / 0.05) + (int)tow_per_module_eta;
+  int column = (int)std::floor((phi + M_PI) / (M_PI / 60.0));
+  column = (column % (int)PHI_COLUMNS + (int)PHI_COLUMNS) % (int)PHI_COLUMNS;
+  return layout.grid[ring * PHI_COLUMNS + column];
+}
+
+bool BemcHelper::projectToBarrel(double pt, double eta, double phi, int charge,
+                                 double vz, double b_field, double &barrel_eta,
+                                 double &barrel_phi) const {
+  if (!(pt > 0.0))
+    return false;
+  // transverse path length to the barrel, and the angle between the track
+  // direction at the vertex and the direction of the point it reaches on the
+  // barrel, which is half the angle the track turns through
+  double path = barrel_radius;
+  double bend = 0.0;
+  if (charge != 0 && b_field != 0.0) {
+    // radius of curvature in cm: pt (GeV) = 2.998e-4 * B (kGauss) * R (cm)
+    double radius = pt / (2.99792458e-4 * std::abs(b_field));
+    double chord = barrel_radius / (2.0 * radius);
+    if (chord > 1.0)
+      return false;
+    bend = asin(chord);
+    path = 2.0 * radius * bend;
+    // positive tracks turn clockwise in a field along +z
+    if (charge * b_field < 0.0)
+      bend *= -1.0;
+  }
+
+  barrel_phi = phi - bend;
+  while (barrel_phi < -M_PI)
+    barrel_phi += 2.0 * M_PI;
+  while (barrel_phi >= M_PI)
+    barrel_phi -= 2.0 * M_PI;
+  // pz / pt = sinh(eta)
+  double z = vz + path * sinh(eta);
+  barrel_eta = asinh(z / barrel_radius);
+  return true;
+}
+
+Span<const double> BemcHelper::towerEtas() const {
+  return Span<const double>(layout.eta.data(), towers);
+}
+
+Span<const double> BemcHelper::towerPhis() const {
+  return Span<const double>(geometry_->phi.data(), towers);
+}
+
+Span<const double> BemcHelper::towerZs() const {
+  return Span<const double>(geometry_->z.data(), towers);
+}
+
+Span<const unsigned char> BemcHelper::towerEtaRings() const {
+  return Span<const unsigned char>(layout.eta_ring.data(), towers);
+}
+
+double BemcHelper::barrelRadius() const { return barrel_radius; }
+
+} // namespace jetreader
@@ -1,59 +1,87 @@
 #ifndef JETREADER_READER_BEMC_HELPER_H
 #define JETREADER_READER_BEMC_HELPER_H
 
-#include <vector>
+#include "jetreader/lib/span.h"
 
 namespace jetreader {
 
+// geometry of the 4800 BEMC towers. Tower ids start at 1. Every quantity is
+// computed once for all towers and shared by all BemcHelpers, so the per-tower
+// accessors are table lookups. The batch accessors return the whole table,
+// where entry i describes tower i + 1.
 class BemcHelper {
 public:
+  // detector layout: 120 modules - 60 in phi x 2 in eta
+  // each module is subivided into 40 towers - 2 in phi x 20 in eta
+  // gives a total count of 4800 towers - 120 in phi x 40 in eta
+  static constexpr unsigned TOWERS = 4800;
+  static constexpr unsigned ETA_RINGS = 40;
+  static constexpr unsigned PHI_COLUMNS = 120;
+  // towers sharing an edge or a corner with a tower
+  static constexpr unsigned MAX_NEIGHBOURS = 8;
+
   BemcHelper();
 
   // provides access to a tower's absolute location with respect to the center
   // of the detector. Pseudorapidity (eta) is not corrected for the vertex
   // position along the beam line. The uncorrected pseudorapidity is useful for
   // QA, but should not be used for physics.
-  double towerEta(unsigned tow_id);
-  double towerPhi(unsigned tow_id);
+  double towerEta(unsigned tow_id) const;
+  double towerPhi(unsigned tow_id) const;
+
+  // position of the tower center along the beam line, at the barrel radius
+  double towerZ(unsigned tow_id) const;
 
   // calculates the pseudorapidity of the track with respect to the vertex -
   // this should be used for physics analyses.
-  double vertexCorrectedEta(unsigned tow_id, double vz);
+  double vertexCorrectedEta(unsigned tow_id, double vz) const;
 
   // get module, eta position in module and phi position in module
   void hardwareLocation(unsigned soft_id, unsigned &module, unsigned &eta,
-                        unsigned &phi);
+                        unsigned &phi) const;
 
-private:
-  // detector layout: 120 modules - 60 in phi x 2 in eta
-  // each module is subivided into 40 towers - 2 in phi x 20 in eta
-  // gives a total count of 4800 towers - 120 in phi x 40 in eta
+  // position of the tower in the 40 x 120 eta-phi grid of the barrel. Rings
+  // are numbered by increasing eta, columns by increasing phi from -pi
+  unsigned towerEtaRing(unsigned tow_id) const;
+  unsigned towerPhiColumn(unsigned tow_id) const;
+
+  // ids of the towers adjacent to tow_id in eta, phi or both. Towers at the
+  // edges of the barrel in eta have 5 neighbours, all others have 8
+  Span<const unsigned> towerNeighbours(unsigned tow_id) const;
+
+  // the tower at (eta ring, phi column)
+  unsigned towerAt(unsigned eta_ring, unsigned phi_column) const;
+
+  // the tower whose grid cell contains the point (eta, phi) on the barrel,
+  // or 0 if eta is outside of the barrel. Cells are 0.05 wide in eta and 3
+  // degrees wide in phi
+  unsigned towerContaining(double eta, double phi) const;
 
-  unsigned modules_;            // total number of module
-  unsigned tow_per_module_phi_; // number of towers in module in phi direction
-  unsigned tow_per_module_eta_; // number of towers in module in eta direction
-  unsigned tow_per_module_;     // total number of towers per module
-  unsigned towers_;             // total number of towers in detector
-
-  // detector length constants
-  double barrel_radius_;     // radius of barrel
-  double half_width_module_; // half-width of module for the given radius
-
-  // tower boundaries and centers
-  std::vector<double> eta_bounds_; // edges for each tower (one side of TPC)
-  std::vector<double>
-      eta_center_; // the center of each tower in eta (one side of TPC)
-  std::vector<double> phi_offset_; // phi offset from zero for first module
-  std::vector<double> phi_module_step_width_; // width between modules in phi
-  std::vector<double> phi_center_y_; // phi center for towers inside a module (in cm)
-  std::vector<double>
-      phi_center_; // phi center for towers inside a module (in degrees)
-
-  // internal and external boundaries for the modules in eta
-  double eta_min_;
-  double eta_max_;
+  // projects a track with transverse momentum pt, eta and phi at a vertex at
+  // (0, 0, vz) along its helix to the barrel radius, in a uniform magnetic
+  // field b_field (kGauss) along the beam line. Returns false if the track
+  // curls up before reaching the barrel. Otherwise, barrel_eta and barrel_phi
+  // are the position of the track on the barrel, with eta measured from the
+  // center of the detector as for towerEta()
+  bool projectToBarrel(double pt, double eta, double phi, int charge,
+                       double vz, double b_field, double &barrel_eta,
+                       double &barrel_phi) const;
+
+  // tables of the above for all towers, indexed by tower id - 1. These are
+  // not bounds checked
+  Span<const double> towerEtas() const;
+  Span<const double> towerPhis() const;
+  Span<const double> towerZs() const;
+  Span<const unsigned char> towerEtaRings() const;
+
+  // the radius of the barrel at which tower positions are computed
+  double barrelRadius() const;
+
+private:
+  struct Geometry;
+  const Geometry *geometry_;
 };
 
 } // namespace jetreader
 
-#endif // JETREADER_READER_BEMC_HELPER_H
\ No newline at end of file
+#endif // JETREADER_READER_BEMC_HELPER_H
@@ -1,6 +1,7 @@
 #include "gtest/gtest.h"
 
 #include "jetreader/reader/bemc_helper.h"
+#include <cmath>
 #include <iostream>
 
 // BemcRef lookup table for testing
@@ -35,6 +36,54 @@ TEST(BemcHelper, GetEta) {
   }
 }
 
+TEST(BemcHelper, TowerContaining) {
+  jetreader::BemcHelper helper;
+  for (unsigned i = 1; i <= 4800; ++i)
+    EXPECT_EQ(helper.towerContaining(helper.towerEta(i), helper.towerPhi(i)),
+              i);
+  EXPECT_EQ(helper.towerContaining(1.1, 0.0), 0);
+  EXPECT_EQ(helper.towerContaining(-1.1, 0.0), 0);
+}
+
+TEST(BemcHelper, ProjectToBarrel) {
+  jetreader::BemcHelper helper;
+  double eta, phi;
+
+  // straight tracks from the center keep their direction
+  EXPECT_TRUE(helper.projectToBarrel(1.0, 0.5, 1.0, 1, 0.0, 0.0, eta, phi));
+  EXPECT_NEAR(eta, 0.5, 1e-9);
+  EXPECT_NEAR(phi, 1.0, 1e-9);
+  EXPECT_TRUE(helper.projectToBarrel(1.0, 0.5, 1.0, 0, 0.0, 5.0, eta, phi));
+  EXPECT_NEAR(eta, 0.5, 1e-9);
+  EXPECT_NEAR(phi, 1.0, 1e-9);
+
+  // a vertex displaced along the beam line moves the point on the barrel
+  EXPECT_TRUE(helper.projectToBarrel(1.0, 0.0, 1.0, 0, 50.0, 0.0, eta, phi));
+  EXPECT_NEAR(eta, asinh(50.0 / helper.barrelRadius()), 1e-9);
+
+  // a 1 GeV track turns by asin(r / 2R) with R = 1 / (2.998e-4 * 5) cm,
+  // clockwise for a positive track in a positive field
+  double bend = asin(helper.barrelRadius() * 2.99792458e-4 * 5.0 / 2.0);
+  EXPECT_TRUE(helper.projectToBarrel(1.0, 0.0, 1.0, 1, 0.0, 5.0, eta, phi));
+  EXPECT_NEAR(phi, 1.0 - bend, 1e-9);
+  EXPECT_NEAR(eta, 0.0, 1e-9);
+  EXPECT_TRUE(helper.projectToBarrel(1.0, 0.0, 1.0, -1, 0.0, 5.0, eta, phi));
+  EXPECT_NEAR(phi, 1.0 + bend, 1e-9);
+  EXPECT_TRUE(helper.projectToBarrel(1.0, 0.0, 1.0, 1, 0.0, -5.0, eta, phi));
+  EXPECT_NEAR(phi, 1.0 + bend, 1e-9);
+
+  // the longer path of a bent track moves it further along the beam line
+  EXPECT_TRUE(helper.projectToBarrel(1.0, 0.5, 1.0, 1, 0.0, 5.0, eta, phi));
+  EXPECT_GT(eta, 0.5);
+
+  // phi wraps into [-pi, pi)
+  EXPECT_TRUE(helper.projectToBarrel(1.0, 0.0, -3.1, 1, 0.0, 5.0, eta, phi));
+  EXPECT_NEAR(phi, -3.1 - bend + 2.0 * M_PI, 1e-9);
+
+  // low momentum tracks curl up inside the barrel
+  EXPECT_FALSE(helper.projectToBarrel(0.1, 0.0, 1.0, 1, 0.0, 5.0, eta, phi));
+}
+
 // methods for BemcRef
 
 double BemcRef::getEta(unsigned tow_id) { return mTowGeom[tow_id - 1][0]; }
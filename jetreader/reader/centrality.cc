@@ -1,19 +1,100 @@
 
 #include "jetreader/reader/centrality.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <math.h>
 
 namespace jetreader {
 
+namespace {
+
+// the sixth order vz correction polynomial, by Horner's scheme
+double VzPolynomial(const double *par, double vz) {
+  double ret = 0.0;
+  for (int i = 6; i >= 0; --i)
+    ret = ret * vz + par[i];
+  return ret;
+}
+
+// refmultcorr of an event in the valid ranges, given the correction
+// polynomials at the normalization points. Shared by setEvent() and
+// evaluate(), so that both give identical results
+double CorrectRefMult(double raw_ref, double zdc, double vz,
+                      const double *zdc_par, const double *vz_par,
+                      double zdc_norm_scaling, double vz_norm_scaling) {
+  double zdc_scaling = zdc_par[0] + zdc_par[1] * zdc / 1000.0;
+  double zdc_correction = zdc_norm_scaling / zdc_scaling;
+
+  double vz_scaling = VzPolynomial(vz_par, vz);
+  double vz_correction = vz_norm_scaling / vz_scaling;
+  if (!(vz_scaling > 0.0))
+    vz_correction = 1.0;
+
+  return raw_ref * vz_correction * zdc_correction;
+}
+
+// the refmultcorr weight, below the reweighting bound
+double RefMultWeight(double refmultcorr, const double *par) {
+  double ref_const = refmultcorr * par[2] + par[3];
+  double ref_const2 = ref_const * ref_const;
+  return par[0] + par[1] / ref_const + par[4] * ref_const +
+         par[5] / ref_const2 + par[6] * ref_const2;
+}
+
+// the number of bounds above refmultcorr, or none if there are no bounds.
+// Bounds are sorted in ascending order, and are searched with a branch-free
+// binary search
+int CentralityBin(const std::vector<unsigned> &bounds, double refmultcorr,
+                  int none) {
+  size_t n = bounds.size();
+  if (n == 0)
+    return none;
+  const unsigned *base = bounds.data();
+  while (n > 1) {
+    size_t half = n / 2;
+    base = refmultcorr >= base[half] ? base + half : base;
+    n -= half;
+  }
+  size_t below = base - bounds.data() + (refmultcorr >= *base);
+  return bounds.size() - below;
+}
+
+// for each of n values, the number of bounds above it
+void CountBoundsAbove(const std::vector<unsigned> &bounds, const double *value,
+                      size_t n, double *count) {
+  std::fill(count, count + n, 0.0);
+  for (double bound : bounds)
+    for (size_t i = 0; i < n; ++i)
+      count[i] += value[i] >= bound ? 0.0 : 1.0;
+}
+
+// the counter of the smoothing random number of an event
+PhiloxCounter EventCounter(int runid, int eventid) {
+  return PhiloxCounter{{(uint32_t)runid, (uint32_t)eventid, 0, 0}};
+}
+
+// the same for events without an event id, from the bits of zdc and vz. The
+// last word keeps these counters apart from those with an event id
+uint32_t FoldBits(double value) {
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return (uint32_t)(bits ^ (bits >> 32));
+}
+
+PhiloxCounter EventCounter(int runid, double zdc, double vz) {
+  return PhiloxCounter{{(uint32_t)runid, FoldBits(zdc), FoldBits(vz), 1}};
+}
+
+} // namespace
+
 Centrality::Centrality()
     : refmultcorr_(-1.0), centrality_16_(-1), centrality_9_(-1), weight_(1.0),
       min_vz_(0.0), max_vz_(0.0), min_zdc_(0.0), max_zdc_(0.0), min_run_(0),
       max_run_(0), weight_bound_(0), vz_norm_(0), zdc_norm_(0),
-      smoothing_(true) {
-
-  dis_ = std::uniform_real_distribution<double>(0.0, 1.0);
-}
+      vz_norm_scaling_(0), zdc_norm_scaling_(0), smoothing_(true), seed_(0) {}
 
 Centrality::~Centrality() {}
 
@@ -31,9 +112,10 @@ void Centrality::loadCentralityDef(CentDefId id) {
   setCentralityBounds16Bin(def.centralityBounds(id));
 }
 
-void Centrality::setEvent(int runid, double refmult, double zdc, double vz) {
+void Centrality::setEvent(int runid, int eventid, double refmult, double zdc,
+                          double vz) {
   if (checkEvent(runid, refmult, zdc, vz)) {
-    calculateCentrality(refmult, zdc, vz);
+    calculateCentrality(EventCounter(runid, eventid), refmult, zdc, vz);
   }
   // if event isn't in the run ID range, isn't in the vz range, or luminosity
   // range, set refmultcorr = refmult
@@ -45,8 +127,20 @@ void Centrality::setEvent(int runid, double refmult, double zdc, double vz) {
   }
 }
 
+void Centrality::setEvent(int runid, double refmult, double zdc, double vz) {
+  if (checkEvent(runid, refmult, zdc, vz)) {
+    calculateCentrality(EventCounter(runid, zdc, vz), refmult, zdc, vz);
+  } else {
+    refmultcorr_ = refmult;
+    centrality_9_ = -1;
+    centrality_16_ = -1;
+    weight_ = 1.0;
+  }
+}
+
 void Centrality::setZDCParameters(double par0, double par1) {
   zdc_par_ = std::vector<double>{par0, par1};
+  updateNormalization();
 }
 void Centrality::setZDCParameters(const std::vector<double> &pars) {
   zdc_par_.clear();
@@ -55,14 +149,17 @@ void Centrality::setZDCParameters(const std::vector<double> &pars) {
     std::cerr << "zdc correction currently implemented as a linear fit "
               << "but " << pars.size() << " parameters were passed, not 2 "
               << std::endl;
+    updateNormalization();
     return;
   }
   zdc_par_ = pars;
+  updateNormalization();
 }
 void Centrality::setVzParameters(double par0, double par1, double par2,
                                  double par3, double par4, double par5,
                                  double par6) {
   vz_par_ = std::vector<double>{par0, par1, par2, par3, par4, par5, par6};
+  updateNormalization();
 }
 
 void Centrality::setVzParameters(const std::vector<double> &pars) {
@@ -73,10 +170,11 @@ void Centrality::setVzParameters(const std::vector<double> &pars) {
         << "vz correction currently implemented as a 6th order polynomial "
         << "but " << pars.size() << " parameters were passed, not 7 "
         << std::endl;
-    ;
+    updateNormalization();
     return;
   }
   vz_par_ = pars;
+  updateNormalization();
 }
 
 void Centrality::setCentralityBounds16Bin(const std::vector<unsigned> &bounds) {
@@ -118,7 +216,8 @@ bool Centrality::isValid() {
   return true;
 }
 
-bool Centrality::checkEvent(int runid, double refmult, double zdc, double vz) {
+bool Centrality::checkEvent(int runid, double refmult, double zdc,
+                            double vz) const {
   if (refmult < 0)
     return false;
   if (max_run_ > 0 && (runid < min_run_ || runid > max_run_))
@@ -130,13 +229,29 @@ bool Centrality::checkEvent(int runid, double refmult, double zdc, double vz) {
   return true;
 }
 
-void Centrality::calculateCentrality(double refmult, double zdc, double vz) {
+void Centrality::updateNormalization() {
+  zdc_norm_scaling_ = 0.0;
+  if (zdc_par_.size() == 2)
+    zdc_norm_scaling_ = zdc_par_[0] + zdc_par_[1] * zdc_norm_ / 1000.0;
+  vz_norm_scaling_ = 0.0;
+  if (vz_par_.size() == 7)
+    vz_norm_scaling_ = VzPolynomial(vz_par_.data(), vz_norm_);
+}
+
+double Centrality::smoothingValue(const PhiloxCounter &event) const {
+  PhiloxCounter words =
+      Philox4x32(event, PhiloxKey{{(uint32_t)seed_, (uint32_t)(seed_ >> 32)}});
+  return PhiloxUniform(words[0], words[1]);
+}
+
+void Centrality::calculateCentrality(const PhiloxCounter &event,
+                                     double refmult, double zdc, double vz) {
 
   // we randomize raw refmult within 1 bin to avoid the peaky structures at low
   // refmult
   double raw_ref = refmult;
   if (smoothing_)
-    raw_ref += dis_(gen_);
+    raw_ref += smoothingValue(event);
 
   if (zdc_par_.empty() || vz_par_.empty()) {
     std::cerr << "zdc and vz correction parameters must be set before "
@@ -146,60 +261,108 @@ void Centrality::calculateCentrality(double refmult, double zdc, double vz) {
     centrality_9_ = -1;
     centrality_16_ = -1;
     weight_ = 1.0;
+    return;
   }
 
-  double zdc_scaling = zdc_par_[0] + zdc_par_[1] * zdc / 1000.0;
-  double zdc_norm = zdc_par_[0] + zdc_par_[1] * zdc_norm_ / 1000.0;
+  refmultcorr_ = CorrectRefMult(raw_ref, zdc, vz, zdc_par_.data(),
+                                vz_par_.data(), zdc_norm_scaling_,
+                                vz_norm_scaling_);
 
-  double zdc_correction = zdc_norm / zdc_scaling;
+  // now calculate the centrality bins, both 16 & 9
+  centrality_9_ = CentralityBin(cent_bin_9_, refmultcorr_, 9);
+  centrality_16_ = CentralityBin(cent_bin_16_, refmultcorr_, 16);
 
-  double vz_scaling = 0.0;
-  double vz_norm = 0.0;
-  for (int i = 0; i < vz_par_.size(); ++i) {
-    vz_scaling += vz_par_[i] * pow(vz, i);
-    vz_norm += vz_par_[i] * pow(vz_norm_, i);
-  }
+  // now get the weight
+  weight_ = 1.0;
+  if (weight_par_.size() && refmultcorr_ < weight_bound_)
+    weight_ = RefMultWeight(refmultcorr_, weight_par_.data());
+}
 
-  double vz_correction = 1.0;
-  if (vz_scaling > 0.0) {
-    vz_correction = vz_norm / vz_scaling;
-  }
+void Centrality::evaluate(Span<const Event> events,
+                          Results &results) const {
+  size_t n = events.size();
+  results.refmultcorr.resize(n);
+  results.weight.resize(n);
+  results.centrality16.resize(n);
+  results.centrality9.resize(n);
 
-  refmultcorr_ = raw_ref * vz_correction * zdc_correction;
+  // events outside of the valid ranges keep their refmult. The raw refmult
+  // is kept in results.refmultcorr until it is corrected
+  std::vector<uint8_t> valid(n);
+  for (size_t i = 0; i < n; ++i) {
+    const Event &event = events[i];
+    valid[i] = checkEvent(event.runid, event.refmult, event.zdc, event.vz);
+    results.refmultcorr[i] = event.refmult;
+    if (valid[i] && smoothing_)
+      results.refmultcorr[i] +=
+          smoothingValue(EventCounter(event.runid, event.eventid));
+  }
 
-  // now calculate the centrality bins, both 16 & 9
-  centrality_9_ = 9;
-  for (int i = 0; i < cent_bin_9_.size(); ++i) {
-    if (refmultcorr_ >= cent_bin_9_[cent_bin_9_.size() - i - 1]) {
-      centrality_9_ = i;
-      break;
+  if (zdc_par_.empty() || vz_par_.empty()) {
+    if (n > 0)
+      std::cerr << "zdc and vz correction parameters must be set before "
+                   "refmultcorr can be calculated"
+                << std::endl;
+    for (size_t i = 0; i < n; ++i) {
+      results.refmultcorr[i] = events[i].refmult;
+      results.weight[i] = 1.0;
+      results.centrality16[i] = -1;
+      results.centrality9[i] = -1;
     }
+    return;
   }
 
-  centrality_16_ = 16;
-  for (int i = 0; i < cent_bin_16_.size(); ++i) {
-    if (refmultcorr_ >= cent_bin_16_[cent_bin_16_.size() - i - 1]) {
-      centrality_16_ = i;
-      break;
-    }
+  // each step is a loop without branches over all events. The parameters are
+  // copied, so that the compiler knows they are not changed by writing the
+  // results
+  double zdc_par[2] = {zdc_par_[0], zdc_par_[1]};
+  double vz_par[7];
+  std::copy(vz_par_.begin(), vz_par_.end(), vz_par);
+  double zdc_norm_scaling = zdc_norm_scaling_;
+  double vz_norm_scaling = vz_norm_scaling_;
+  const uint8_t *is_valid = valid.data();
+  double *refmultcorr = results.refmultcorr.data();
+  for (size_t i = 0; i < n; ++i) {
+    double corrected =
+        CorrectRefMult(refmultcorr[i], events[i].zdc, events[i].vz, zdc_par,
+                       vz_par, zdc_norm_scaling, vz_norm_scaling);
+    refmultcorr[i] = is_valid[i] ? corrected : events[i].refmult;
   }
 
-  // now get the weight
-  if (weight_par_.size() && centrality_9_ >= 0 && centrality_16_ >= 0 &&
-      refmultcorr_ < weight_bound_) {
-    double par0 = weight_par_[0];
-    double par1 = weight_par_[1];
-    double par2 = weight_par_[2];
-    double par3 = weight_par_[3];
-    double par4 = weight_par_[4];
-    double par5 = weight_par_[5];
-    double par6 = weight_par_[6];
-    double ref_const = refmultcorr_ * par2 + par3;
-    weight_ = par0 + par1 / ref_const + par4 * ref_const +
-              par5 / pow(ref_const, 2.0) + par6 * pow(ref_const, 2.0);
-  } else {
-    weight_ = 1.0;
+  // the bins count the bounds above refmultcorr, one bound at a time, which
+  // gives the same result as the binary search of setEvent() for sorted
+  // bounds. The count is kept as a double, like refmultcorr, so that GCC
+  // vectorizes the loops at -O3
+  std::vector<double> count(n);
+  int *centrality16 = results.centrality16.data();
+  int *centrality9 = results.centrality9.data();
+  int empty16 = cent_bin_16_.empty() ? 16 : 0;
+  CountBoundsAbove(cent_bin_16_, refmultcorr, n, count.data());
+  for (size_t i = 0; i < n; ++i) {
+    // converted outside of the select, which GCC otherwise doesn't vectorize
+    int bin = (int)count[i] + empty16;
+    centrality16[i] = is_valid[i] ? bin : -1;
+  }
+  int empty9 = cent_bin_9_.empty() ? 9 : 0;
+  CountBoundsAbove(cent_bin_9_, refmultcorr, n, count.data());
+  for (size_t i = 0; i < n; ++i) {
+    int bin = (int)count[i] + empty9;
+    centrality9[i] = is_valid[i] ? bin : -1;
+  }
+
+  double *weight = results.weight.data();
+  if (weight_par_.empty()) {
+    std::fill(results.weight.begin(), results.weight.end(), 1.0);
+    return;
+  }
+  double weight_par[7];
+  std::copy(weight_par_.begin(), weight_par_.end(), weight_par);
+  double weight_bound = weight_bound_;
+  for (size_t i = 0; i < n; ++i) {
+    double event_weight = RefMultWeight(refmultcorr[i], weight_par);
+    bool reweight = is_valid[i] && refmultcorr[i] < weight_bound;
+    weight[i] = reweight ? event_weight : 1.0;
   }
 }
 
-} // namespace jetreader
\ No newline at end of file
+} // namespace jetreader
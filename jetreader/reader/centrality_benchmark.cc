@@ -0,0 +1,58 @@
+#include "benchmark/benchmark.h"
+
+#include "jetreader/reader/centrality.h"
+
+#include <random>
+#include <vector>
+
+// compares evaluating the centrality of a set of events one event at a time
+// through Centrality::setEvent(), as the Reader does, to evaluating all of
+// them at once with Centrality::evaluate(), as for pre-pass studies.
+
+constexpr unsigned EVENTS = 10000;
+
+std::vector<jetreader::Centrality::Event> MakeBenchmarkEvents() {
+  std::mt19937 gen(7);
+  std::uniform_int_distribution<int> refmult(0, 800);
+  std::uniform_real_distribution<double> zdc(0.0, 60000.0);
+  std::uniform_real_distribution<double> vz(-30.0, 30.0);
+  std::vector<jetreader::Centrality::Event> ret;
+  for (unsigned i = 0; i < EVENTS; ++i)
+    ret.push_back({15076125, (int)i, (double)refmult(gen), zdc(gen), vz(gen)});
+  return ret;
+}
+
+static void BM_CentralitySetEvent(benchmark::State &state) {
+  auto events = MakeBenchmarkEvents();
+  jetreader::Centrality centrality;
+  centrality.loadCentralityDef(jetreader::CentDefId::Run14LowMid);
+  centrality.useSmoothing(false);
+  for (auto _ : state) {
+    double sum = 0.0;
+    for (auto &event : events) {
+      centrality.setEvent(event.runid, event.eventid, event.refmult, event.zdc,
+                          event.vz);
+      sum += centrality.refMultCorr() + centrality.centrality16() +
+             centrality.weight();
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+}
+
+static void BM_CentralityEvaluate(benchmark::State &state) {
+  auto events = MakeBenchmarkEvents();
+  jetreader::Centrality centrality;
+  centrality.loadCentralityDef(jetreader::CentDefId::Run14LowMid);
+  centrality.useSmoothing(false);
+  jetreader::Centrality::Results results;
+  for (auto _ : state) {
+    centrality.evaluate(jetreader::Span<const jetreader::Centrality::Event>(
+                            events.data(), events.size()),
+                        results);
+    benchmark::DoNotOptimize(results.refmultcorr.data());
+  }
+}
+
+BENCHMARK(BM_CentralitySetEvent);
+BENCHMARK(BM_CentralityEvaluate);
+BENCHMARK_MAIN();
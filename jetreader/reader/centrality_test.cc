@@ -211,6 +211,80 @@ TEST(Centrality, CompareByHand) {
   EXPECT_NEAR(test.centrality9(), cent9(ref, vz, zdc), 1.1);
 }
 
+TEST(Centrality, Evaluate) {
+  for (bool smoothing : {false, true}) {
+    jetreader::Centrality single;
+    single.loadCentralityDef(jetreader::CentDefId::Run14LowMid);
+    single.useSmoothing(smoothing);
+    jetreader::Centrality batch;
+    batch.loadCentralityDef(jetreader::CentDefId::Run14LowMid);
+    batch.useSmoothing(smoothing);
+
+    // includes events outside of the vz, zdc and run ranges
+    std::default_random_engine gen(17);
+    std::uniform_int_distribution<int> refmult(-1, 800);
+    std::uniform_real_distribution<double> zdc(0.0, 80000.0);
+    std::uniform_real_distribution<double> vz(-40.0, 40.0);
+    std::vector<jetreader::Centrality::Event> events;
+    for (int i = 0; i < 10000; ++i)
+      events.push_back({i % 100 ? 15076125 : 1, i, (double)refmult(gen),
+                        zdc(gen), vz(gen)});
+
+    jetreader::Centrality::Results results;
+    batch.evaluate(jetreader::Span<const jetreader::Centrality::Event>(
+                       events.data(), events.size()),
+                   results);
+    ASSERT_EQ(results.refmultcorr.size(), events.size());
+    for (size_t i = 0; i < events.size(); ++i) {
+      single.setEvent(events[i].runid, events[i].eventid, events[i].refmult,
+                      events[i].zdc, events[i].vz);
+      EXPECT_EQ(results.refmultcorr[i], single.refMultCorr());
+      EXPECT_EQ(results.centrality16[i], single.centrality16());
+      EXPECT_EQ(results.centrality9[i], single.centrality9());
+      EXPECT_EQ(results.weight[i], single.weight());
+    }
+  }
+}
+
+TEST(Centrality, OrderIndependentSmoothing) {
+  jetreader::Centrality forward;
+  forward.loadCentralityDef(jetreader::CentDefId::Run14LowMid);
+  jetreader::Centrality backward;
+  backward.loadCentralityDef(jetreader::CentDefId::Run14LowMid);
+  jetreader::Centrality reseeded;
+  reseeded.loadCentralityDef(jetreader::CentDefId::Run14LowMid);
+  reseeded.setSmoothingSeed(12345);
+  EXPECT_EQ(reseeded.smoothingSeed(), 12345);
+
+  // at the normalization points, refmultcorr is the smoothed refmult
+  std::vector<double> forward_corr, forward_weight;
+  for (int eventid = 0; eventid < 100; ++eventid) {
+    forward.setEvent(15076125, eventid, 5, 30000.0, 0.0);
+    forward_corr.push_back(forward.refMultCorr());
+    forward_weight.push_back(forward.weight());
+  }
+  int reseeded_differs = 0;
+  for (int eventid = 99; eventid >= 0; --eventid) {
+    backward.setEvent(15076125, eventid, 5, 30000.0, 0.0);
+    EXPECT_EQ(backward.refMultCorr(), forward_corr[eventid]);
+    EXPECT_EQ(backward.weight(), forward_weight[eventid]);
+    EXPECT_GE(backward.refMultCorr(), 5.0);
+    EXPECT_LT(backward.refMultCorr(), 6.0);
+
+    reseeded.setEvent(15076125, eventid, 5, 30000.0, 0.0);
+    reseeded_differs += reseeded.refMultCorr() != forward_corr[eventid];
+  }
+  EXPECT_GT(reseeded_differs, 90);
+
+  // without an event id, smoothing only depends on the event
+  forward.setEvent(15076125, 5, 30000.0, 1.0);
+  double corr = forward.refMultCorr();
+  forward.setEvent(15076125, 5, 30000.0, 2.0);
+  EXPECT_NE(forward.refMultCorr(), corr);
+  backward.setEvent(15076125, 5, 30000.0, 1.0);
+  EXPECT_EQ(backward.refMultCorr(), corr);
+}
+
 TEST(Centrality, CheckReader) {
   std::string filename = jetreader::GetTestFile();
 
@@ -224,6 +298,7 @@ TEST(Centrality, CheckReader) {
 
   while (reader.next()) {
     ref.setEvent(reader.picoDst()->event()->runId(),
+                 reader.picoDst()->event()->eventId(),
                  reader.picoDst()->event()->refMult(),
                  reader.picoDst()->event()->ZDCx(),
                  reader.picoDst()->event()->primaryVertex().Z());
@@ -0,0 +1,227 @@
+#include "jetreader/reader/chain_metadata.h"
+#include "jetreader/lib/memory.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <unordered_map>
+
+#include <unistd.h>
+
+#include "StPicoEvent/StPicoEvent.h"
+
+#include "TClonesArray.h"
+#include "TFile.h"
+#include "TROOT.h"
+#include "TTree.h"
+
+namespace jetreader {
+
+namespace {
+
+const std::string CHAIN_METADATA_HEADER = "jetreader_chain_metadata_v1";
+
+// true if the file on disk still has the size and modification time recorded
+// in info
+bool Unchanged(const ChainFileInfo &info) {
+  FileFingerprint current;
+  return FileFingerprint::Make(info.filename, 0, current) &&
+         current.size == info.fingerprint.size &&
+         current.mtime == info.fingerprint.mtime;
+}
+
+} // namespace
+
+bool ChainMetadata::IsFileList(const std::string &input) {
+  return input.find(".lis") != std::string::npos;
+}
+
+std::vector<std::string> ChainMetadata::ReadFileList(const std::string &list) {
+  std::vector<std::string> files;
+  std::ifstream in(list);
+  std::string line;
+  while (std::getline(in, line)) {
+    size_t pos = line.find_first_of(" ");
+    if (pos != std::string::npos)
+      line.erase(pos);
+    if (line.find(".picoDst.root") != std::string::npos)
+      files.push_back(line);
+  }
+  return files;
+}
+
+void ChainMetadata::build(const std::vector<std::string> &files,
+                          unsigned threads, const ChainMetadata *previous) {
+  std::unordered_map<std::string, const ChainFileInfo *> known;
+  if (previous) {
+    for (auto &info : previous->files_)
+      known[info.filename] = &info;
+  }
+
+  std::vector<ChainFileInfo> infos(files.size());
+  std::vector<size_t> to_scan;
+  for (size_t i = 0; i < files.size(); ++i) {
+    auto it = known.find(files[i]);
+    if (it != known.end() && Unchanged(*it->second))
+      infos[i] = *it->second;
+    else
+      to_scan.push_back(i);
+  }
+
+  if (threads == 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  threads = std::min<size_t>(threads, to_scan.size());
+  if (threads > 1)
+    ROOT::EnableThreadSafety();
+
+  // files are handed out one at a time, so that a few large files don't hold
+  // up a single thread
+  std::atomic<size_t> next(0);
+  auto scan = [&]() {
+    for (size_t i = next++; i < to_scan.size(); i = next++)
+      ScanFile(files[to_scan[i]], infos[to_scan[i]]);
+  };
+  std::vector<std::thread> workers;
+  for (unsigned i = 1; i < threads; ++i)
+    workers.emplace_back(scan);
+  scan();
+  for (auto &worker : workers)
+    worker.join();
+
+  files_ = std::move(infos);
+  computeOffsets();
+}
+
+bool ChainMetadata::matches(const std::vector<std::string> &files) const {
+  if (files.size() != files_.size())
+    return false;
+  for (size_t i = 0; i < files.size(); ++i) {
+    if (files[i] != files_[i].filename || !Unchanged(files_[i]))
+      return false;
+  }
+  return true;
+}
+
+int ChainMetadata::fileIndex(int64_t entry) const {
+  if (entry < 0 || entry >= entries())
+    return -1;
+  // the last file starting at or before entry - empty files are skipped, since
+  // the next file starts at the same entry
+  auto it = std::upper_bound(offsets_.begin(), offsets_.end(), entry);
+  return static_cast<int>(it - offsets_.begin()) - 1;
+}
+
+void ChainMetadata::clear() {
+  files_.clear();
+  offsets_.assign(1, 0);
+}
+
+bool ChainMetadata::save(const std::string &filename) const {
+  // several jobs can share a file list, so the metadata is written to a
+  // temporary file first and moved into place
+  std::string tmp_filename = filename + ".tmp." + std::to_string(getpid());
+  {
+    std::ofstream out(tmp_filename);
+    if (!out.good())
+      return false;
+
+    out << CHAIN_METADATA_HEADER << " " << files_.size() << "\n";
+    for (auto &info : files_) {
+      out << info.good << " " << info.fingerprint.size << " "
+          << info.fingerprint.mtime << " " << info.fingerprint.entries << " "
+          << info.run_ids.size();
+      for (auto run_id : info.run_ids)
+        out << " " << run_id;
+      out << " " << info.filename << "\n";
+    }
+    if (!out.good()) {
+      remove(tmp_filename.c_str());
+      return false;
+    }
+  }
+  if (rename(tmp_filename.c_str(), filename.c_str()) != 0) {
+    remove(tmp_filename.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool ChainMetadata::load(const std::string &filename) {
+  clear();
+  std::ifstream in(filename);
+  if (!in.good())
+    return false;
+
+  std::string header;
+  size_t n_files = 0;
+  if (!(in >> header >> n_files) || header != CHAIN_METADATA_HEADER)
+    return false;
+
+  std::vector<ChainFileInfo> infos(n_files);
+  for (auto &info : infos) {
+    size_t n_runs = 0;
+    if (!(in >> info.good >> info.fingerprint.size >> info.fingerprint.mtime >>
+          info.fingerprint.entries >> n_runs) ||
+        info.fingerprint.entries < 0)
+      return false;
+    info.run_ids.resize(n_runs);
+    for (auto &run_id : info.run_ids) {
+      if (!(in >> run_id))
+        return false;
+    }
+    if (!(in >> info.filename))
+      return false;
+  }
+
+  files_ = std::move(infos);
+  computeOffsets();
+  return true;
+}
+
+void ChainMetadata::ScanFile(const std::string &filename,
+                             ChainFileInfo &info) {
+  info = ChainFileInfo();
+  info.filename = filename;
+  if (!FileFingerprint::Make(filename, 0, info.fingerprint))
+    return;
+
+  unique_ptr<TFile> file(TFile::Open(filename.c_str()));
+  if (!file || file->IsZombie() || file->GetNkeys() == 0)
+    return;
+  TTree *tree = nullptr;
+  file->GetObject("PicoDst", tree);
+  if (tree == nullptr)
+    return;
+  info.fingerprint.entries = tree->GetEntries();
+
+  // only the event headers are read to find the run IDs
+  unique_ptr<TClonesArray> events = make_unique<TClonesArray>("StPicoEvent");
+  TClonesArray *events_ptr = events.get();
+  tree->SetBranchStatus("*", 0);
+  tree->SetBranchStatus("Event*", 1);
+  tree->SetBranchAddress("Event", &events_ptr);
+  for (int64_t entry = 0; entry < info.fingerprint.entries; ++entry) {
+    if (tree->GetEntry(entry) <= 0 || events_ptr->GetEntriesFast() == 0)
+      continue;
+    unsigned run_id =
+        static_cast<StPicoEvent *>(events_ptr->UncheckedAt(0))->runId();
+    if (info.run_ids.empty() || info.run_ids.back() != run_id)
+      info.run_ids.push_back(run_id);
+  }
+  tree->ResetBranchAddresses();
+  std::sort(info.run_ids.begin(), info.run_ids.end());
+  info.run_ids.erase(std::unique(info.run_ids.begin(), info.run_ids.end()),
+                     info.run_ids.end());
+  info.good = true;
+}
+
+void ChainMetadata::computeOffsets() {
+  offsets_.assign(1, 0);
+  for (auto &info : files_)
+    offsets_.push_back(offsets_.back() +
+                       (info.good ? info.fingerprint.entries : 0));
+}
+
+} // namespace jetreader
@@ -0,0 +1,89 @@
+#ifndef JETREADER_READER_CHAIN_METADATA_H
+#define JETREADER_READER_CHAIN_METADATA_H
+
+#include "jetreader/reader/event_header_cache.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace jetreader {
+
+// metadata of one file in a file list
+struct ChainFileInfo {
+  std::string filename;
+  // size and modification time of the file, and its number of entries
+  FileFingerprint fingerprint;
+  // sorted run IDs of the events in the file
+  std::vector<unsigned> run_ids;
+  // false if the file could not be opened, or has no PicoDst tree. Such files
+  // are left out of the chain, as StPicoDstReader does
+  bool good = false;
+};
+
+// per-file metadata of a file list: the number of entries, first entry in the
+// chain and run IDs of every file. Used by the Reader to build a chain for a
+// long file list without opening its files - each file is only opened once
+// the chain reaches it.
+//
+// The metadata is built by opening the files in parallel, and can be saved to
+// and loaded from a small text file. When it is rebuilt, only the files that
+// are new or whose size or modification time changed are opened again.
+class ChainMetadata {
+public:
+  ChainMetadata() : offsets_(1, 0) {}
+
+  // true if input is a file list rather than a picoDst file, using the same
+  // rule as StPicoDstReader
+  static bool IsFileList(const std::string &input);
+
+  // reads the picoDst files of a file list the same way as StPicoDstReader:
+  // anything after the first space on a line is ignored, and only
+  // .picoDst.root files are used
+  static std::vector<std::string> ReadFileList(const std::string &list);
+
+  // builds the metadata for files, opening up to threads files at a time (0
+  // uses one thread per core). Files found in previous with an unchanged size
+  // and modification time are not opened
+  void build(const std::vector<std::string> &files, unsigned threads = 0,
+             const ChainMetadata *previous = nullptr);
+
+  // true if the metadata was built for files, in the same order, and none of
+  // them have changed since
+  bool matches(const std::vector<std::string> &files) const;
+
+  const std::vector<ChainFileInfo> &files() const { return files_; }
+
+  // first entry of each file in the chain. Bad files have no entries. The
+  // last element is the total number of entries
+  const std::vector<int64_t> &offsets() const { return offsets_; }
+
+  int64_t entries() const { return offsets_.back(); }
+
+  // index of the file containing entry, or -1 if entry is not in the chain
+  int fileIndex(int64_t entry) const;
+
+  void clear();
+
+  // writes the metadata to filename. Returns false if the file can not be
+  // written
+  bool save(const std::string &filename) const;
+
+  // reads metadata written by save(). If the file can't be read or is
+  // malformed, returns false and the metadata is left empty
+  bool load(const std::string &filename);
+
+private:
+  // fills info for filename, by opening it
+  static void ScanFile(const std::string &filename, ChainFileInfo &info);
+
+  void computeOffsets();
+
+  std::vector<ChainFileInfo> files_;
+  std::vector<int64_t> offsets_;
+};
+
+} // namespace jetreader
+
+#endif // JETREADER_READER_CHAIN_METADATA_H
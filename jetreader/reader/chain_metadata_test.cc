@@ -0,0 +1,93 @@
+#include "gtest/gtest.h"
+
+#include "jetreader/lib/test_data.h"
+#include "jetreader/reader/chain_metadata.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+TEST(ChainMetadata, ReadFileList) {
+  EXPECT_TRUE(jetreader::ChainMetadata::IsFileList("files.list"));
+  EXPECT_TRUE(jetreader::ChainMetadata::IsFileList("files.lis"));
+  EXPECT_FALSE(jetreader::ChainMetadata::IsFileList("test.picoDst.root"));
+
+  std::string list = "chain_metadata_test_tmp.list";
+  std::ofstream out(list);
+  out << "a.picoDst.root\n";
+  out << "b.picoDst.root 1000\n";
+  out << "c.root\n";
+  out << "\n";
+  out << "d.picoDst.root\n";
+  out.close();
+
+  std::vector<std::string> expected{"a.picoDst.root", "b.picoDst.root",
+                                    "d.picoDst.root"};
+  EXPECT_EQ(jetreader::ChainMetadata::ReadFileList(list), expected);
+  remove(list.c_str());
+}
+
+TEST(ChainMetadata, Build) {
+  std::string test_file = jetreader::GetTestFile();
+  std::vector<std::string> files{test_file, "missing.picoDst.root",
+                                 test_file};
+
+  jetreader::ChainMetadata metadata;
+  metadata.build(files, 2);
+  ASSERT_EQ(metadata.files().size(), 3);
+  EXPECT_TRUE(metadata.files()[0].good);
+  EXPECT_FALSE(metadata.files()[1].good);
+  EXPECT_TRUE(metadata.files()[2].good);
+  EXPECT_EQ(metadata.files()[0].fingerprint.entries, 624);
+  EXPECT_FALSE(metadata.files()[0].run_ids.empty());
+  EXPECT_EQ(metadata.entries(), 2 * 624);
+
+  std::vector<int64_t> offsets{0, 624, 624, 2 * 624};
+  EXPECT_EQ(metadata.offsets(), offsets);
+  EXPECT_EQ(metadata.fileIndex(0), 0);
+  EXPECT_EQ(metadata.fileIndex(623), 0);
+  EXPECT_EQ(metadata.fileIndex(624), 2);
+  EXPECT_EQ(metadata.fileIndex(2 * 624), -1);
+  EXPECT_EQ(metadata.fileIndex(-1), -1);
+
+  EXPECT_TRUE(metadata.matches(files));
+  EXPECT_FALSE(metadata.matches({test_file, test_file}));
+}
+
+TEST(ChainMetadata, SaveAndLoad) {
+  std::string test_file = jetreader::GetTestFile();
+  std::vector<std::string> files{test_file, test_file};
+  std::string filename = "chain_metadata_test_tmp.chainmeta";
+
+  jetreader::ChainMetadata metadata;
+  metadata.build(files, 1);
+  ASSERT_TRUE(metadata.save(filename));
+
+  jetreader::ChainMetadata loaded;
+  ASSERT_TRUE(loaded.load(filename));
+  EXPECT_TRUE(loaded.matches(files));
+  EXPECT_EQ(loaded.offsets(), metadata.offsets());
+  ASSERT_EQ(loaded.files().size(), metadata.files().size());
+  for (size_t i = 0; i < files.size(); ++i) {
+    EXPECT_EQ(loaded.files()[i].filename, metadata.files()[i].filename);
+    EXPECT_EQ(loaded.files()[i].run_ids, metadata.files()[i].run_ids);
+    EXPECT_TRUE(loaded.files()[i].fingerprint ==
+                metadata.files()[i].fingerprint);
+  }
+
+  // files that are already known are not opened again
+  jetreader::ChainMetadata rebuilt;
+  rebuilt.build({test_file, "missing.picoDst.root"}, 1, &loaded);
+  EXPECT_EQ(rebuilt.entries(), 624);
+
+  // a corrupted file is not used
+  std::ofstream out(filename);
+  out << "jetreader_chain_metadata_v1 2\n1 10 10 624 0\n";
+  out.close();
+  EXPECT_FALSE(loaded.load(filename));
+  EXPECT_EQ(loaded.entries(), 0);
+  EXPECT_FALSE(loaded.load("chain_metadata_test_missing.chainmeta"));
+
+  remove(filename.c_str());
+}
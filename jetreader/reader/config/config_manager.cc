@@ -7,6 +7,7 @@
 #include "jetreader/reader/reader.h"
 
 #include <fstream>
+#include <sstream>
 
 #include "yaml-cpp/yaml.h"
 
@@ -36,9 +37,19 @@ void ConfigManager::loadConfig(const std::string &filename) {
 }
 
 void ConfigManager::writeConfig(const std::string &filename) {
+  std::string config = configString();
+
+  // write to file
+  std::ofstream out;
+  out.open(filename);
+  out << config;
+  out.close();
+}
+
+std::string ConfigManager::configString() {
   JETREADER_ASSERT(reader_ != nullptr,
                    "attempted to write a config, but reader is unspecified");
-  
+
   // read config from ConfigHelpers
   YAML::Node config;
   config[readerKey()] = readReaderConfig();
@@ -46,13 +57,37 @@ void ConfigManager::writeConfig(const std::string &filename) {
   config[trackSelectorKey()] = readTrackSelectorConfig();
   config[eventSelectorKey()] = readEventSelectorConfig();
 
-  // write to file
+  std::stringstream stream;
+  stream << config;
+  return stream.str();
+}
+
+void ConfigManager::writeCutFlow(const std::string &filename) {
+  std::string cut_flow = cutFlowString();
+
   std::ofstream out;
   out.open(filename);
-  out << config;
+  out << cut_flow;
   out.close();
 }
 
+std::string ConfigManager::cutFlowString() {
+  JETREADER_ASSERT(reader_ != nullptr,
+                   "attempted to write a cut flow, but reader is unspecified");
+
+  YAML::Node cut_flow;
+  cut_flow[eventSelectorKey()] =
+      readCutFlow(reader_->eventSelector()->cutFlow());
+  cut_flow[trackSelectorKey()] =
+      readCutFlow(reader_->trackSelector()->cutFlow());
+  cut_flow[towerSelectorKey()] =
+      readCutFlow(reader_->towerSelector()->cutFlow());
+
+  std::stringstream stream;
+  stream << cut_flow;
+  return stream.str();
+}
+
 void ConfigManager::loadReaderConfig(YAML::Node &node) {
   if (node.size() == 0)
     return;
@@ -117,4 +152,20 @@ YAML::Node ConfigManager::readEventSelectorConfig() {
   return helper.readConfig(*reader_->eventSelector());
 }
 
+YAML::Node ConfigManager::readCutFlow(const CutFlow &flow) {
+  YAML::Node node;
+  node[cutFlowTestedKey()] = flow.tested();
+  node[cutFlowAcceptedKey()] = flow.accepted();
+  for (auto &cut : flow.cuts()) {
+    YAML::Node cut_node;
+    cut_node[cutFlowNameKey()] = cut.name;
+    cut_node[cutFlowTestedKey()] = cut.tested;
+    cut_node[cutFlowPassedKey()] = cut.passed;
+    if (flow.timing())
+      cut_node[cutFlowSecondsKey()] = cut.nanoseconds * 1e-9;
+    node[cutFlowCutsKey()].push_back(cut_node);
+  }
+  return node;
+}
+
 } // namespace jetreader
\ No newline at end of file
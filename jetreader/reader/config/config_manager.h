@@ -9,6 +9,7 @@ class Node;
 
 namespace jetreader {
 
+class CutFlow;
 class Reader;
 
 class ConfigManager {
@@ -21,6 +22,22 @@ public:
 
   void writeConfig(const std::string &filename);
 
+  // the config that writeConfig() would write, as a YAML string
+  std::string configString();
+
+  // writes the cut flows of the reader's selectors (see CutFlow), under the
+  // same keys as the selector configs
+  void writeCutFlow(const std::string &filename);
+  std::string cutFlowString();
+
+  // keys of each cut flow
+  std::string cutFlowTestedKey() { return cut_flow_tested_key_; }
+  std::string cutFlowAcceptedKey() { return cut_flow_accepted_key_; }
+  std::string cutFlowCutsKey() { return cut_flow_cuts_key_; }
+  std::string cutFlowNameKey() { return cut_flow_name_key_; }
+  std::string cutFlowPassedKey() { return cut_flow_passed_key_; }
+  std::string cutFlowSecondsKey() { return cut_flow_seconds_key_; }
+
   std::string readerKey() { return reader_key_; }
   std::string eventSelectorKey() { return event_selector_key_; }
   std::string towerSelectorKey() { return tower_selector_key_; }
@@ -37,12 +54,21 @@ private:
   YAML::Node readTrackSelectorConfig();
   YAML::Node readEventSelectorConfig();
 
+  YAML::Node readCutFlow(const CutFlow &flow);
+
   Reader *reader_;
 
   std::string reader_key_ = "reader";
   std::string event_selector_key_ = "eventSelector";
   std::string tower_selector_key_ = "towerSelector";
   std::string track_selector_key_ = "trackSelector";
+
+  std::string cut_flow_tested_key_ = "tested";
+  std::string cut_flow_accepted_key_ = "accepted";
+  std::string cut_flow_cuts_key_ = "cuts";
+  std::string cut_flow_name_key_ = "name";
+  std::string cut_flow_passed_key_ = "passed";
+  std::string cut_flow_seconds_key_ = "seconds";
 };
 
 } // namespace jetreader
@@ -65,6 +65,12 @@ void EventSelectorConfigHelper::loadConfig(EventSelector &sel,
                                 node[refmultTypeKey()].as<unsigned>()));
       else
         sel.setRefMultRange(min, max);
+    } else if (entry.first.as<std::string>() == expressionsKey()) {
+      for (auto &&expression : entry.second)
+        sel.addExpression(expression.as<std::string>());
+    } else if (entry.first.as<std::string>() == adaptiveCutOrderKey()) {
+      unsigned warmup = entry.second.as<unsigned>();
+      sel.useAdaptiveCutOrder(warmup > 0, warmup);
     } else if (entry.first.as<std::string>() == refmultTypeKey()) {
       // refmulttype by itself is not useful - will be used along with
       // refmultKey
@@ -135,6 +141,16 @@ YAML::Node EventSelectorConfigHelper::readConfig(EventSelector &sel) {
     config[badRunIdFilekey()] = bad_run_id_file_node;
   }
 
+  if (sel.expressions_.size()) {
+    YAML::Node expression_node;
+    for (auto &expression : sel.expressions_)
+      expression_node.push_back(expression.expression());
+    config[expressionsKey()] = expression_node;
+  }
+
+  if (sel.cut_order_.adaptive())
+    config[adaptiveCutOrderKey()] = sel.cut_order_.warmup();
+
   return config;
 }
 
@@ -31,6 +31,8 @@ public:
   std::string maxDVzKey() { return dvz_max_key_; }
   std::string refmultTypeKey() { return refmult_type_key_; }
   std::string refmultKey() { return refmult_key_; }
+  std::string expressionsKey() { return expressions_key_; }
+  std::string adaptiveCutOrderKey() { return adaptive_cut_order_key_; }
 
 private:
   std::string trigger_id_key_ = "triggerIds";
@@ -44,6 +46,8 @@ private:
   std::string dvz_max_key_ = "dvzMax";
   std::string refmult_type_key_ = "refMultType";
   std::string refmult_key_ = "refMultRange";
+  std::string expressions_key_ = "expressions";
+  std::string adaptive_cut_order_key_ = "adaptiveCutOrderWarmup";
 };
 
 } // namespace jetreader
@@ -355,3 +355,53 @@ TEST(EventSelectorConfigHelper, testLoadConfigBadRunFile) {
   if (remove(file_name.c_str()) != 0)
     std::cerr << "error removing file after test: " << file_name << std::endl;
 }
+
+TEST(EventSelectorConfigHelper, testLoadConfigExpressions) {
+  jetreader::EventSelectorConfigHelper helper;
+  YAML::Node event_config;
+  event_config[helper.expressionsKey()].push_back("abs(vz - vzVpd) < 2");
+
+  TestSelector selector;
+  helper.loadConfig(selector, event_config);
+  ASSERT_EQ(selector.expressions().size(), 1);
+
+  StPicoEvent event;
+  SetDefaultEventParameters(event);
+  EXPECT_EQ(jetreader::EventStatus::acceptEvent, selector.select(&event));
+
+  event.setVzVpd(8.0);
+  EXPECT_EQ(jetreader::EventStatus::rejectEvent, selector.select(&event));
+
+  YAML::Node written = helper.readConfig(selector);
+  ASSERT_EQ(written[helper.expressionsKey()].size(), 1);
+  EXPECT_EQ(written[helper.expressionsKey()][0].as<std::string>(),
+            "abs(vz - vzVpd) < 2");
+}
+
+TEST(EventSelectorConfigHelper, testLoadConfigAdaptiveCutOrder) {
+  jetreader::EventSelectorConfigHelper helper;
+  YAML::Node event_config;
+  event_config[helper.vzKey()].push_back(-10.0);
+  event_config[helper.vzKey()].push_back(10.0);
+  event_config[helper.maxDVzKey()] = 3.0;
+  event_config[helper.adaptiveCutOrderKey()] = 5;
+
+  TestSelector adaptive;
+  helper.loadConfig(adaptive, event_config);
+  EXPECT_TRUE(adaptive.adaptiveCutOrder());
+
+  TestSelector fixed;
+  fixed.setVzRange(-10.0, 10.0);
+  fixed.setdVzMax(3.0);
+
+  StPicoEvent event;
+  SetDefaultEventParameters(event);
+  for (int i = 0; i < 20; ++i) {
+    event.setPrimaryVertexPosition(0.0, -0.3, -15.0 + 1.5 * i);
+    EXPECT_EQ(fixed.select(&event), adaptive.select(&event));
+  }
+  EXPECT_FALSE(adaptive.cutOrder().warmingUp());
+
+  YAML::Node written = helper.readConfig(adaptive);
+  EXPECT_EQ(written[helper.adaptiveCutOrderKey()].as<unsigned>(), 5);
+}
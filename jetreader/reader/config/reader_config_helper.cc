@@ -21,6 +21,27 @@ void ReaderConfigHelper::loadConfig(Reader &reader, YAML::Node &node) {
       reader.useHadronicCorrection(entry.second.as<bool>(), fraction);
     } else if (entry.first.as<std::string>() == mipCorrectionKey()) {
       reader.useMIPCorrection(entry.second.as<bool>());
+    } else if (entry.first.as<std::string>() == cutFlowKey()) {
+      bool timing = false;
+      if (node[cutFlowTimingKey()])
+        timing = node[cutFlowTimingKey()].as<bool>();
+      reader.useCutFlow(entry.second.as<bool>(), timing);
+    } else if (entry.first.as<std::string>() == towerEnergyFloorKey()) {
+      reader.setTowerEnergyFloor(entry.second.as<double>());
+    } else if (entry.first.as<std::string>() == trackTowerMatchingKey()) {
+      std::string matching = entry.second.as<std::string>();
+      if (matching == "picoDst")
+        reader.setTrackTowerMatching(TrackTowerMatching::picoDst);
+      else if (matching == "grid")
+        reader.setTrackTowerMatching(TrackTowerMatching::grid);
+      else
+        std::cerr << "unknown track-tower matching in ReaderConfig: "
+                  << matching << std::endl;
+    } else if (entry.first.as<std::string>() == trackTowerMatchDistanceKey()) {
+      reader.setTrackTowerMatchDistance(entry.second.as<double>());
+    } else if (entry.first.as<std::string>() == cutFlowTimingKey()) {
+      // handled with cutFlowKey(), like hadronicCorrFracKey()
+      continue;
     } else if (entry.first.as<std::string>() == hadronicCorrFracKey()) {
       // hadronic correction is handled once - triggered by
       // hadronicCorrectionKey() so if its not present, hadronicCorrFracKey()
@@ -41,6 +62,14 @@ YAML::Node ReaderConfigHelper::readConfig(Reader &reader) {
   if (reader.use_had_corr_)
     config[hadronicCorrFracKey()] = reader.had_corr_fraction_;
   config[mipCorrectionKey()] = reader.use_mip_corr_;
+  config[cutFlowKey()] = reader.use_cut_flow_;
+  if (reader.use_cut_flow_)
+    config[cutFlowTimingKey()] = reader.cut_flow_timing_;
+  config[towerEnergyFloorKey()] = reader.tower_energy_floor_;
+  config[trackTowerMatchingKey()] =
+      reader.track_tower_matching_ == TrackTowerMatching::grid ? "grid"
+                                                               : "picoDst";
+  config[trackTowerMatchDistanceKey()] = reader.trackTowerMatchDistance();
   return config;
 }
 } // namespace jetreader
\ No newline at end of file
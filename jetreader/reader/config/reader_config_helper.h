@@ -24,12 +24,24 @@ public:
   std::string hadronicCorrectionKey() { return use_had_corr_key_; }
   std::string hadronicCorrFracKey() { return had_corr_frac_key_; }
   std::string mipCorrectionKey() { return use_mip_corr_key_; }
+  std::string cutFlowKey() { return use_cut_flow_key_; }
+  std::string cutFlowTimingKey() { return cut_flow_timing_key_; }
+  std::string towerEnergyFloorKey() { return tower_energy_floor_key_; }
+  std::string trackTowerMatchingKey() { return track_tower_matching_key_; }
+  std::string trackTowerMatchDistanceKey() {
+    return track_tower_match_distance_key_;
+  }
 
 private:
   std::string primary_track_key_ = "usePrimary";
   std::string use_had_corr_key_ = "useHadronicCorrection";
   std::string had_corr_frac_key_ = "hadronicCorrectionFraction";
   std::string use_mip_corr_key_ = "useMIPCorrection";
+  std::string use_cut_flow_key_ = "useCutFlow";
+  std::string cut_flow_timing_key_ = "cutFlowTiming";
+  std::string tower_energy_floor_key_ = "towerEnergyFloor";
+  std::string track_tower_matching_key_ = "trackTowerMatching";
+  std::string track_tower_match_distance_key_ = "trackTowerMatchDistance";
 };
 
 } // namespace jetreader
@@ -64,4 +64,22 @@ TEST(ReaderConfigHelper, generalConfig) {
               << std::endl;
   if (remove(file_name.c_str()) != 0)
     std::cerr << "error removing file after test: " << file_name << std::endl;
-}
\ No newline at end of file
+}
+TEST(ReaderConfigHelper, trackTowerMatching) {
+  jetreader::ReaderConfigHelper helper;
+  jetreader::Reader reader(jetreader::GetTestFile());
+  EXPECT_EQ(reader.trackTowerMatching(),
+            jetreader::TrackTowerMatching::picoDst);
+
+  YAML::Node node;
+  node[helper.trackTowerMatchingKey()] = "grid";
+  node[helper.trackTowerMatchDistanceKey()] = 0.03;
+  helper.loadConfig(reader, node);
+  EXPECT_EQ(reader.trackTowerMatching(), jetreader::TrackTowerMatching::grid);
+  EXPECT_DOUBLE_EQ(reader.trackTowerMatchDistance(), 0.03);
+
+  YAML::Node written = helper.readConfig(reader);
+  EXPECT_EQ(written[helper.trackTowerMatchingKey()].as<std::string>(), "grid");
+  EXPECT_DOUBLE_EQ(written[helper.trackTowerMatchDistanceKey()].as<double>(),
+                   0.03);
+}
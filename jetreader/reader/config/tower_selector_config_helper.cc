@@ -24,6 +24,9 @@ void TowerSelectorConfigHelper::loadConfig(TowerSelector &sel,
     } else if (entry.first.as<std::string>() == badTowerFileKey()) {
       for (auto &&tow : entry.second)
         sel.addBadTowers(tow.as<std::string>());
+    } else if (entry.first.as<std::string>() == expressionsKey()) {
+      for (auto &&expression : entry.second)
+        sel.addExpression(expression.as<std::string>());
     } else
       std::cerr << "unknown key in TowerSelectorConfig: "
                 << entry.first.as<std::string>() << std::endl;
@@ -45,6 +48,8 @@ YAML::Node TowerSelectorConfigHelper::readConfig(TowerSelector &sel) {
     for (auto &file : sel.bad_tower_files_)
       config[badTowerFileKey()].push_back(file);
   }
+  for (auto &expression : sel.expressions_)
+    config[expressionsKey()].push_back(expression.expression());
 
   return config;
 }
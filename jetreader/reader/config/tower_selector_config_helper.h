@@ -25,6 +25,7 @@ public:
   std::string maxEtKey() { return max_et_key_; }
   std::string minEtKey() { return min_et_key_; }
   std::string maxEtFailEventKey() { return fail_event_max_et_key_; }
+  std::string expressionsKey() { return expressions_key_; }
 
 private:
   std::string bad_tower_key_ = "badTowers";
@@ -32,6 +33,7 @@ private:
   std::string max_et_key_ = "EtMax";
   std::string min_et_key_ = "EtMin";
   std::string fail_event_max_et_key_ = "rejectEventOnMaxEtFailure";
+  std::string expressions_key_ = "expressions";
 };
 
 } // namespace jetreader
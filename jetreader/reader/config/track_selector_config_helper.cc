@@ -26,6 +26,12 @@ void TrackSelectorConfigHelper::loadConfig(TrackSelector &sel,
       sel.setChi2Max(entry.second.as<double>());
     } else if (entry.first.as<std::string>() == maxPtFailEventKey()) {
       sel.rejectEventOnPtFailure(entry.second.as<bool>());
+    } else if (entry.first.as<std::string>() == expressionsKey()) {
+      for (auto &&expression : entry.second)
+        sel.addExpression(expression.as<std::string>());
+    } else if (entry.first.as<std::string>() == adaptiveCutOrderKey()) {
+      unsigned warmup = entry.second.as<unsigned>();
+      sel.useAdaptiveCutOrder(warmup > 0, warmup);
     } else
       std::cerr << "unknown key in TrackSelectorConfig: "
                 << entry.first.as<std::string>() << std::endl;
@@ -46,6 +52,10 @@ YAML::Node TrackSelectorConfigHelper::readConfig(TrackSelector &sel) {
   if (sel.chi2_active_)
     config[maxPtKey()] = sel.chi2_max_;
   config[maxPtFailEventKey()] = sel.reject_event_on_pt_failure_;
+  for (auto &expression : sel.expressions_)
+    config[expressionsKey()].push_back(expression.expression());
+  if (sel.cut_order_.adaptive())
+    config[adaptiveCutOrderKey()] = sel.cut_order_.warmup();
 
   return config;
 }
@@ -27,6 +27,8 @@ public:
   std::string minPtKey() { return min_pt_key_; }
   std::string maxChi2Key() { return chi2_max_key_; }
   std::string maxPtFailEventKey() { return fail_event_max_pt_key_; }
+  std::string expressionsKey() { return expressions_key_; }
+  std::string adaptiveCutOrderKey() { return adaptive_cut_order_key_; }
 
 private:
   std::string dca_key_ = "maxDCA";
@@ -36,6 +38,8 @@ private:
   std::string min_pt_key_ = "PtMin";
   std::string chi2_max_key_ = "chi2Max";
   std::string fail_event_max_pt_key_ = "rejectEventOnMaxPtFailure";
+  std::string expressions_key_ = "expressions";
+  std::string adaptive_cut_order_key_ = "adaptiveCutOrderWarmup";
 };
 
 } // namespace jetreader
@@ -346,4 +346,32 @@ TEST(TrackSelectorConfigHelper, PtMin) {
               << std::endl;
   if (remove(file_name.c_str()) != 0)
     std::cerr << "error removing file after test: " << file_name << std::endl;
-}
\ No newline at end of file
+}
+TEST(TrackSelectorConfigHelper, Expressions) {
+  jetreader::TrackSelectorConfigHelper helper;
+  YAML::Node track_config;
+  track_config[helper.expressionsKey()].push_back("nHitsFit > 15");
+  track_config[helper.expressionsKey()].push_back("abs(gDCAz) < 1");
+
+  TestSelector selector;
+  helper.loadConfig(selector, track_config);
+  ASSERT_EQ(selector.expressions().size(), 2);
+
+  TVector3 vertex(0, 0, 0);
+  StPicoTrack track;
+  SetDefaultTrack(track);
+  EXPECT_EQ(jetreader::TrackStatus::acceptTrack,
+            selector.select(&track, vertex));
+
+  track.setOrigin(0.0, 0.0, 1.5);
+  EXPECT_EQ(jetreader::TrackStatus::rejectTrack,
+            selector.select(&track, vertex));
+
+  // the expressions are written back unchanged
+  YAML::Node written = helper.readConfig(selector);
+  ASSERT_EQ(written[helper.expressionsKey()].size(), 2);
+  EXPECT_EQ(written[helper.expressionsKey()][0].as<std::string>(),
+            "nHitsFit > 15");
+  EXPECT_EQ(written[helper.expressionsKey()][1].as<std::string>(),
+            "abs(gDCAz) < 1");
+}
@@ -0,0 +1,463 @@
+#include "jetreader/reader/cut_expression.h"
+
+#include "jetreader/lib/assert.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <utility>
+
+namespace jetreader {
+
+namespace {
+
+// applies f to every element of a
+template <class F> void UnaryLoop(double *a, size_t n, F f) {
+  for (size_t i = 0; i < n; ++i)
+    a[i] = f(a[i]);
+}
+
+// sets a[i] = f(a[i], b[i]) for every element
+template <class F> void BinaryLoop(double *a, const double *b, size_t n, F f) {
+  for (size_t i = 0; i < n; ++i)
+    a[i] = f(a[i], b[i]);
+}
+
+} // namespace
+
+// recursive descent parser, emitting postfix code into the CutExpression. In
+// order of increasing precedence: ||, &&, comparisons, + and -, * and /, unary
+// operators, and finally numbers, fields, function calls and parentheses
+class CutExpression::Parser {
+public:
+  Parser(CutExpression &expr, const std::vector<std::string> &fields)
+      : expr_(expr), fields_(fields), text_(expr.expression_), pos_(0),
+        stack_(0) {}
+
+  void parse() {
+    parseOr();
+    skipSpace();
+    if (pos_ != text_.size())
+      fail("unexpected '", text_.substr(pos_), "'");
+  }
+
+private:
+  void parseOr() {
+    parseAnd();
+    while (accept("||")) {
+      parseAnd();
+      emit(Op::logicalOr);
+    }
+  }
+
+  void parseAnd() {
+    parseComparison();
+    while (accept("&&")) {
+      parseComparison();
+      emit(Op::logicalAnd);
+    }
+  }
+
+  void parseComparison() {
+    parseSum();
+    while (true) {
+      Op op;
+      if (accept("<="))
+        op = Op::le;
+      else if (accept(">="))
+        op = Op::ge;
+      else if (accept("=="))
+        op = Op::eq;
+      else if (accept("!="))
+        op = Op::ne;
+      else if (accept("<"))
+        op = Op::lt;
+      else if (accept(">"))
+        op = Op::gt;
+      else
+        return;
+      parseSum();
+      emit(op);
+    }
+  }
+
+  void parseSum() {
+    parseProduct();
+    while (true) {
+      Op op;
+      if (accept("+"))
+        op = Op::add;
+      else if (accept("-"))
+        op = Op::sub;
+      else
+        return;
+      parseProduct();
+      emit(op);
+    }
+  }
+
+  void parseProduct() {
+    parseUnary();
+    while (true) {
+      Op op;
+      if (accept("*"))
+        op = Op::mul;
+      else if (accept("/"))
+        op = Op::div;
+      else
+        return;
+      parseUnary();
+      emit(op);
+    }
+  }
+
+  void parseUnary() {
+    if (accept("-")) {
+      parseUnary();
+      emit(Op::neg);
+    } else if (accept("!")) {
+      parseUnary();
+      emit(Op::logicalNot);
+    } else if (accept("+")) {
+      parseUnary();
+    } else {
+      parsePrimary();
+    }
+  }
+
+  void parsePrimary() {
+    skipSpace();
+    if (pos_ == text_.size())
+      fail("unexpected end of expression");
+
+    if (accept("(")) {
+      parseOr();
+      expect(")");
+      return;
+    }
+
+    char c = text_[pos_];
+    if (std::isdigit(c) || c == '.') {
+      const char *begin = text_.c_str() + pos_;
+      char *end = nullptr;
+      double value = std::strtod(begin, &end);
+      if (end == begin)
+        fail("invalid number at '", text_.substr(pos_), "'");
+      pos_ += end - begin;
+      expr_.constants_.push_back(value);
+      emit(Op::constant, expr_.constants_.size() - 1);
+      return;
+    }
+
+    if (std::isalpha(c) || c == '_') {
+      size_t begin = pos_;
+      while (pos_ < text_.size() &&
+             (std::isalnum(text_[pos_]) || text_[pos_] == '_'))
+        ++pos_;
+      std::string name = text_.substr(begin, pos_ - begin);
+      if (accept("(")) {
+        parseFunction(name);
+        return;
+      }
+      auto it = std::find(fields_.begin(), fields_.end(), name);
+      if (it == fields_.end())
+        fail("unknown field '", name, "'");
+      emit(Op::field, it - fields_.begin());
+      return;
+    }
+
+    fail("unexpected '", text_.substr(pos_), "'");
+  }
+
+  // parses the arguments and closing parenthesis of a function call
+  void parseFunction(const std::string &name) {
+    if (name == "abs" || name == "sqrt") {
+      parseOr();
+      expect(")");
+      emit(name == "abs" ? Op::abs : Op::sqrt);
+    } else if (name == "min" || name == "max") {
+      parseOr();
+      expect(",");
+      parseOr();
+      expect(")");
+      emit(name == "min" ? Op::min : Op::max);
+    } else {
+      fail("unknown function '", name, "'");
+    }
+  }
+
+  // emits an instruction, and keeps track of the stack depth
+  void emit(Op op, unsigned arg = 0) {
+    expr_.emit(op, arg);
+    switch (op) {
+    case Op::constant:
+    case Op::field:
+      ++stack_;
+      break;
+    case Op::neg:
+    case Op::logicalNot:
+    case Op::abs:
+    case Op::sqrt:
+      break;
+    default:
+      --stack_;
+      break;
+    }
+    expr_.depth_ = std::max(expr_.depth_, stack_);
+  }
+
+  void skipSpace() {
+    while (pos_ < text_.size() && std::isspace(text_[pos_]))
+      ++pos_;
+  }
+
+  bool peek(const std::string &token) {
+    skipSpace();
+    return text_.compare(pos_, token.size(), token) == 0;
+  }
+
+  bool accept(const std::string &token) {
+    if (!peek(token))
+      return false;
+    pos_ += token.size();
+    return true;
+  }
+
+  void expect(const std::string &token) {
+    if (!accept(token))
+      fail("expected '", token, "' at position ", pos_);
+  }
+
+  template <class... Args> void fail(Args &&... args) {
+    JETREADER_THROW("invalid cut expression \"", text_,
+                    "\": ", std::forward<Args>(args)...);
+  }
+
+  CutExpression &expr_;
+  const std::vector<std::string> &fields_;
+  const std::string &text_;
+  size_t pos_;
+  size_t stack_;
+};
+
+CutExpression::CutExpression(const std::string &expression,
+                             const std::vector<std::string> &fields)
+    : expression_(expression), depth_(0) {
+  Parser(*this, fields).parse();
+
+  for (auto &instruction : code_)
+    if (instruction.op == Op::field)
+      used_fields_.push_back(instruction.arg);
+  std::sort(used_fields_.begin(), used_fields_.end());
+  used_fields_.erase(std::unique(used_fields_.begin(), used_fields_.end()),
+                     used_fields_.end());
+}
+
+bool CutExpression::evaluate(const double *values) const {
+  // expressions rarely need a deep stack, so avoid allocating for each object
+  double local[16];
+  std::vector<double> heap;
+  double *stack = local;
+  if (depth_ > 16) {
+    heap.resize(depth_);
+    stack = heap.data();
+  }
+  size_t top = 0;
+  for (auto &instruction : code_) {
+    switch (instruction.op) {
+    case Op::constant:
+      stack[top++] = constants_[instruction.arg];
+      break;
+    case Op::field:
+      stack[top++] = values[instruction.arg];
+      break;
+    case Op::neg:
+    case Op::logicalNot:
+    case Op::abs:
+    case Op::sqrt:
+      stack[top - 1] = apply(instruction.op, stack[top - 1]);
+      break;
+    default:
+      stack[top - 2] = apply(instruction.op, stack[top - 2], stack[top - 1]);
+      --top;
+      break;
+    }
+  }
+  return stack[0] != 0.0;
+}
+
+void CutExpression::evaluate(const std::vector<const double *> &columns,
+                             size_t n, uint8_t *mask) const {
+  if (n == 0)
+    return;
+
+  // the stack holds one column of n values per entry, and each instruction
+  // is a single loop over all objects
+  if (stack_.size() < depth_ * n)
+    stack_.resize(depth_ * n);
+  double *stack = stack_.data();
+  size_t top = 0;
+  for (auto &instruction : code_) {
+    // next is the first free entry, a and b the operands of the instruction
+    double *next = stack + top * n;
+    double *a = nullptr;
+    double *b = nullptr;
+    switch (instruction.op) {
+    case Op::constant:
+    case Op::field:
+      break;
+    case Op::neg:
+    case Op::logicalNot:
+    case Op::abs:
+    case Op::sqrt:
+      a = next - n;
+      break;
+    default:
+      a = next - 2 * n;
+      b = next - n;
+      break;
+    }
+
+    switch (instruction.op) {
+    case Op::constant:
+      std::fill(next, next + n, constants_[instruction.arg]);
+      ++top;
+      break;
+    case Op::field:
+      std::copy(columns[instruction.arg], columns[instruction.arg] + n, next);
+      ++top;
+      break;
+    case Op::neg:
+      UnaryLoop(a, n, [](double x) { return -x; });
+      break;
+    case Op::logicalNot:
+      UnaryLoop(a, n, [](double x) { return (double)(x == 0.0); });
+      break;
+    case Op::abs:
+      UnaryLoop(a, n, [](double x) { return std::fabs(x); });
+      break;
+    case Op::sqrt:
+      UnaryLoop(a, n, [](double x) { return std::sqrt(x); });
+      break;
+    default:
+      switch (instruction.op) {
+      case Op::add:
+        BinaryLoop(a, b, n, [](double x, double y) { return x + y; });
+        break;
+      case Op::sub:
+        BinaryLoop(a, b, n, [](double x, double y) { return x - y; });
+        break;
+      case Op::mul:
+        BinaryLoop(a, b, n, [](double x, double y) { return x * y; });
+        break;
+      case Op::div:
+        BinaryLoop(a, b, n, [](double x, double y) { return x / y; });
+        break;
+      case Op::lt:
+        BinaryLoop(a, b, n,
+                   [](double x, double y) { return (double)(x < y); });
+        break;
+      case Op::le:
+        BinaryLoop(a, b, n,
+                   [](double x, double y) { return (double)(x <= y); });
+        break;
+      case Op::gt:
+        BinaryLoop(a, b, n,
+                   [](double x, double y) { return (double)(x > y); });
+        break;
+      case Op::ge:
+        BinaryLoop(a, b, n,
+                   [](double x, double y) { return (double)(x >= y); });
+        break;
+      case Op::eq:
+        BinaryLoop(a, b, n,
+                   [](double x, double y) { return (double)(x == y); });
+        break;
+      case Op::ne:
+        BinaryLoop(a, b, n,
+                   [](double x, double y) { return (double)(x != y); });
+        break;
+      case Op::logicalAnd:
+        BinaryLoop(a, b, n, [](double x, double y) {
+          return (double)((x != 0.0) & (y != 0.0));
+        });
+        break;
+      case Op::logicalOr:
+        BinaryLoop(a, b, n, [](double x, double y) {
+          return (double)((x != 0.0) | (y != 0.0));
+        });
+        break;
+      case Op::min:
+        BinaryLoop(a, b, n,
+                   [](double x, double y) { return y < x ? y : x; });
+        break;
+      default:
+        BinaryLoop(a, b, n,
+                   [](double x, double y) { return x < y ? y : x; });
+        break;
+      }
+      --top;
+      break;
+    }
+  }
+
+  const double *result = stack;
+  for (size_t i = 0; i < n; ++i)
+    mask[i] &= result[i] != 0.0;
+}
+
+double CutExpression::apply(Op op, double a) {
+  switch (op) {
+  case Op::neg:
+    return -a;
+  case Op::logicalNot:
+    return a == 0.0;
+  case Op::abs:
+    return std::fabs(a);
+  default:
+    return std::sqrt(a);
+  }
+}
+
+double CutExpression::apply(Op op, double a, double b) {
+  switch (op) {
+  case Op::add:
+    return a + b;
+  case Op::sub:
+    return a - b;
+  case Op::mul:
+    return a * b;
+  case Op::div:
+    return a / b;
+  case Op::lt:
+    return a < b;
+  case Op::le:
+    return a <= b;
+  case Op::gt:
+    return a > b;
+  case Op::ge:
+    return a >= b;
+  case Op::eq:
+    return a == b;
+  case Op::ne:
+    return a != b;
+  case Op::logicalAnd:
+    return a != 0.0 && b != 0.0;
+  case Op::logicalOr:
+    return a != 0.0 || b != 0.0;
+  case Op::min:
+    return b < a ? b : a;
+  default:
+    return a < b ? b : a;
+  }
+}
+
+void CutExpression::emit(Op op, unsigned arg) {
+  Instruction instruction;
+  instruction.op = op;
+  instruction.arg = arg;
+  code_.push_back(instruction);
+}
+
+} // namespace jetreader
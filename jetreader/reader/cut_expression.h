@@ -0,0 +1,95 @@
+#ifndef JETREADER_READER_CUT_EXPRESSION_H
+#define JETREADER_READER_CUT_EXPRESSION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace jetreader {
+
+// a selection cut given as an expression over a fixed set of named fields,
+// such as "nHitsFit / nHitsMax > 0.52 && abs(gDCAz) < 1". The expression is
+// parsed once into a postfix bytecode, which is evaluated either for a single
+// object, or for all objects of an event at once, with one loop over all
+// objects per instruction.
+//
+// Expressions can use numbers, field names, + - * /, the comparisons
+// < <= > >= == !=, && || !, unary -, parentheses, and the functions abs(),
+// sqrt(), min() and max(). Comparisons and logical operators evaluate to 1 or
+// 0, and an object passes the cut if the expression is nonzero.
+class CutExpression {
+public:
+  // parses expression. fields are the names that can be used in the
+  // expression: the value of fields[i] is looked up at index i when
+  // evaluating. Throws an AssertionFailure if the expression is not valid
+  CutExpression(const std::string &expression,
+                const std::vector<std::string> &fields);
+
+  const std::string &expression() const { return expression_; }
+
+  // indices of the fields used by the expression, sorted and unique
+  const std::vector<unsigned> &fields() const { return used_fields_; }
+
+  // evaluates the expression for one object, where values[i] is the value of
+  // field i. Only the fields in fields() are read
+  bool evaluate(const double *values) const;
+
+  // evaluates the expression for n objects, where columns[i] points to the n
+  // values of field i. Only the columns of fields in fields() are read. Sets
+  // mask[j] to 0 if object j fails the cut, and leaves it unchanged otherwise.
+  // The stack is kept between calls, so an expression must not be evaluated
+  // for several batches at once
+  void evaluate(const std::vector<const double *> &columns, size_t n,
+                uint8_t *mask) const;
+
+private:
+  enum class Op : uint8_t {
+    constant,
+    field,
+    neg,
+    logicalNot,
+    abs,
+    sqrt,
+    add,
+    sub,
+    mul,
+    div,
+    lt,
+    le,
+    gt,
+    ge,
+    eq,
+    ne,
+    logicalAnd,
+    logicalOr,
+    min,
+    max
+  };
+
+  struct Instruction {
+    Op op;
+    // index into constants_ or into the fields, for constant and field
+    unsigned arg;
+  };
+
+  class Parser;
+
+  static double apply(Op op, double a);
+  static double apply(Op op, double a, double b);
+
+  void emit(Op op, unsigned arg = 0);
+
+  std::string expression_;
+  std::vector<Instruction> code_;
+  std::vector<double> constants_;
+  std::vector<unsigned> used_fields_;
+  // maximum stack depth reached while evaluating code_
+  size_t depth_;
+  // stack of the batch evaluate(), grown to the largest batch
+  mutable std::vector<double> stack_;
+};
+
+} // namespace jetreader
+
+#endif // JETREADER_READER_CUT_EXPRESSION_H
@@ -0,0 +1,105 @@
+#include "gtest/gtest.h"
+
+#include "jetreader/lib/assert.h"
+#include "jetreader/reader/cut_expression.h"
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+const std::vector<std::string> FIELDS{"x", "y", "z"};
+
+// evaluates expression for a single object, both directly and as a batch of
+// one, and checks that both agree
+bool Evaluate(const std::string &expression, double x, double y, double z) {
+  jetreader::CutExpression cut(expression, FIELDS);
+  double values[] = {x, y, z};
+  bool ret = cut.evaluate(values);
+
+  std::vector<const double *> columns{&values[0], &values[1], &values[2]};
+  uint8_t mask = 1;
+  cut.evaluate(columns, 1, &mask);
+  EXPECT_EQ(ret, mask == 1) << expression;
+  return ret;
+}
+
+TEST(CutExpression, Arithmetic) {
+  EXPECT_TRUE(Evaluate("x + y * z == 7", 1, 2, 3));
+  EXPECT_TRUE(Evaluate("(x + y) * z == 9", 1, 2, 3));
+  EXPECT_TRUE(Evaluate("x - y - z == -4", 1, 2, 3));
+  EXPECT_TRUE(Evaluate("z / y / x == 1.5", 1, 2, 3));
+  EXPECT_TRUE(Evaluate("-x * -y == 2", 1, 2, 3));
+  EXPECT_TRUE(Evaluate("abs(x - z) == 2", 1, 2, 3));
+  EXPECT_TRUE(Evaluate("sqrt(z * 3) == 3", 1, 2, 3));
+  EXPECT_TRUE(Evaluate("min(x, y) == 1 && max(x, 2.5e0) == 2.5", 1, 2, 3));
+  EXPECT_TRUE(Evaluate("x", 1, 0, 0));
+  EXPECT_FALSE(Evaluate("x", 0, 1, 1));
+}
+
+TEST(CutExpression, Logic) {
+  EXPECT_TRUE(Evaluate("x < y && y <= 2 && z > y && z >= 3", 1, 2, 3));
+  EXPECT_FALSE(Evaluate("x < y && y < 2", 1, 2, 3));
+  EXPECT_TRUE(Evaluate("x > y || z > y", 1, 2, 3));
+  EXPECT_FALSE(Evaluate("x > y || z < y", 1, 2, 3));
+  EXPECT_TRUE(Evaluate("x != y", 1, 2, 3));
+  EXPECT_TRUE(Evaluate("!(x == y)", 1, 2, 3));
+  EXPECT_FALSE(Evaluate("!x", 1, 2, 3));
+  // && binds more strongly than ||
+  EXPECT_TRUE(Evaluate("x == 1 || x == 0 && y == 0", 1, 2, 3));
+  EXPECT_FALSE(Evaluate("(x == 1 || x == 0) && y == 0", 1, 2, 3));
+}
+
+TEST(CutExpression, Fields) {
+  jetreader::CutExpression cut("z > 1 && abs(x) < z", FIELDS);
+  EXPECT_EQ(cut.expression(), "z > 1 && abs(x) < z");
+  EXPECT_EQ(cut.fields(), std::vector<unsigned>({0, 2}));
+}
+
+TEST(CutExpression, Invalid) {
+  EXPECT_THROW(jetreader::CutExpression("", FIELDS),
+               jetreader::AssertionFailure);
+  EXPECT_THROW(jetreader::CutExpression("x >", FIELDS),
+               jetreader::AssertionFailure);
+  EXPECT_THROW(jetreader::CutExpression("w > 1", FIELDS),
+               jetreader::AssertionFailure);
+  EXPECT_THROW(jetreader::CutExpression("(x > 1", FIELDS),
+               jetreader::AssertionFailure);
+  EXPECT_THROW(jetreader::CutExpression("x > 1)", FIELDS),
+               jetreader::AssertionFailure);
+  EXPECT_THROW(jetreader::CutExpression("x & y", FIELDS),
+               jetreader::AssertionFailure);
+  EXPECT_THROW(jetreader::CutExpression("exp(x)", FIELDS),
+               jetreader::AssertionFailure);
+  EXPECT_THROW(jetreader::CutExpression("min(x)", FIELDS),
+               jetreader::AssertionFailure);
+}
+
+TEST(CutExpression, Batch) {
+  std::default_random_engine gen(3);
+  std::uniform_real_distribution<double> dist(-2.0, 2.0);
+  size_t n = 1000;
+  std::vector<std::vector<double>> values(3, std::vector<double>(n));
+  for (auto &column : values)
+    for (auto &value : column)
+      value = dist(gen);
+
+  jetreader::CutExpression cut("x * x + y * y < 1.5 && (z > 0 || !(x > 1))",
+                               FIELDS);
+  std::vector<const double *> columns{values[0].data(), values[1].data(),
+                                      values[2].data()};
+  std::vector<uint8_t> mask(n, 1);
+  // objects that are already rejected stay rejected
+  for (size_t i = 0; i < n; i += 3)
+    mask[i] = 0;
+  cut.evaluate(columns, n, mask.data());
+
+  for (size_t i = 0; i < n; ++i) {
+    double x = values[0][i];
+    double y = values[1][i];
+    double z = values[2][i];
+    bool expected =
+        i % 3 != 0 && x * x + y * y < 1.5 && (z > 0 || !(x > 1));
+    EXPECT_EQ(expected, mask[i] == 1);
+  }
+}
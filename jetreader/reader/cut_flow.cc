@@ -0,0 +1,96 @@
+#include "jetreader/reader/cut_flow.h"
+
+#include "jetreader/lib/assert.h"
+
+#include <iomanip>
+#include <sstream>
+
+namespace jetreader {
+
+CutFlow::CutFlow(const std::vector<std::string> &cut_names)
+    : active_(false), timing_(false), tested_(0), accepted_(0) {
+  for (auto &name : cut_names)
+    cuts_.push_back(Cut{name, 0, 0, 0});
+}
+
+void CutFlow::setActive(bool flag, bool timing) {
+  active_ = flag;
+  timing_ = flag && timing;
+}
+
+unsigned CutFlow::index(const std::string &name) const {
+  for (unsigned i = 0; i < cuts_.size(); ++i)
+    if (cuts_[i].name == name)
+      return i;
+  JETREADER_THROW("no cut named ", name, " in the cut flow");
+}
+
+void CutFlow::count(uint64_t tested, uint64_t accepted) {
+  if (active_) {
+    tested_ += tested;
+    accepted_ += accepted;
+  }
+}
+
+void CutFlow::record(unsigned cut, uint64_t tested, uint64_t passed) {
+  if (active_) {
+    cuts_[cut].tested += tested;
+    cuts_[cut].passed += passed;
+  }
+}
+
+void CutFlow::merge(const CutFlow &other) {
+  JETREADER_ASSERT(other.cuts_.size() == cuts_.size(),
+                   "can not merge cut flows with different cuts");
+  for (size_t i = 0; i < cuts_.size(); ++i) {
+    JETREADER_ASSERT(other.cuts_[i].name == cuts_[i].name,
+                     "can not merge cut flows with different cuts");
+    cuts_[i].tested += other.cuts_[i].tested;
+    cuts_[i].passed += other.cuts_[i].passed;
+    cuts_[i].nanoseconds += other.cuts_[i].nanoseconds;
+  }
+  tested_ += other.tested_;
+  accepted_ += other.accepted_;
+}
+
+std::string CutFlow::table() const {
+  std::stringstream stream;
+  stream << std::left << std::setw(14) << "cut" << std::right
+         << std::setw(14) << "tested" << std::setw(14) << "passed"
+         << std::setw(10) << "fraction";
+  if (timing_)
+    stream << std::setw(12) << "time [ms]";
+  stream << "\n";
+
+  stream << std::fixed;
+  for (auto &cut : cuts_) {
+    // cuts that were never applied are inactive
+    if (cut.tested == 0)
+      continue;
+    stream << std::left << std::setw(14) << cut.name << std::right
+           << std::setw(14) << cut.tested << std::setw(14) << cut.passed
+           << std::setw(10) << std::setprecision(4)
+           << (double)cut.passed / cut.tested;
+    if (timing_)
+      stream << std::setw(12) << std::setprecision(3)
+             << cut.nanoseconds * 1e-6;
+    stream << "\n";
+  }
+  stream << std::left << std::setw(14) << "total" << std::right
+         << std::setw(14) << tested_ << std::setw(14) << accepted_
+         << std::setw(10) << std::setprecision(4)
+         << (tested_ ? (double)accepted_ / tested_ : 0.0) << "\n";
+  return stream.str();
+}
+
+void CutFlow::reset() {
+  for (auto &cut : cuts_) {
+    cut.tested = 0;
+    cut.passed = 0;
+    cut.nanoseconds = 0;
+  }
+  tested_ = 0;
+  accepted_ = 0;
+}
+
+} // namespace jetreader
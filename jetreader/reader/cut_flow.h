@@ -0,0 +1,157 @@
+#ifndef JETREADER_READER_CUT_FLOW_H
+#define JETREADER_READER_CUT_FLOW_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace jetreader {
+
+// pass/fail counters, and optionally CPU time, for each cut of a selector.
+// Cuts are counted in the order they are applied: an object is only tested by
+// a cut if it passed all cuts before it, so the number of objects that pass a
+// cut is the number tested by the next active cut. Counting is off by default.
+//
+// Each selector owns its CutFlow, and a selector is only used by the thread
+// that runs its Reader, so counting needs no locks or atomics. The counts of
+// several readers, e.g. the workers of a ParallelReader, are added together
+// with merge().
+class CutFlow {
+public:
+  struct Cut {
+    std::string name;
+    // number of objects the cut was applied to, and that passed it
+    uint64_t tested;
+    uint64_t passed;
+    // time spent in the cut, only counted if timing is on
+    uint64_t nanoseconds;
+  };
+
+  explicit CutFlow(const std::vector<std::string> &cut_names);
+
+  // turns counting on or off. Timing measures the time spent in each cut as
+  // well, which costs two clock reads per cut and object
+  void setActive(bool flag, bool timing = false);
+  bool active() const { return active_; }
+  bool timing() const { return timing_; }
+
+  const std::vector<Cut> &cuts() const { return cuts_; }
+
+  // index of the cut called name. Throws an AssertionFailure if there is none
+  unsigned index(const std::string &name) const;
+
+  // number of objects passed to the selector, and accepted by it
+  uint64_t tested() const { return tested_; }
+  uint64_t accepted() const { return accepted_; }
+
+  // evaluates the cut f() for one object, and counts the result
+  template <class F> bool check(unsigned cut, F &&f);
+
+  // applies the cut f() to a batch of n objects, where mask[i] is 1 for the
+  // objects that are still accepted. f() clears the mask of objects failing
+  // the cut
+  template <class F>
+  void checkBatch(unsigned cut, const uint8_t *mask, size_t n, F &&f);
+
+  // counts the final decision of the selector for one object, or for a batch
+  // of tested objects of which accepted are accepted
+  void count(bool accept) {
+    if (active_) {
+      ++tested_;
+      accepted_ += accept;
+    }
+  }
+  void count(uint64_t tested, uint64_t accepted);
+
+  // counts tested objects that were decided by a cut without evaluating it,
+  // e.g. entries of a bad run skipped using the run index
+  void record(unsigned cut, uint64_t tested, uint64_t passed);
+
+  // adds the counts of other, which must have the same cuts
+  void merge(const CutFlow &other);
+
+  // a human readable table of the counts
+  std::string table() const;
+
+  // resets all counts to zero
+  void reset();
+
+  // turns counting off while in scope, for objects that are selected a second
+  // time and should only be counted once. Does nothing if pause is false
+  class Pause {
+  public:
+    explicit Pause(CutFlow &flow, bool pause = true)
+        : flow_(flow), active_(flow.active_) {
+      if (pause)
+        flow_.active_ = false;
+    }
+    ~Pause() { flow_.active_ = active_; }
+
+  private:
+    CutFlow &flow_;
+    bool active_;
+  };
+
+private:
+  typedef std::chrono::steady_clock Clock;
+
+  static uint64_t Nanoseconds(Clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() -
+                                                                start)
+        .count();
+  }
+
+  static uint64_t CountAccepted(const uint8_t *mask, size_t n) {
+    uint64_t accepted = 0;
+    for (size_t i = 0; i < n; ++i)
+      accepted += mask[i];
+    return accepted;
+  }
+
+  bool active_;
+  bool timing_;
+  std::vector<Cut> cuts_;
+  uint64_t tested_;
+  uint64_t accepted_;
+};
+
+template <class F> bool CutFlow::check(unsigned cut, F &&f) {
+  if (!active_)
+    return f();
+
+  bool pass;
+  if (timing_) {
+    Clock::time_point start = Clock::now();
+    pass = f();
+    cuts_[cut].nanoseconds += Nanoseconds(start);
+  } else {
+    pass = f();
+  }
+  ++cuts_[cut].tested;
+  cuts_[cut].passed += pass;
+  return pass;
+}
+
+template <class F>
+void CutFlow::checkBatch(unsigned cut, const uint8_t *mask, size_t n, F &&f) {
+  if (!active_) {
+    f();
+    return;
+  }
+
+  cuts_[cut].tested += CountAccepted(mask, n);
+  if (timing_) {
+    Clock::time_point start = Clock::now();
+    f();
+    cuts_[cut].nanoseconds += Nanoseconds(start);
+  } else {
+    f();
+  }
+  cuts_[cut].passed += CountAccepted(mask, n);
+}
+
+} // namespace jetreader
+
+#endif // JETREADER_READER_CUT_FLOW_H
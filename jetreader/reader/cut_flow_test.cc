@@ -0,0 +1,96 @@
+#include "gtest/gtest.h"
+
+#include "jetreader/lib/assert.h"
+#include "jetreader/reader/cut_flow.h"
+
+#include <string>
+#include <vector>
+
+TEST(CutFlow, Check) {
+  jetreader::CutFlow flow({"a", "b"});
+  EXPECT_FALSE(flow.active());
+
+  // nothing is counted while inactive
+  EXPECT_TRUE(flow.check(0, [] { return true; }));
+  flow.count(true);
+  EXPECT_EQ(flow.cuts()[0].tested, 0);
+  EXPECT_EQ(flow.tested(), 0);
+
+  flow.setActive(true);
+  for (int i = 0; i < 10; ++i) {
+    bool pass = flow.check(0, [&] { return i < 6; }) &&
+                flow.check(1, [&] { return i % 2 == 0; });
+    flow.count(pass);
+  }
+  EXPECT_EQ(flow.cuts()[0].tested, 10);
+  EXPECT_EQ(flow.cuts()[0].passed, 6);
+  EXPECT_EQ(flow.cuts()[1].tested, 6);
+  EXPECT_EQ(flow.cuts()[1].passed, 3);
+  EXPECT_EQ(flow.tested(), 10);
+  EXPECT_EQ(flow.accepted(), 3);
+  EXPECT_EQ(flow.cuts()[0].nanoseconds, 0);
+
+  flow.reset();
+  EXPECT_EQ(flow.cuts()[0].tested, 0);
+  EXPECT_EQ(flow.accepted(), 0);
+}
+
+TEST(CutFlow, CheckBatch) {
+  jetreader::CutFlow flow({"a"});
+  flow.setActive(true, true);
+  EXPECT_TRUE(flow.timing());
+
+  std::vector<uint8_t> mask{1, 1, 0, 1, 1};
+  flow.checkBatch(0, mask.data(), mask.size(), [&] {
+    mask[0] = 0;
+    mask[2] = 0;
+  });
+  EXPECT_EQ(flow.cuts()[0].tested, 4);
+  EXPECT_EQ(flow.cuts()[0].passed, 3);
+}
+
+TEST(CutFlow, Pause) {
+  jetreader::CutFlow flow({"a"});
+  flow.setActive(true);
+  {
+    jetreader::CutFlow::Pause pause(flow);
+    EXPECT_FALSE(flow.active());
+    flow.check(0, [] { return true; });
+  }
+  EXPECT_TRUE(flow.active());
+  {
+    jetreader::CutFlow::Pause pause(flow, false);
+    flow.check(0, [] { return true; });
+  }
+  EXPECT_EQ(flow.cuts()[0].tested, 1);
+}
+
+TEST(CutFlow, RecordAndMerge) {
+  jetreader::CutFlow flow({"a", "b"});
+  flow.setActive(true);
+  EXPECT_EQ(flow.index("b"), 1);
+  EXPECT_THROW(flow.index("c"), jetreader::AssertionFailure);
+
+  flow.record(flow.index("a"), 5, 0);
+  flow.count(5, 0);
+
+  jetreader::CutFlow other({"a", "b"});
+  other.setActive(true);
+  other.record(0, 3, 2);
+  other.record(1, 2, 1);
+  other.count(3, 1);
+
+  flow.merge(other);
+  EXPECT_EQ(flow.cuts()[0].tested, 8);
+  EXPECT_EQ(flow.cuts()[0].passed, 2);
+  EXPECT_EQ(flow.cuts()[1].tested, 2);
+  EXPECT_EQ(flow.tested(), 8);
+  EXPECT_EQ(flow.accepted(), 1);
+
+  jetreader::CutFlow different({"b", "a"});
+  EXPECT_THROW(flow.merge(different), jetreader::AssertionFailure);
+
+  std::string table = flow.table();
+  EXPECT_NE(table.find("a"), std::string::npos);
+  EXPECT_NE(table.find("total"), std::string::npos);
+}
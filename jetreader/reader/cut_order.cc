@@ -0,0 +1,51 @@
+#include "jetreader/reader/cut_order.h"
+
+#include "jetreader/lib/assert.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace jetreader {
+
+CutOrder::CutOrder(unsigned n)
+    : adaptive_(false), warmup_(0), objects_(0), order_(n),
+      measurements_(n) {
+  reset();
+}
+
+void CutOrder::setAdaptive(bool flag, uint64_t warmup) {
+  JETREADER_ASSERT(!flag || warmup > 0,
+                   "adaptive cut order needs at least one warmup object");
+  adaptive_ = flag;
+  warmup_ = warmup;
+  reset();
+}
+
+void CutOrder::next() {
+  if (++objects_ == warmup_)
+    reorder();
+}
+
+void CutOrder::reset() {
+  objects_ = 0;
+  for (unsigned i = 0; i < order_.size(); ++i)
+    order_[i] = i;
+  for (auto &measurement : measurements_)
+    measurement = Measurement{0, 0, 0};
+}
+
+void CutOrder::reorder() {
+  // expected cost of the cut per object it rejects
+  std::vector<double> cost(measurements_.size());
+  for (size_t i = 0; i < measurements_.size(); ++i) {
+    const Measurement &measurement = measurements_[i];
+    if (measurement.rejected == 0)
+      cost[i] = std::numeric_limits<double>::infinity();
+    else
+      cost[i] = (double)measurement.nanoseconds / measurement.rejected;
+  }
+  std::stable_sort(order_.begin(), order_.end(),
+                   [&](unsigned a, unsigned b) { return cost[a] < cost[b]; });
+}
+
+} // namespace jetreader
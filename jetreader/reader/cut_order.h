@@ -0,0 +1,79 @@
+#ifndef JETREADER_READER_CUT_ORDER_H
+#define JETREADER_READER_CUT_ORDER_H
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace jetreader {
+
+// the order in which a selector applies its cuts. By default, cuts are applied
+// in a fixed order. In adaptive mode, the first warmup objects are tested by
+// every active cut, measuring the fraction of objects each cut rejects and its
+// average cost. After the warmup, the cuts are sorted to minimize the expected
+// cost per object of a chain that stops at the first failed cut: by increasing
+// cost divided by rejection rate. Cuts that rejected nothing during the warmup
+// are applied last, in their default order.
+//
+// Only the order changes: an object is accepted if it passes every cut,
+// whatever the order.
+class CutOrder {
+public:
+  // n cuts, applied in the order 0, 1, ..., n - 1 until the warmup is over
+  explicit CutOrder(unsigned n);
+
+  // turns adaptive ordering on or off, and restarts the warmup
+  void setAdaptive(bool flag, uint64_t warmup = 1000);
+  bool adaptive() const { return adaptive_; }
+  uint64_t warmup() const { return warmup_; }
+
+  // true while objects are still being measured
+  bool warmingUp() const { return adaptive_ && objects_ < warmup_; }
+
+  // the cuts in the order they are applied
+  const std::vector<unsigned> &order() const { return order_; }
+
+  // evaluates cut f() during the warmup, and records its result and cost
+  template <class F> bool measure(unsigned cut, F &&f);
+
+  // ends the warmup measurement of one object. Once warmup objects have been
+  // measured, the cuts are reordered
+  void next();
+
+  // restores the default order, and restarts the warmup if adaptive
+  void reset();
+
+private:
+  typedef std::chrono::steady_clock Clock;
+
+  struct Measurement {
+    uint64_t tested;
+    uint64_t rejected;
+    uint64_t nanoseconds;
+  };
+
+  void reorder();
+
+  bool adaptive_;
+  uint64_t warmup_;
+  uint64_t objects_;
+  std::vector<unsigned> order_;
+  std::vector<Measurement> measurements_;
+};
+
+template <class F> bool CutOrder::measure(unsigned cut, F &&f) {
+  Clock::time_point start = Clock::now();
+  bool pass = f();
+  Measurement &measurement = measurements_[cut];
+  measurement.nanoseconds +=
+      std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() -
+                                                           start)
+          .count();
+  ++measurement.tested;
+  measurement.rejected += !pass;
+  return pass;
+}
+
+} // namespace jetreader
+
+#endif // JETREADER_READER_CUT_ORDER_H
@@ -0,0 +1,42 @@
+#include "gtest/gtest.h"
+
+#include "jetreader/lib/assert.h"
+#include "jetreader/reader/cut_order.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+TEST(CutOrder, DefaultOrder) {
+  jetreader::CutOrder order(4);
+  EXPECT_FALSE(order.adaptive());
+  EXPECT_FALSE(order.warmingUp());
+  EXPECT_EQ(order.order(), (std::vector<unsigned>{0, 1, 2, 3}));
+
+  EXPECT_THROW(order.setAdaptive(true, 0), jetreader::AssertionFailure);
+}
+
+TEST(CutOrder, Reorder) {
+  jetreader::CutOrder order(4);
+  order.setAdaptive(true, 10);
+
+  // cut 0 is slow and rejects everything, cut 1 is fast and rejects half of
+  // all objects, cut 2 rejects nothing and cut 3 is never tested
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_TRUE(order.warmingUp());
+    order.measure(0, [] {
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+      return false;
+    });
+    order.measure(1, [&] { return i % 2 == 0; });
+    order.measure(2, [] { return true; });
+    order.next();
+  }
+  EXPECT_FALSE(order.warmingUp());
+  EXPECT_EQ(order.order(), (std::vector<unsigned>{1, 0, 2, 3}));
+
+  // restarting the warmup restores the default order
+  order.setAdaptive(true, 5);
+  EXPECT_TRUE(order.warmingUp());
+  EXPECT_EQ(order.order(), (std::vector<unsigned>{0, 1, 2, 3}));
+}
@@ -0,0 +1,220 @@
+#include "jetreader/reader/event_header_cache.h"
+
+#include <algorithm>
+#include <fstream>
+
+#include <sys/stat.h>
+
+namespace jetreader {
+
+namespace {
+
+const uint32_t HEADER_CACHE_MAGIC = 0x4a524843; // "JRHC"
+const uint32_t HEADER_CACHE_VERSION = 3;
+
+template <typename T>
+void WriteColumn(std::ofstream &out, const std::vector<T> &column) {
+  uint64_t size = column.size();
+  out.write(reinterpret_cast<const char *>(&size), sizeof(size));
+  out.write(reinterpret_cast<const char *>(column.data()),
+            sizeof(T) * column.size());
+}
+
+template <typename T>
+bool ReadColumn(std::ifstream &in, std::vector<T> &column,
+                uint64_t expected_size) {
+  uint64_t size = 0;
+  if (!in.read(reinterpret_cast<char *>(&size), sizeof(size)) ||
+      size != expected_size)
+    return false;
+  column.resize(size);
+  return bool(in.read(reinterpret_cast<char *>(column.data()),
+                      sizeof(T) * column.size()));
+}
+
+// 64-bit FNV-1a
+void HashBytes(uint64_t &hash, const void *data, size_t size) {
+  const unsigned char *bytes = static_cast<const unsigned char *>(data);
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= bytes[i];
+    hash *= 0x100000001b3ull;
+  }
+}
+
+} // namespace
+
+bool FileFingerprint::Make(const std::string &filename, int64_t entries,
+                           FileFingerprint &fingerprint) {
+  struct stat file_stat;
+  if (stat(filename.c_str(), &file_stat) != 0)
+    return false;
+  fingerprint.size = file_stat.st_size;
+  fingerprint.mtime = file_stat.st_mtime;
+  fingerprint.entries = entries;
+  return true;
+}
+
+FileFingerprint
+FileFingerprint::Combine(const std::vector<std::string> &filenames,
+                         const std::vector<FileFingerprint> &members,
+                         int64_t entries) {
+  FileFingerprint fingerprint;
+  fingerprint.entries = entries;
+  fingerprint.members = 0xcbf29ce484222325ull;
+  for (size_t i = 0; i < filenames.size() && i < members.size(); ++i) {
+    fingerprint.size += members[i].size;
+    fingerprint.mtime = std::max(fingerprint.mtime, members[i].mtime);
+    // the terminating null separates consecutive names
+    HashBytes(fingerprint.members, filenames[i].c_str(),
+              filenames[i].size() + 1);
+    HashBytes(fingerprint.members, &members[i].size, sizeof(members[i].size));
+    HashBytes(fingerprint.members, &members[i].mtime,
+              sizeof(members[i].mtime));
+  }
+  return fingerprint;
+}
+
+EventHeaderCache::EventHeaderCache() : trigger_offsets_(1, 0) {}
+
+void EventHeaderCache::add(const StPicoEvent &event) {
+  TVector3 vertex = event.primaryVertex();
+  run_id_.push_back(event.runId());
+  event_id_.push_back(event.eventId());
+  vx_.push_back(vertex.X());
+  vy_.push_back(vertex.Y());
+  vz_.push_back(vertex.Z());
+  vz_vpd_.push_back(event.vzVpd());
+  refmult_.push_back(event.refMult());
+  refmult2_.push_back(event.refMult2());
+  refmult3_.push_back(event.refMult3());
+  refmult4_.push_back(event.refMult4());
+  grefmult_.push_back(event.grefMult());
+  zdcx_.push_back(event.ZDCx());
+  bbcx_.push_back(event.BBCx());
+  bfield_.push_back(event.bField());
+  for (auto id : event.triggerIds())
+    trigger_ids_.push_back(id);
+  trigger_offsets_.push_back(trigger_ids_.size());
+}
+
+void EventHeaderCache::fill(int64_t entry, StPicoEvent &event) const {
+  event.setRunId(run_id_[entry]);
+  event.setEventId(event_id_[entry]);
+  event.setPrimaryVertexPosition(vx_[entry], vy_[entry], vz_[entry]);
+  event.setVzVpd(vz_vpd_[entry]);
+
+  // only the sums of the refmult components are cached
+  event.setRefMultPos(refmult_[entry]);
+  event.setRefMultNeg(0);
+  event.setRefMult2PosEast(refmult2_[entry]);
+  event.setRefMult2NegEast(0);
+  event.setRefMult2PosWest(0);
+  event.setRefMult2NegWest(0);
+  event.setRefMult3PosEast(refmult3_[entry]);
+  event.setRefMult3NegEast(0);
+  event.setRefMult3PosWest(0);
+  event.setRefMult3NegWest(0);
+  event.setRefMult4PosEast(refmult4_[entry]);
+  event.setRefMult4NegEast(0);
+  event.setRefMult4PosWest(0);
+  event.setRefMult4NegWest(0);
+  event.setGRefMult(grefmult_[entry]);
+  event.setZDCx(zdcx_[entry]);
+  event.setBBCx(bbcx_[entry]);
+  event.setBField(bfield_[entry]);
+
+  event.setTriggerIds(
+      std::vector<unsigned int>(trigger_ids_.begin() + trigger_offsets_[entry],
+                                trigger_ids_.begin() +
+                                    trigger_offsets_[entry + 1]));
+}
+
+void EventHeaderCache::clear() {
+  run_id_.clear();
+  event_id_.clear();
+  vx_.clear();
+  vy_.clear();
+  vz_.clear();
+  vz_vpd_.clear();
+  refmult_.clear();
+  refmult2_.clear();
+  refmult3_.clear();
+  refmult4_.clear();
+  grefmult_.clear();
+  zdcx_.clear();
+  bbcx_.clear();
+  bfield_.clear();
+  trigger_offsets_.assign(1, 0);
+  trigger_ids_.clear();
+}
+
+bool EventHeaderCache::save(const std::string &filename,
+                            const FileFingerprint &fingerprint) const {
+  std::ofstream out(filename, std::ios::binary);
+  if (!out.good())
+    return false;
+
+  out.write(reinterpret_cast<const char *>(&HEADER_CACHE_MAGIC),
+            sizeof(HEADER_CACHE_MAGIC));
+  out.write(reinterpret_cast<const char *>(&HEADER_CACHE_VERSION),
+            sizeof(HEADER_CACHE_VERSION));
+  out.write(reinterpret_cast<const char *>(&fingerprint), sizeof(fingerprint));
+
+  WriteColumn(out, run_id_);
+  WriteColumn(out, event_id_);
+  WriteColumn(out, vx_);
+  WriteColumn(out, vy_);
+  WriteColumn(out, vz_);
+  WriteColumn(out, vz_vpd_);
+  WriteColumn(out, refmult_);
+  WriteColumn(out, refmult2_);
+  WriteColumn(out, refmult3_);
+  WriteColumn(out, refmult4_);
+  WriteColumn(out, grefmult_);
+  WriteColumn(out, zdcx_);
+  WriteColumn(out, bbcx_);
+  WriteColumn(out, bfield_);
+  WriteColumn(out, trigger_offsets_);
+  WriteColumn(out, trigger_ids_);
+  return out.good();
+}
+
+bool EventHeaderCache::load(const std::string &filename,
+                            const FileFingerprint &fingerprint) {
+  clear();
+  std::ifstream in(filename, std::ios::binary);
+  if (!in.good())
+    return false;
+
+  uint32_t magic = 0;
+  uint32_t version = 0;
+  FileFingerprint cached_fingerprint;
+  in.read(reinterpret_cast<char *>(&magic), sizeof(magic));
+  in.read(reinterpret_cast<char *>(&version), sizeof(version));
+  in.read(reinterpret_cast<char *>(&cached_fingerprint),
+          sizeof(cached_fingerprint));
+  if (!in || magic != HEADER_CACHE_MAGIC ||
+      version != HEADER_CACHE_VERSION || !(cached_fingerprint == fingerprint))
+    return false;
+
+  uint64_t n = fingerprint.entries;
+  bool success =
+      ReadColumn(in, run_id_, n) && ReadColumn(in, event_id_, n) &&
+      ReadColumn(in, vx_, n) && ReadColumn(in, vy_, n) &&
+      ReadColumn(in, vz_, n) && ReadColumn(in, vz_vpd_, n) &&
+      ReadColumn(in, refmult_, n) && ReadColumn(in, refmult2_, n) &&
+      ReadColumn(in, refmult3_, n) && ReadColumn(in, refmult4_, n) &&
+      ReadColumn(in, grefmult_, n) && ReadColumn(in, zdcx_, n) &&
+      ReadColumn(in, bbcx_, n) && ReadColumn(in, bfield_, n) &&
+      ReadColumn(in, trigger_offsets_, n + 1);
+
+  // the number of trigger IDs is only known from the offsets
+  success = success && trigger_offsets_.front() == 0 &&
+            std::is_sorted(trigger_offsets_.begin(), trigger_offsets_.end()) &&
+            ReadColumn(in, trigger_ids_, trigger_offsets_.back());
+  if (!success)
+    clear();
+  return success;
+}
+
+} // namespace jetreader
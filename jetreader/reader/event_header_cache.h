@@ -0,0 +1,121 @@
+#ifndef JETREADER_READER_EVENT_HEADER_CACHE_H
+#define JETREADER_READER_EVENT_HEADER_CACHE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "StPicoEvent/StPicoEvent.h"
+
+namespace jetreader {
+
+// identifies the input a cache was built from. The file's size and
+// modification time are used instead of a checksum of its contents, which
+// would require reading the full input
+struct FileFingerprint {
+  uint64_t size = 0;
+  int64_t mtime = 0;
+  int64_t entries = 0;
+  // for a file list, a hash of the names, sizes and modification times of its
+  // member files. Zero for a single file
+  uint64_t members = 0;
+
+  bool operator==(const FileFingerprint &rhs) const {
+    return size == rhs.size && mtime == rhs.mtime && entries == rhs.entries &&
+           members == rhs.members;
+  }
+
+  // fingerprint of filename, for a chain with the given number of entries.
+  // Returns false if the file can not be found
+  static bool Make(const std::string &filename, int64_t entries,
+                   FileFingerprint &fingerprint);
+
+  // fingerprint of a file list, from the fingerprints of its member files in
+  // chain order, for a chain with the given number of entries. A member that
+  // is rewritten, replaced or moved changes the fingerprint, even if the list
+  // itself does not change
+  static FileFingerprint Combine(const std::vector<std::string> &filenames,
+                                 const std::vector<FileFingerprint> &members,
+                                 int64_t entries);
+};
+
+// a compact, columnar copy of the event header quantities used by the
+// EventSelector - run and event ID, vertex position, VPD vz, the refmult
+// variants, ZDC and BBC coincidence rates, magnetic field and trigger IDs - for
+// every entry in a chain. Used by the
+// Reader to evaluate event cuts before reading an entry from the chain.
+//
+// The cache can be saved to and loaded from a binary file, so that it only has
+// to be built once for a given input.
+class EventHeaderCache {
+public:
+  EventHeaderCache();
+
+  // appends the header of the next entry in the chain. Entries must be added
+  // in order, starting from zero
+  void add(const StPicoEvent &event);
+
+  // sets the cached quantities of entry on event. Quantities that are not
+  // cached are left untouched, so event should only be used for event
+  // selection
+  void fill(int64_t entry, StPicoEvent &event) const;
+
+  int64_t entries() const { return run_id_.size(); }
+
+  void clear();
+
+  // writes the cache to filename, along with the fingerprint of its input.
+  // Returns false if the file can not be written
+  bool save(const std::string &filename,
+            const FileFingerprint &fingerprint) const;
+
+  // reads a cache written by save(). If the file can't be read, or was built
+  // from an input that does not match fingerprint, returns false and the cache
+  // is left empty
+  bool load(const std::string &filename, const FileFingerprint &fingerprint);
+
+  // direct access to the columns
+  const std::vector<unsigned> &runId() const { return run_id_; }
+  const std::vector<int> &eventId() const { return event_id_; }
+  const std::vector<float> &vx() const { return vx_; }
+  const std::vector<float> &vy() const { return vy_; }
+  const std::vector<float> &vz() const { return vz_; }
+  const std::vector<float> &vzVpd() const { return vz_vpd_; }
+  const std::vector<uint16_t> &refMult() const { return refmult_; }
+  const std::vector<uint16_t> &refMult2() const { return refmult2_; }
+  const std::vector<uint16_t> &refMult3() const { return refmult3_; }
+  const std::vector<uint16_t> &refMult4() const { return refmult4_; }
+  const std::vector<uint16_t> &gRefMult() const { return grefmult_; }
+  const std::vector<float> &zdcx() const { return zdcx_; }
+  const std::vector<float> &bbcx() const { return bbcx_; }
+  const std::vector<float> &bField() const { return bfield_; }
+
+  // trigger IDs of entry i are trigger_ids[trigger_offsets[i]] up to
+  // trigger_ids[trigger_offsets[i+1]]
+  const std::vector<uint32_t> &triggerOffsets() const {
+    return trigger_offsets_;
+  }
+  const std::vector<unsigned> &triggerIds() const { return trigger_ids_; }
+
+private:
+  std::vector<unsigned> run_id_;
+  std::vector<int> event_id_;
+  std::vector<float> vx_;
+  std::vector<float> vy_;
+  std::vector<float> vz_;
+  std::vector<float> vz_vpd_;
+  std::vector<uint16_t> refmult_;
+  std::vector<uint16_t> refmult2_;
+  std::vector<uint16_t> refmult3_;
+  std::vector<uint16_t> refmult4_;
+  std::vector<uint16_t> grefmult_;
+  std::vector<float> zdcx_;
+  std::vector<float> bbcx_;
+  std::vector<float> bfield_;
+  std::vector<uint32_t> trigger_offsets_;
+  std::vector<unsigned> trigger_ids_;
+};
+
+} // namespace jetreader
+
+#endif // JETREADER_READER_EVENT_HEADER_CACHE_H
@@ -0,0 +1,120 @@
+#include "gtest/gtest.h"
+
+#include "jetreader/reader/event_header_cache.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "StPicoEvent/StPicoEvent.h"
+
+jetreader::EventHeaderCache MakeHeaderCache() {
+  jetreader::EventHeaderCache cache;
+  for (int i = 0; i < 10; ++i) {
+    StPicoEvent event;
+    event.setRunId(15095020 + i / 4);
+    event.setEventId(100 + i);
+    event.setPrimaryVertexPosition(0.1 * i, -0.1 * i, 2.0 * i - 10.0);
+    event.setVzVpd(2.0 * i - 9.0);
+    event.setRefMultPos(10 * i);
+    event.setRefMultNeg(5 * i);
+    event.setGRefMult(20 * i);
+    event.setZDCx(1000.0 * i);
+    event.setBBCx(500.0 * i);
+    event.setBField(i % 2 ? 4.98 : -4.98);
+    std::vector<unsigned int> triggers;
+    for (int j = 0; j < i % 3; ++j)
+      triggers.push_back(450000 + j);
+    event.setTriggerIds(triggers);
+    cache.add(event);
+  }
+  return cache;
+}
+
+void ExpectHeaderCacheEntry(const jetreader::EventHeaderCache &cache, int i) {
+  StPicoEvent event;
+  cache.fill(i, event);
+  EXPECT_EQ(event.runId(), 15095020 + i / 4);
+  EXPECT_EQ(event.eventId(), 100 + i);
+  EXPECT_NEAR(event.primaryVertex().X(), 0.1 * i, 1e-5);
+  EXPECT_NEAR(event.primaryVertex().Y(), -0.1 * i, 1e-5);
+  EXPECT_NEAR(event.primaryVertex().Z(), 2.0 * i - 10.0, 1e-5);
+  EXPECT_NEAR(event.vzVpd(), 2.0 * i - 9.0, 1e-5);
+  EXPECT_EQ(event.refMult(), 15 * i);
+  EXPECT_EQ(event.grefMult(), 20 * i);
+  EXPECT_NEAR(event.ZDCx(), 1000.0 * i, 1e-2);
+  EXPECT_NEAR(event.BBCx(), 500.0 * i, 1e-2);
+  EXPECT_NEAR(event.bField(), i % 2 ? 4.98 : -4.98, 1e-5);
+  EXPECT_EQ(event.triggerIds().size(), i % 3);
+  for (int j = 0; j < i % 3; ++j)
+    EXPECT_TRUE(event.isTrigger(450000 + j));
+}
+
+TEST(EventHeaderCache, Fill) {
+  jetreader::EventHeaderCache cache = MakeHeaderCache();
+  EXPECT_EQ(cache.entries(), 10);
+  for (int i = 0; i < 10; ++i)
+    ExpectHeaderCacheEntry(cache, i);
+}
+
+TEST(EventHeaderCache, SaveAndLoad) {
+  std::string filename = "event_header_cache_test_tmp.hdrcache";
+  jetreader::FileFingerprint fingerprint;
+  fingerprint.size = 12345;
+  fingerprint.mtime = 1500000000;
+  fingerprint.entries = 10;
+
+  jetreader::EventHeaderCache cache = MakeHeaderCache();
+  ASSERT_TRUE(cache.save(filename, fingerprint));
+
+  jetreader::EventHeaderCache loaded;
+  ASSERT_TRUE(loaded.load(filename, fingerprint));
+  EXPECT_EQ(loaded.entries(), 10);
+  for (int i = 0; i < 10; ++i)
+    ExpectHeaderCacheEntry(loaded, i);
+
+  // a cache built from a different input is not used
+  jetreader::FileFingerprint modified = fingerprint;
+  modified.mtime += 1;
+  EXPECT_FALSE(loaded.load(filename, modified));
+  EXPECT_EQ(loaded.entries(), 0);
+
+  EXPECT_FALSE(loaded.load("event_header_cache_test_missing.hdrcache",
+                           fingerprint));
+
+  remove(filename.c_str());
+}
+
+TEST(FileFingerprint, Combine) {
+  std::vector<std::string> files{"a.picoDst.root", "b.picoDst.root"};
+  std::vector<jetreader::FileFingerprint> members(2);
+  members[0].size = 1000;
+  members[0].mtime = 1500000000;
+  members[1].size = 2000;
+  members[1].mtime = 1500000100;
+
+  auto fingerprint = jetreader::FileFingerprint::Combine(files, members, 50);
+  EXPECT_EQ(fingerprint.size, 3000);
+  EXPECT_EQ(fingerprint.mtime, 1500000100);
+  EXPECT_EQ(fingerprint.entries, 50);
+  EXPECT_TRUE(fingerprint ==
+              jetreader::FileFingerprint::Combine(files, members, 50));
+
+  // a rewritten member changes the fingerprint, even if it is older than the
+  // newest member and has the same size
+  auto modified = members;
+  modified[0].mtime += 1;
+  EXPECT_FALSE(fingerprint ==
+               jetreader::FileFingerprint::Combine(files, modified, 50));
+
+  // as does a renamed member, or a reordered list
+  auto renamed = files;
+  renamed[0] = "c.picoDst.root";
+  EXPECT_FALSE(fingerprint ==
+               jetreader::FileFingerprint::Combine(renamed, members, 50));
+  std::vector<std::string> reordered{files[1], files[0]};
+  std::vector<jetreader::FileFingerprint> reordered_members{members[1],
+                                                            members[0]};
+  EXPECT_FALSE(fingerprint == jetreader::FileFingerprint::Combine(
+                                  reordered, reordered_members, 50));
+}
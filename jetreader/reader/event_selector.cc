@@ -8,19 +8,120 @@
 
 namespace jetreader {
 
-EventSelector::EventSelector() { clear(); }
+namespace {
+
+// indices into EventSelector::cutNames()
+enum EventCut : unsigned {
+  badRunCut,
+  vxCut,
+  vyCut,
+  vzCut,
+  dVzCut,
+  vrCut,
+  refMultCut,
+  triggerIdCut,
+  expressionsCut
+};
+
+} // namespace
+
+const std::vector<std::string> &EventSelector::cutNames() {
+  static const std::vector<std::string> names{
+      "badRuns", "vx",      "vy",        "vz",         "dVz",
+      "vr",      "refMult", "triggerId", "expressions"};
+  return names;
+}
+
+EventSelector::EventSelector()
+    : cut_flow_(cutNames()), cut_order_(cutNames().size()) {
+  clear();
+}
 
 EventStatus EventSelector::select(StPicoEvent *event) {
-  if (bad_run_ids_active_ && !checkRunId(event))
-    return EventStatus::rejectRun;
+  EventStatus status = EventStatus::acceptEvent;
+  if (bad_run_ids_active_ &&
+      !cut_flow_.check(badRunCut, [&] { return checkRunId(event); }))
+    status = EventStatus::rejectRun;
+  else if (!checkOrdered(event))
+    status = EventStatus::rejectEvent;
+
+  cut_flow_.count(status == EventStatus::acceptEvent);
+  return status;
+}
+
+bool EventSelector::checkOrdered(StPicoEvent *event) {
+  if (!cut_order_.warmingUp()) {
+    for (auto &cut : cut_order_.order())
+      if (cut != badRunCut && cutActive(cut) &&
+          !cut_flow_.check(cut, [&] { return checkCut(cut, event); }))
+        return false;
+    return true;
+  }
 
-  if ((vx_active_ && !checkVx(event)) || (vy_active_ && !checkVy(event)) ||
-      (vz_active_ && !checkVz(event)) || (dvz_active_ && !checkdVz(event)) ||
-      (vr_active_ && !checkVr(event)) ||
-      (refmult_active_ && !checkRefMult(event)) ||
-      (trigger_ids_active_ && !checkTriggerId(event)))
-    return EventStatus::rejectEvent;
-  return EventStatus::acceptEvent;
+  // during the warmup, every cut is evaluated to measure how often it rejects
+  // events. The cut flow only counts cuts up to the first failure, as usual
+  bool pass = true;
+  for (auto &cut : cut_order_.order()) {
+    if (cut == badRunCut || !cutActive(cut))
+      continue;
+    bool cut_pass =
+        cut_order_.measure(cut, [&] { return checkCut(cut, event); });
+    if (pass)
+      cut_flow_.record(cut, 1, cut_pass);
+    pass = pass && cut_pass;
+  }
+  cut_order_.next();
+  return pass;
+}
+
+bool EventSelector::cutActive(unsigned cut) const {
+  switch (cut) {
+  case badRunCut:
+    return bad_run_ids_active_;
+  case vxCut:
+    return vx_active_;
+  case vyCut:
+    return vy_active_;
+  case vzCut:
+    return vz_active_;
+  case dVzCut:
+    return dvz_active_;
+  case vrCut:
+    return vr_active_;
+  case refMultCut:
+    return refmult_active_;
+  case triggerIdCut:
+    return trigger_ids_active_;
+  default:
+    return !expressions_.empty();
+  }
+}
+
+bool EventSelector::checkCut(unsigned cut, StPicoEvent *event) {
+  switch (cut) {
+  case badRunCut:
+    return checkRunId(event);
+  case vxCut:
+    return checkVx(event);
+  case vyCut:
+    return checkVy(event);
+  case vzCut:
+    return checkVz(event);
+  case dVzCut:
+    return checkdVz(event);
+  case vrCut:
+    return checkVr(event);
+  case refMultCut:
+    return checkRefMult(event);
+  case triggerIdCut:
+    return checkTriggerId(event);
+  default:
+    return checkExpressions(event);
+  }
+}
+
+void EventSelector::useAdaptiveCutOrder(bool flag, unsigned warmup) {
+  cut_order_.setAdaptive(flag, warmup);
 }
 
 void EventSelector::setVxRange(double min, double max) {
@@ -96,6 +197,18 @@ void EventSelector::addBadRuns(std::string bad_run_file) {
   bad_run_id_files_.insert(bad_run_file);
 }
 
+const std::vector<std::string> &EventSelector::expressionFields() {
+  static const std::vector<std::string> fields{
+      "runId",    "eventId",  "vx",      "vy",       "vz",       "vr",
+      "vzVpd",    "dVz",      "refMult", "refMult2", "refMult3", "refMult4",
+      "gRefMult", "zdcX",     "bbcX",    "bField"};
+  return fields;
+}
+
+void EventSelector::addExpression(const std::string &expression) {
+  expressions_.emplace_back(expression, expressionFields());
+}
+
 void EventSelector::clear() {
   trigger_ids_active_ = false;
   bad_run_ids_active_ = false;
@@ -121,6 +234,11 @@ void EventSelector::clear() {
   refmult_type_ = MultType::refMult;
   refmult_min_ = 0;
   refmult_max_ = 0;
+
+  expressions_.clear();
+
+  // measurements of the previous cuts don't apply anymore
+  cut_order_.reset();
 }
 
 bool EventSelector::checkVx(StPicoEvent *event) {
@@ -185,4 +303,29 @@ bool EventSelector::checkRunId(StPicoEvent *event) {
   return bad_run_ids_.find(runid) == bad_run_ids_.end();
 }
 
-} // namespace jetreader
\ No newline at end of file
+bool EventSelector::checkExpressions(StPicoEvent *event) {
+  TVector3 vertex = event->primaryVertex();
+  // in the order of expressionFields()
+  double values[] = {(double)event->runId(),
+                     (double)event->eventId(),
+                     vertex.X(),
+                     vertex.Y(),
+                     vertex.Z(),
+                     sqrt(vertex.X() * vertex.X() + vertex.Y() * vertex.Y()),
+                     event->vzVpd(),
+                     fabs(event->vzVpd() - vertex.Z()),
+                     (double)event->refMult(),
+                     (double)event->refMult2(),
+                     (double)event->refMult3(),
+                     (double)event->refMult4(),
+                     (double)event->grefMult(),
+                     event->ZDCx(),
+                     event->BBCx(),
+                     event->bField()};
+  for (auto &expression : expressions_)
+    if (!expression.evaluate(values))
+      return false;
+  return true;
+}
+
+} // namespace jetreader
@@ -1,10 +1,15 @@
 #ifndef JETREADER_READER_EVENT_SELECTOR_H
 #define JETREADER_READER_EVENT_SELECTOR_H
 
+#include "jetreader/reader/cut_expression.h"
+#include "jetreader/reader/cut_flow.h"
+#include "jetreader/reader/cut_order.h"
+
 #include "StPicoEvent/StPicoEvent.h"
 
 #include <set>
 #include <string>
+#include <vector>
 
 namespace jetreader {
 
@@ -55,7 +60,41 @@ public:
   void addBadRuns(std::vector<unsigned> bad_runs);
   void addBadRuns(std::string bad_run_file);
 
-  // function to deactivate and reset all cuts
+  // the runs rejected by the selector
+  const std::set<unsigned> &badRuns() const { return bad_run_ids_; }
+
+  // adds a cut given as an expression over the fields in expressionFields(),
+  // for instance "abs(vz - vzVpd) < 3 && refMult > 10" (see CutExpression for
+  // the syntax). Events are rejected if the expression is zero. Throws an
+  // AssertionFailure if the expression is not valid
+  void addExpression(const std::string &expression);
+  const std::vector<CutExpression> &expressions() const {
+    return expressions_;
+  }
+
+  // the event fields that can be used in expressions
+  static const std::vector<std::string> &expressionFields();
+
+  // counts the events tested and passed by each cut, and by the selector as a
+  // whole (see CutFlow). Counting is off by default. Events skipped by the
+  // Reader in bad runs are counted by the "badRuns" cut
+  CutFlow &cutFlow() { return cut_flow_; }
+  const CutFlow &cutFlow() const { return cut_flow_; }
+
+  // names of the cuts in cutFlow(), in the order they are applied by default
+  static const std::vector<std::string> &cutNames();
+
+  // turns on adaptive cut ordering (see CutOrder): after measuring the first
+  // warmup events, the cuts are applied in the order that rejects events with
+  // the least work. The bad run cut is always applied first, since it rejects
+  // the whole run. Accepted events are the same in either mode
+  void useAdaptiveCutOrder(bool flag, unsigned warmup = 1000);
+  bool adaptiveCutOrder() const { return cut_order_.adaptive(); }
+
+  // the order in which the cuts are applied, as indices into cutNames()
+  const CutOrder &cutOrder() const { return cut_order_; }
+
+  // function to deactivate and reset all cuts. The cut flow counts are kept
   void clear();
 
 protected:
@@ -67,8 +106,16 @@ protected:
   bool checkRefMult(StPicoEvent *dst);
   bool checkTriggerId(StPicoEvent *dst);
   bool checkRunId(StPicoEvent *dst);
+  bool checkExpressions(StPicoEvent *dst);
 
 private:
+  // whether cut (an index into cutNames()) is active, and its result
+  bool cutActive(unsigned cut) const;
+  bool checkCut(unsigned cut, StPicoEvent *dst);
+
+  // applies all active cuts except the bad run cut in the order of cut_order_
+  bool checkOrdered(StPicoEvent *dst);
+
   bool trigger_ids_active_;
   bool bad_run_ids_active_;
   bool vx_active_;
@@ -96,6 +143,11 @@ private:
   MultType refmult_type_;
   unsigned refmult_min_;
   unsigned refmult_max_;
+
+  std::vector<CutExpression> expressions_;
+
+  CutFlow cut_flow_;
+  CutOrder cut_order_;
 };
 
 } // namespace jetreader
@@ -0,0 +1,151 @@
+#include "jetreader/reader/event_view.h"
+#include "jetreader/reader/vector_info.h"
+
+#include <cmath>
+
+namespace jetreader {
+
+void EventView::addTrack(const StPicoTrack &track, TVector3 vertex,
+                         bool primary_track) {
+  TVector3 mom = primary_track ? track.pMom() : track.gMom();
+  double pt = primary_track ? track.pPt() : track.gPt();
+  double eta = mom.Eta();
+  addKinematics(pt, eta, mom.Phi(), pt * cosh(eta));
+  addTrackInfo(track, track.gDCA(vertex).Mag(), primary_track,
+               track.bemcTowerIndex());
+}
+
+void EventView::addTrack(const StPicoTrack &track, const TrackTable &table,
+                         size_t idx, bool primary_track, int matched_tower) {
+  double pt = table.pt()[idx];
+  double eta = table.eta()[idx];
+  addKinematics(pt, eta, table.phi()[idx], pt * cosh(eta));
+  addTrackInfo(track, table.dca()[idx], primary_track, matched_tower);
+}
+
+void EventView::addTrackInfo(const StPicoTrack &track, double dca,
+                             bool primary_track, int matched_tower) {
+  type_.push_back(primary_track ? VectorType::primaryTrack
+                                : VectorType::globalTrack);
+  index_.push_back(track.id());
+  charge_.push_back(track.charge());
+  dca_.push_back(dca);
+  nhits_.push_back(track.nHitsFit());
+  nhits_poss_.push_back(track.nHitsPoss());
+  matched_tower_.push_back(matched_tower);
+  tower_adc_.push_back(0);
+  tower_raw_e_.push_back(0.0);
+  tower_raw_eta_.push_back(0.0);
+  matched_offsets_.push_back(matched_tracks_.size());
+}
+
+void EventView::addTower(const StPicoBTowHit &tower, unsigned tower_id,
+                         double eta, double phi, double eta_corr, double e_corr,
+                         const std::vector<unsigned> &matched_tracks) {
+  addKinematics(e_corr / cosh(eta_corr), eta_corr, phi, e_corr);
+  addTowerInfo(
+      tower, tower_id, eta,
+      Span<const unsigned>(matched_tracks.data(), matched_tracks.size()));
+}
+
+void EventView::addTower(const StPicoBTowHit &tower, unsigned tower_id,
+                         const TowerKinematics &kinematics, double e_corr,
+                         Span<const unsigned> matched_tracks) {
+  unsigned tow_idx = tower_id - 1;
+  addKinematics(e_corr / kinematics.coshEta(tow_idx),
+                kinematics.correctedEta(tow_idx), kinematics.phi(tow_idx),
+                e_corr);
+  addTowerInfo(tower, tower_id, kinematics.eta(tow_idx), matched_tracks);
+}
+
+void EventView::addTowerInfo(const StPicoBTowHit &tower, unsigned tower_id,
+                             double eta,
+                             Span<const unsigned> matched_tracks) {
+  type_.push_back(VectorType::tower);
+  index_.push_back(tower_id);
+  charge_.push_back(0);
+  dca_.push_back(0.0);
+  nhits_.push_back(0);
+  nhits_poss_.push_back(0);
+  matched_tower_.push_back(0);
+  tower_adc_.push_back(tower.adc());
+  tower_raw_e_.push_back(tower.energy());
+  tower_raw_eta_.push_back(eta);
+  matched_tracks_.insert(matched_tracks_.end(), matched_tracks.begin(),
+                         matched_tracks.end());
+  matched_offsets_.push_back(matched_tracks_.size());
+}
+
+void EventView::addKinematics(double pt, double eta, double phi, double e) {
+  if (phi < 0.0)
+    phi += 2.0 * M_PI;
+  pt_.push_back(pt);
+  eta_.push_back(eta);
+  phi_.push_back(phi);
+  e_.push_back(e);
+  m_.push_back(0.0);
+}
+
+void EventView::clear() {
+  pt_.clear();
+  eta_.clear();
+  phi_.clear();
+  e_.clear();
+  m_.clear();
+  type_.clear();
+  index_.clear();
+  charge_.clear();
+  dca_.clear();
+  nhits_.clear();
+  nhits_poss_.clear();
+  matched_tower_.clear();
+  tower_adc_.clear();
+  tower_raw_e_.clear();
+  tower_raw_eta_.clear();
+  matched_offsets_.assign(1, 0);
+  matched_tracks_.clear();
+}
+
+fastjet::PseudoJet EventView::pseudojet(size_t i, VectorInfoPool *pool) const {
+  fastjet::PseudoJet j;
+  std::vector<unsigned> matched;
+  convert(i, j, pool, matched);
+  return j;
+}
+
+void EventView::fillPseudoJets(std::vector<fastjet::PseudoJet> &pseudojets,
+                               VectorInfoPool *pool) const {
+  // the old PseudoJets are cleared first, so that their VectorInfos can be
+  // reused by the pool
+  pseudojets.clear();
+  pseudojets.resize(size());
+  std::vector<unsigned> matched;
+  for (size_t i = 0; i < size(); ++i)
+    convert(i, pseudojets[i], pool, matched);
+}
+
+void EventView::convert(size_t i, fastjet::PseudoJet &j, VectorInfoPool *pool,
+                        std::vector<unsigned> &matched) const {
+  j.reset_PtYPhiM(pt_[i], eta_[i], phi_[i], m_[i]);
+
+  VectorInfo *info = nullptr;
+  if (pool != nullptr) {
+    info = &pool->attach(j);
+  } else {
+    info = new VectorInfo;
+    j.set_user_info(info);
+  }
+
+  if (type_[i] == VectorType::tower) {
+    matched.assign(matched_tracks_.begin() + matched_offsets_[i],
+                   matched_tracks_.begin() + matched_offsets_[i + 1]);
+    info->setTower(index_[i], tower_adc_[i], tower_raw_eta_[i],
+                   tower_raw_e_[i], matched);
+  } else {
+    info->setTrack(index_[i], type_[i] == VectorType::primaryTrack,
+                   charge_[i], dca_[i], nhits_[i], nhits_poss_[i],
+                   matched_tower_[i]);
+  }
+}
+
+} // namespace jetreader
@@ -0,0 +1,132 @@
+#ifndef JETREADER_READER_EVENT_VIEW_H
+#define JETREADER_READER_EVENT_VIEW_H
+
+#include <cstdint>
+#include <vector>
+
+#include "jetreader/reader/tower_kinematics.h"
+#include "jetreader/reader/track_table.h"
+#include "jetreader/reader/vector_info_pool.h"
+
+#include "fastjet/PseudoJet.hh"
+
+#include "StPicoEvent/StPicoBTowHit.h"
+#include "StPicoEvent/StPicoTrack.h"
+
+#include "TVector3.h"
+
+namespace jetreader {
+
+enum class VectorType : uint8_t { primaryTrack, globalTrack, tower };
+
+// structure-of-arrays copy of the selected tracks and towers of an event: one
+// contiguous array per quantity, with entry i of every array describing the
+// same track or tower. It holds the same information as the PseudoJets and
+// their VectorInfo, and can be converted to PseudoJets on demand.
+//
+// Kinematics follow fastjet conventions: all vectors are massless, and phi is
+// in [0, 2pi). For towers, eta is the vertex-corrected eta.
+class EventView {
+public:
+  EventView() : matched_offsets_(1, 0) {}
+
+  // appends a selected track, with the same arguments as MakePseudoJet()
+  void addTrack(const StPicoTrack &track, TVector3 vertex, bool primary_track);
+
+  // same as above, with the kinematics and DCA taken from entry idx of a
+  // TrackTable filled with the same vertex and primary_track, after
+  // TrackTable::setKinematics(), and the matched tower given as for
+  // MakePseudoJet()
+  void addTrack(const StPicoTrack &track, const TrackTable &table, size_t idx,
+                bool primary_track, int matched_tower);
+
+  // appends a selected tower, with the same arguments as MakePseudoJet()
+  void addTower(const StPicoBTowHit &tower, unsigned tower_id, double eta,
+                double phi, double eta_corr, double e_corr,
+                const std::vector<unsigned> &matched_tracks);
+
+  // same as above, with eta, phi and the vertex corrected eta taken from
+  // kinematics, set for the vertex of the event
+  void addTower(const StPicoBTowHit &tower, unsigned tower_id,
+                const TowerKinematics &kinematics, double e_corr,
+                Span<const unsigned> matched_tracks);
+
+  void clear();
+  size_t size() const { return pt_.size(); }
+  bool empty() const { return pt_.empty(); }
+
+  // converts entry i to a PseudoJet, with a VectorInfo attached. If pool is
+  // given, the VectorInfo is taken from it
+  fastjet::PseudoJet pseudojet(size_t i, VectorInfoPool *pool = nullptr) const;
+
+  // converts all entries, replacing the contents of pseudojets
+  void fillPseudoJets(std::vector<fastjet::PseudoJet> &pseudojets,
+                      VectorInfoPool *pool = nullptr) const;
+
+  // kinematics
+  const std::vector<double> &pt() const { return pt_; }
+  const std::vector<double> &eta() const { return eta_; }
+  const std::vector<double> &phi() const { return phi_; }
+  const std::vector<double> &e() const { return e_; }
+  const std::vector<double> &m() const { return m_; }
+
+  // origin of each entry: type, and StPicoTrack::id() for tracks or tower ID
+  // for towers
+  const std::vector<VectorType> &type() const { return type_; }
+  const std::vector<unsigned> &index() const { return index_; }
+
+  // track quantities - zero for towers
+  const std::vector<int> &charge() const { return charge_; }
+  const std::vector<double> &dca() const { return dca_; }
+  const std::vector<unsigned> &nhits() const { return nhits_; }
+  const std::vector<unsigned> &nhitsPoss() const { return nhits_poss_; }
+  const std::vector<int> &matchedTower() const { return matched_tower_; }
+
+  // tower quantities - zero for tracks
+  const std::vector<unsigned> &towerAdc() const { return tower_adc_; }
+  const std::vector<double> &towerRawE() const { return tower_raw_e_; }
+  const std::vector<double> &towerRawEta() const { return tower_raw_eta_; }
+
+  // indices of the tracks matched to entry i (see VectorInfo::matchedTracks())
+  // are matched_tracks[matched_offsets[i]] up to
+  // matched_tracks[matched_offsets[i+1]]
+  const std::vector<unsigned> &matchedOffsets() const {
+    return matched_offsets_;
+  }
+  const std::vector<unsigned> &matchedTracks() const {
+    return matched_tracks_;
+  }
+
+private:
+  void addKinematics(double pt, double eta, double phi, double e);
+  void addTowerInfo(const StPicoBTowHit &tower, unsigned tower_id, double eta,
+                    Span<const unsigned> matched_tracks);
+  void addTrackInfo(const StPicoTrack &track, double dca, bool primary_track,
+                    int matched_tower);
+
+  // converts entry i into j. matched is scratch space for the matched tracks
+  void convert(size_t i, fastjet::PseudoJet &j, VectorInfoPool *pool,
+               std::vector<unsigned> &matched) const;
+
+  std::vector<double> pt_;
+  std::vector<double> eta_;
+  std::vector<double> phi_;
+  std::vector<double> e_;
+  std::vector<double> m_;
+  std::vector<VectorType> type_;
+  std::vector<unsigned> index_;
+  std::vector<int> charge_;
+  std::vector<double> dca_;
+  std::vector<unsigned> nhits_;
+  std::vector<unsigned> nhits_poss_;
+  std::vector<int> matched_tower_;
+  std::vector<unsigned> tower_adc_;
+  std::vector<double> tower_raw_e_;
+  std::vector<double> tower_raw_eta_;
+  std::vector<unsigned> matched_offsets_;
+  std::vector<unsigned> matched_tracks_;
+};
+
+} // namespace jetreader
+
+#endif // JETREADER_READER_EVENT_VIEW_H
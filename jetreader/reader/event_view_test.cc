@@ -0,0 +1,122 @@
+#include "gtest/gtest.h"
+
+#include "jetreader/reader/bemc_helper.h"
+#include "jetreader/reader/event_view.h"
+#include "jetreader/reader/reader_utils.h"
+#include "jetreader/reader/track_table.h"
+#include "jetreader/reader/vector_info.h"
+
+#include <vector>
+
+#include "fastjet/PseudoJet.hh"
+
+#include "StPicoEvent/StPicoBTowHit.h"
+#include "StPicoEvent/StPicoTrack.h"
+
+#include "TVector3.h"
+
+TEST(EventView, MatchesPseudoJets) {
+  TVector3 vertex(0.1, -0.2, 5.0);
+
+  StPicoTrack track;
+  track.setId(7);
+  track.setPrimaryMomentum(TVector3(-2, 1, 2));
+  track.setGlobalMomentum(TVector3(-2.1, 1.1, 2.1));
+  track.setOrigin(TVector3(0.5, 0.5, 5.0));
+  track.setNHitsFit(25);
+  track.setNHitsPossible(40);
+
+  jetreader::BemcHelper helper;
+  StPicoBTowHit tower;
+  tower.setAdc(40);
+  tower.setEnergy(3.5);
+  unsigned tower_id = 1234;
+  double eta = helper.towerEta(tower_id);
+  double phi = helper.towerPhi(tower_id);
+  double eta_corr = helper.vertexCorrectedEta(tower_id, vertex.Z());
+  std::vector<unsigned> matched{3, 11};
+
+  std::vector<fastjet::PseudoJet> expected;
+  expected.push_back(jetreader::MakePseudoJet(track, vertex, true));
+  expected.push_back(jetreader::MakePseudoJet(track, vertex, false));
+  expected.push_back(jetreader::MakePseudoJet(tower, tower_id, eta, phi,
+                                              eta_corr, 3.0, matched));
+
+  jetreader::EventView view;
+  view.addTrack(track, vertex, true);
+  view.addTrack(track, vertex, false);
+  view.addTower(tower, tower_id, eta, phi, eta_corr, 3.0, matched);
+  ASSERT_EQ(view.size(), 3);
+
+  EXPECT_EQ(view.type()[0], jetreader::VectorType::primaryTrack);
+  EXPECT_EQ(view.type()[1], jetreader::VectorType::globalTrack);
+  EXPECT_EQ(view.type()[2], jetreader::VectorType::tower);
+  EXPECT_EQ(view.matchedOffsets()[2], 0);
+  EXPECT_EQ(view.matchedOffsets()[3], 2);
+
+  std::vector<fastjet::PseudoJet> converted;
+  jetreader::VectorInfoPool pool;
+  view.fillPseudoJets(converted, &pool);
+  ASSERT_EQ(converted.size(), 3);
+
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_NEAR(view.pt()[i], expected[i].pt(), 1e-5);
+    EXPECT_NEAR(view.eta()[i], expected[i].eta(), 1e-5);
+    EXPECT_NEAR(view.phi()[i], expected[i].phi(), 1e-5);
+    EXPECT_NEAR(view.e()[i], expected[i].E(), 1e-5);
+
+    EXPECT_NEAR(converted[i].pt(), expected[i].pt(), 1e-5);
+    EXPECT_NEAR(converted[i].eta(), expected[i].eta(), 1e-5);
+    EXPECT_NEAR(converted[i].phi(), expected[i].phi(), 1e-5);
+
+    auto &info = converted[i].user_info<jetreader::VectorInfo>();
+    auto &expected_info = expected[i].user_info<jetreader::VectorInfo>();
+    EXPECT_EQ(info.isPrimary(), expected_info.isPrimary());
+    EXPECT_EQ(info.isGlobal(), expected_info.isGlobal());
+    EXPECT_EQ(info.isBemcTower(), expected_info.isBemcTower());
+    EXPECT_EQ(info.trackId(), expected_info.trackId());
+    EXPECT_EQ(info.charge(), expected_info.charge());
+    EXPECT_NEAR(info.dca(), expected_info.dca(), 1e-5);
+    EXPECT_EQ(info.nhits(), expected_info.nhits());
+    EXPECT_EQ(info.nhitsPoss(), expected_info.nhitsPoss());
+    EXPECT_EQ(info.towerId(), expected_info.towerId());
+    EXPECT_EQ(info.towerAdc(), expected_info.towerAdc());
+    EXPECT_NEAR(info.towerRawE(), expected_info.towerRawE(), 1e-5);
+    EXPECT_NEAR(info.towerRawEta(), expected_info.towerRawEta(), 1e-5);
+    EXPECT_EQ(info.matchedTracks(), expected_info.matchedTracks());
+  }
+
+  view.clear();
+  EXPECT_TRUE(view.empty());
+  EXPECT_EQ(view.matchedOffsets().size(), 1);
+}
+
+TEST(EventView, AddTrackFromTrackTable) {
+  TVector3 vertex(0.1, -0.2, 5.0);
+
+  StPicoTrack track;
+  track.setId(7);
+  track.setPrimaryMomentum(TVector3(-2, 1, 2));
+  track.setGlobalMomentum(TVector3(-2.1, 1.1, 2.1));
+  track.setOrigin(TVector3(0.5, 0.5, 5.0));
+  track.setNHitsFit(25);
+  track.setNHitsPossible(40);
+
+  jetreader::TrackTable table;
+  table.add(track, vertex, true);
+  table.setKinematics(0, track, true);
+
+  jetreader::EventView expected;
+  expected.addTrack(track, vertex, true);
+  jetreader::EventView view;
+  view.addTrack(track, table, 0, true, track.bemcTowerIndex());
+
+  ASSERT_EQ(view.size(), 1);
+  EXPECT_EQ(view.pt()[0], expected.pt()[0]);
+  EXPECT_EQ(view.eta()[0], expected.eta()[0]);
+  EXPECT_EQ(view.phi()[0], expected.phi()[0]);
+  EXPECT_EQ(view.e()[0], expected.e()[0]);
+  EXPECT_EQ(view.dca()[0], expected.dca()[0]);
+  EXPECT_EQ(view.index()[0], expected.index()[0]);
+  EXPECT_EQ(view.type()[0], expected.type()[0]);
+}
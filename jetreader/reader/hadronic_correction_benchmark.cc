@@ -1,5 +1,7 @@
 #include "benchmark/benchmark.h"
 
+#include "jetreader/reader/tower_matches.h"
+
 #include <map>
 #include <random>
 #include <unordered_map>
@@ -12,7 +14,10 @@
 
 // current conclusion: vectors are significantly faster than maps - unless it
 // becomes apparent that memory becomes an issue, we should use the vector
-// method
+// method. The flat TowerMatches table is faster still, since it neither walks
+// all 4800 towers to reset them nor keeps a separate allocation per tower. The
+// CSR benchmark visits the touched towers instead of all towers, as the
+// corrections only need the towers with matches
 
 static void BM_HadCorrMap(benchmark::State &state) {
   std::map<unsigned, std::vector<unsigned>> tower_map;
@@ -103,7 +108,39 @@ static void BM_HadCorrVector(benchmark::State &state) {
   }
 }
 
+static void BM_HadCorrCSR(benchmark::State &state) {
+  jetreader::TowerMatches tower_map(4800);
+
+  // RNG parameters needed
+  std::uniform_int_distribution<int> nmatch_dist(0, 1500);
+  std::uniform_int_distribution<int> tow_dist(0, 4799);
+  std::random_device r;
+  std::mt19937 gen(r());
+  size_t total = 0;
+
+  for (auto _ : state) {
+    // clear the container
+    tower_map.clear();
+
+    // number of matches in this event
+    unsigned npidtraits = nmatch_dist(gen);
+
+    // fill the table, and sort it by tower
+    for (int i = 0; i < npidtraits; ++i) {
+      unsigned towid = tow_dist(gen);
+      tower_map.add(towid, i);
+    }
+    tower_map.build();
+    for (auto &towid : tower_map.touched()) {
+      for (auto &t : tower_map.tracks(towid))
+        total += t;
+    }
+  }
+  benchmark::DoNotOptimize(total);
+}
+
 BENCHMARK(BM_HadCorrVector);
+BENCHMARK(BM_HadCorrCSR);
 BENCHMARK(BM_HadCorrMap);
 BENCHMARK(BM_HadCorrUnorderedMap);
 BENCHMARK_MAIN();
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include "jetreader/reader/reader.h"
 #include "jetreader/reader/vector_info.h"
 
+#include <algorithm>
 #include <iostream>
 #include <unordered_map>
 #include <vector>
@@ -122,4 +123,85 @@ TEST(HadronicCorrection, InexactMatch) {
     auto test_results = had_corr(reader.picoDst(), false);
     EXPECT_TRUE(compare_results(towers, test_results));
   }
-}
\ No newline at end of file
+}
+TEST(HadronicCorrection, GridMatch) {
+  std::string filename = jetreader::GetTestFile();
+
+  jetreader::Reader reader(filename);
+  reader.init();
+  reader.useHadronicCorrection(true, 1.0);
+  reader.setTrackTowerMatching(jetreader::TrackTowerMatching::grid);
+  jetreader::TrackTowerMatcher matcher;
+
+  while (reader.next()) {
+    StPicoDst *dst = reader.picoDst();
+    matcher.setEvent(dst->event()->primaryVertex().Z(),
+                     dst->event()->bField());
+    for (auto &pseudojet : reader.pseudojets()) {
+      jetreader::VectorInfo info =
+          pseudojet.user_info<jetreader::VectorInfo>();
+      if (!info.isBemcTower())
+        continue;
+      // every matched track projects closest to its tower
+      for (unsigned track_id : info.matchedTracks()) {
+        StPicoTrack *track = dst->track(track_id);
+        TVector3 p = track->pMom();
+        EXPECT_EQ(
+            matcher.match(track->pPt(), p.Eta(), p.Phi(), track->charge()),
+            (int)info.towerId() - 1);
+      }
+    }
+  }
+}
+
+TEST(HadronicCorrection, GridMatchConsistency) {
+  std::string filename = jetreader::GetTestFile();
+
+  jetreader::Reader reader(filename);
+  reader.useHadronicCorrection(true, 1.0);
+  reader.setTrackTowerMatching(jetreader::TrackTowerMatching::grid);
+  reader.setEventOutput(jetreader::EventOutput::both);
+  reader.init();
+
+  int matches = 0;
+  while (reader.next()) {
+    StPicoDst *dst = reader.picoDst();
+    auto &pseudojets = reader.pseudojets();
+    auto &view = reader.eventView();
+    ASSERT_EQ(view.size(), pseudojets.size());
+
+    // the matched tower of each accepted track, by StPicoTrack::id()
+    std::unordered_map<unsigned, int> track_tower;
+    std::unordered_map<unsigned, const jetreader::VectorInfo *> towers;
+    for (size_t i = 0; i < pseudojets.size(); ++i) {
+      auto &info = pseudojets[i].user_info<jetreader::VectorInfo>();
+      if (info.isBemcTower()) {
+        towers[info.towerId() - 1] = &info;
+        continue;
+      }
+      EXPECT_EQ(view.matchedTower()[i], (int)info.matchedTower());
+      track_tower[info.trackId()] = info.matchedTower();
+    }
+
+    // each track matched to a tower points back to that tower
+    for (auto &tower : towers) {
+      for (unsigned track_id : tower.second->matchedTracks()) {
+        unsigned id = dst->track(track_id)->id();
+        ASSERT_EQ(track_tower.count(id), 1);
+        EXPECT_EQ(track_tower[id], (int)tower.first);
+        ++matches;
+      }
+    }
+
+    // and each accepted tower lists the tracks that point to it
+    for (unsigned i = 0; i < dst->numberOfTracks(); ++i) {
+      unsigned id = dst->track(i)->id();
+      if (track_tower.count(id) == 0 || track_tower[id] < 0 ||
+          towers.count(track_tower[id]) == 0)
+        continue;
+      auto &matched = towers[track_tower[id]]->matchedTracks();
+      EXPECT_EQ(std::count(matched.begin(), matched.end(), i), 1);
+    }
+  }
+  EXPECT_GT(matches, 0);
+}
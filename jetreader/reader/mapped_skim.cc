@@ -0,0 +1,111 @@
+#include "jetreader/reader/mapped_skim.h"
+#include "jetreader/lib/assert.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+namespace jetreader {
+
+MappedSkim::MappedSkim(const std::string &filename)
+    : filename_(filename), data_(nullptr), length_(0), config_key_(0),
+      events_end_(0) {
+  int fd = open(filename.c_str(), O_RDONLY);
+  JETREADER_ASSERT(fd >= 0, "could not open skim file ", filename, ": ",
+                   strerror(errno));
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0) {
+    int error = errno;
+    ::close(fd);
+    JETREADER_THROW("could not stat skim file ", filename, ": ",
+                    strerror(error));
+  }
+  length_ = file_stat.st_size;
+  if (length_ < sizeof(SkimFileHeader) + sizeof(SkimFileFooter)) {
+    ::close(fd);
+    JETREADER_THROW(filename, " is not a jetreader skim file");
+  }
+
+  void *mapping = mmap(nullptr, length_, PROT_READ, MAP_SHARED, fd, 0);
+  int error = errno;
+  // the mapping stays valid after the file is closed
+  ::close(fd);
+  JETREADER_ASSERT(mapping != MAP_FAILED, "could not map skim file ",
+                   filename, ": ", strerror(error));
+  data_ = static_cast<const char *>(mapping);
+
+  try {
+    auto header = reinterpret_cast<const SkimFileHeader *>(data_);
+    JETREADER_ASSERT(header->magic == SKIM_MAGIC, filename,
+                     " is not a jetreader skim file");
+    JETREADER_ASSERT(header->version == SKIM_VERSION, "skim file ", filename,
+                     " has version ", header->version, ", expected ",
+                     SKIM_VERSION);
+
+    auto footer = reinterpret_cast<const SkimFileFooter *>(
+        data_ + length_ - sizeof(SkimFileFooter));
+    JETREADER_ASSERT(footer->magic == SKIM_MAGIC &&
+                         footer->version == SKIM_VERSION,
+                     "skim file ", filename,
+                     " is incomplete: was the SkimWriter closed?");
+
+    uint64_t index_end = length_ - sizeof(SkimFileFooter);
+    JETREADER_ASSERT(sizeof(SkimFileHeader) + header->config_size <=
+                             footer->index_offset &&
+                         footer->index_offset % SKIM_ALIGNMENT == 0 &&
+                         footer->index_offset <= index_end &&
+                         footer->n_events ==
+                             (index_end - footer->index_offset) /
+                                 sizeof(uint64_t),
+                     "skim file ", filename, " has a corrupted event index");
+
+    config_.assign(data_ + sizeof(SkimFileHeader), header->config_size);
+    config_key_ = header->config_key;
+    events_end_ = footer->index_offset;
+    index_ = Span<const uint64_t>(
+        reinterpret_cast<const uint64_t *>(data_ + footer->index_offset),
+        footer->n_events);
+  } catch (...) {
+    munmap(const_cast<char *>(data_), length_);
+    throw;
+  }
+}
+
+MappedSkim::~MappedSkim() {
+  if (data_ != nullptr)
+    munmap(const_cast<char *>(data_), length_);
+}
+
+SkimEventRecord MappedSkim::event(size_t i) const {
+  JETREADER_ASSERT(i < index_.size(), "event ", i, " is out of range: skim ",
+                   filename_, " has ", index_.size(), " events");
+  uint64_t offset = index_[i];
+  JETREADER_ASSERT(offset % SKIM_ALIGNMENT == 0 &&
+                       offset + sizeof(SkimEventHeader) <= events_end_,
+                   "skim file ", filename_,
+                   " is corrupted: bad offset for event ", i);
+
+  SkimEventRecord record;
+  record.header = reinterpret_cast<const SkimEventHeader *>(data_ + offset);
+  JETREADER_ASSERT(offset + SkimEventSize(*record.header) <= events_end_,
+                   "skim file ", filename_, " is corrupted: event ", i,
+                   " extends past the end of the events");
+
+  const char *ptr = data_ + offset + sizeof(SkimEventHeader);
+  record.constituents = Span<const SkimConstituent>(
+      reinterpret_cast<const SkimConstituent *>(ptr),
+      record.header->n_constituents);
+  ptr += sizeof(SkimConstituent) * record.header->n_constituents;
+  record.matched = Span<const uint32_t>(
+      reinterpret_cast<const uint32_t *>(ptr), record.header->n_matched);
+  ptr += sizeof(uint32_t) * record.header->n_matched;
+  record.triggers = Span<const uint32_t>(
+      reinterpret_cast<const uint32_t *>(ptr), record.header->n_triggers);
+  return record;
+}
+
+} // namespace jetreader
@@ -0,0 +1,69 @@
+#ifndef JETREADER_READER_MAPPED_SKIM_H
+#define JETREADER_READER_MAPPED_SKIM_H
+
+#include "jetreader/lib/span.h"
+#include "jetreader/reader/skim_format.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace jetreader {
+
+// one event of a memory-mapped skim. All members point directly into the
+// mapping, and are valid as long as the MappedSkim is alive
+struct SkimEventRecord {
+  const SkimEventHeader *header;
+  Span<const SkimConstituent> constituents;
+  // matched track indices of all towers, in constituent order
+  Span<const uint32_t> matched;
+  Span<const uint32_t> triggers;
+};
+
+// read-only, zero-copy access to a skim file written by the SkimWriter. The
+// file is mapped into memory, and events are accessed in place through the
+// event index, in any order. Since the mapping is shared and read-only,
+// processes on the same node reading the same skim share its pages in the
+// page cache.
+class MappedSkim {
+public:
+  // maps a skim file. If the file can't be mapped, is not a skim file or is
+  // incomplete, an exception is raised
+  explicit MappedSkim(const std::string &filename);
+  ~MappedSkim();
+
+  MappedSkim(const MappedSkim &) = delete;
+  MappedSkim &operator=(const MappedSkim &) = delete;
+
+  const std::string &filename() const { return filename_; }
+
+  // the reader config the skim was made with, as YAML
+  const std::string &config() const { return config_; }
+  uint64_t configKey() const { return config_key_; }
+  bool matchesConfig(const std::string &config) const {
+    return SkimConfigKey(config) == config_key_;
+  }
+
+  // number of events in the skim
+  size_t size() const { return index_.size(); }
+
+  // event i, in the order it was written. Raises an exception if i is out of
+  // range or the record is corrupted
+  SkimEventRecord event(size_t i) const;
+
+private:
+  std::string filename_;
+  const char *data_;
+  size_t length_;
+
+  std::string config_;
+  uint64_t config_key_;
+
+  // end of the event records
+  uint64_t events_end_;
+  Span<const uint64_t> index_;
+};
+
+} // namespace jetreader
+
+#endif // JETREADER_READER_MAPPED_SKIM_H
@@ -0,0 +1,121 @@
+#include "gtest/gtest.h"
+
+#include "jetreader/lib/assert.h"
+#include "jetreader/reader/mapped_skim.h"
+#include "jetreader/reader/processed_event.h"
+#include "jetreader/reader/reader_utils.h"
+#include "jetreader/reader/skim_writer.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "StPicoEvent/StPicoBTowHit.h"
+#include "StPicoEvent/StPicoTrack.h"
+
+#include "TVector3.h"
+
+// an event with i tracks and one tower matched to all of them
+jetreader::ProcessedEvent MakeMappedSkimEvent(int i) {
+  jetreader::ProcessedEvent event;
+  event.entry = i;
+  event.header.setRunId(16000000 + i);
+  event.header.setTriggerIds(std::vector<unsigned int>(i % 3, 500000));
+
+  TVector3 vertex(0, 0, 0);
+  std::vector<unsigned> matched;
+  for (int j = 0; j < i; ++j) {
+    StPicoTrack track;
+    track.setId(j);
+    track.setPrimaryMomentum(TVector3(1.0 + j, 1.0, 0.5));
+    track.setGlobalMomentum(TVector3(1.0 + j, 1.0, 0.5));
+    track.setNHitsFit(15 + j);
+    event.pseudojets.push_back(jetreader::MakePseudoJet(track, vertex));
+    matched.push_back(j);
+  }
+  StPicoBTowHit tower;
+  tower.setEnergy(1.0 + i);
+  event.pseudojets.push_back(
+      jetreader::MakePseudoJet(tower, 42, 0.1, 1.0, 0.1, 1.0 + i, matched));
+  return event;
+}
+
+TEST(MappedSkim, Events) {
+  std::string filename = "mapped_skim_test_tmp.skim";
+  std::string config = "reader:\n  useHadronicCorrection: true\n";
+  std::vector<jetreader::ProcessedEvent> events;
+  {
+    jetreader::SkimWriter writer(filename, config);
+    for (int i = 0; i < 7; ++i) {
+      events.push_back(MakeMappedSkimEvent(i));
+      writer.write(events.back());
+    }
+  }
+
+  jetreader::MappedSkim skim(filename);
+  EXPECT_EQ(skim.config(), config);
+  EXPECT_TRUE(skim.matchesConfig(config));
+  ASSERT_EQ(skim.size(), events.size());
+
+  // events can be accessed in any order
+  for (int i = events.size() - 1; i >= 0; --i) {
+    jetreader::SkimEventRecord record = skim.event(i);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(record.header) %
+                  alignof(jetreader::SkimEventHeader),
+              0);
+    EXPECT_EQ(record.header->entry, i);
+    EXPECT_EQ(record.header->run_id, 16000000 + i);
+    ASSERT_EQ(record.triggers.size(), i % 3);
+    for (auto trigger : record.triggers)
+      EXPECT_EQ(trigger, 500000);
+
+    ASSERT_EQ(record.constituents.size(), i + 1);
+    for (int j = 0; j < i; ++j) {
+      EXPECT_EQ(record.constituents[j].px, events[i].pseudojets[j].px());
+      EXPECT_EQ(record.constituents[j].e, events[i].pseudojets[j].e());
+      EXPECT_EQ(record.constituents[j].index, j);
+      EXPECT_EQ(record.constituents[j].nhits, 15 + j);
+    }
+    auto &tower = record.constituents.back();
+    EXPECT_EQ(tower.index, 42);
+    EXPECT_EQ(tower.n_matched, i);
+    ASSERT_EQ(record.matched.size(), i);
+    for (int j = 0; j < i; ++j)
+      EXPECT_EQ(record.matched[j], j);
+  }
+
+  EXPECT_THROW(skim.event(events.size()), jetreader::AssertionFailure);
+
+  remove(filename.c_str());
+}
+
+TEST(MappedSkim, Incomplete) {
+  std::string filename = "mapped_skim_test_incomplete_tmp.skim";
+  std::string truncated = "mapped_skim_test_truncated_tmp.skim";
+  {
+    jetreader::SkimWriter writer(filename, "");
+    for (int i = 0; i < 3; ++i)
+      writer.write(MakeMappedSkimEvent(i));
+  }
+
+  // drop the footer, as if the writer had not been closed
+  std::ifstream in(filename, std::ios::binary);
+  std::string contents((std::istreambuf_iterator<char>(in)),
+                       std::istreambuf_iterator<char>());
+  std::ofstream out(truncated, std::ios::binary);
+  out.write(contents.data(),
+            contents.size() - sizeof(jetreader::SkimFileFooter));
+  out.close();
+
+  EXPECT_NO_THROW(jetreader::MappedSkim skim(filename));
+  EXPECT_THROW(jetreader::MappedSkim skim(truncated),
+               jetreader::AssertionFailure);
+  EXPECT_THROW(jetreader::MappedSkim skim("mapped_skim_test_missing.skim"),
+               jetreader::AssertionFailure);
+
+  remove(filename.c_str());
+  remove(truncated.c_str());
+}
@@ -0,0 +1,164 @@
+#include "jetreader/reader/parallel_reader.h"
+#include "jetreader/lib/assert.h"
+
+#include <algorithm>
+
+#include "TROOT.h"
+
+namespace jetreader {
+
+ParallelReader::ParallelReader(const std::string &input_file,
+                               unsigned n_workers)
+    : input_file_(input_file), n_workers_(n_workers), entries_(0),
+      initialized_(false), active_workers_(0) {
+  if (n_workers_ == 0)
+    n_workers_ = std::max(1u, std::thread::hardware_concurrency());
+
+  // each worker creates and reads its own TChain, which requires ROOT's
+  // internal locking to be turned on
+  ROOT::EnableThreadSafety();
+}
+
+ParallelReader::~ParallelReader() { joinWorkers(); }
+
+void ParallelReader::loadConfig(const std::string &yaml_filename) {
+  JETREADER_ASSERT(!initialized_,
+                   "config must be loaded before the ParallelReader is "
+                   "initialized");
+  config_file_ = yaml_filename;
+}
+
+void ParallelReader::init() {
+  JETREADER_ASSERT(!initialized_, "ParallelReader is already initialized");
+
+  // Readers are created and initialized sequentially - only the event loop is
+  // run in parallel
+  readers_.clear();
+  for (unsigned i = 0; i < n_workers_; ++i) {
+    readers_.push_back(make_unique<Reader>(input_file_));
+    Reader &reader = *readers_.back();
+    if (!config_file_.empty())
+      reader.loadConfig(config_file_);
+    if (setup_)
+      setup_(reader);
+    reader.init();
+  }
+
+  // split the chain into contiguous ranges, so that each worker reads through
+  // as few files as possible
+  entries_ = readers_.front()->entries();
+  for (unsigned i = 0; i < n_workers_; ++i) {
+    int64_t begin = entries_ * i / n_workers_;
+    int64_t end = entries_ * (i + 1) / n_workers_;
+    readers_[i]->setEntryRange(begin, end);
+  }
+
+  initialized_ = true;
+}
+
+void ParallelReader::run(
+    std::function<void(Reader &reader, unsigned worker)> callback) {
+  JETREADER_ASSERT(threads_.empty(),
+                   "run() called while workers are already running");
+  if (!initialized_)
+    init();
+
+  for (unsigned i = 0; i < n_workers_; ++i) {
+    threads_.emplace_back([this, i, &callback] {
+      try {
+        Reader &reader = *readers_[i];
+        while (reader.next())
+          callback(reader, i);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mutex_);
+        if (!error_)
+          error_ = std::current_exception();
+      }
+    });
+  }
+
+  joinWorkers();
+  rethrowWorkerException();
+}
+
+void ParallelReader::start(size_t queue_size) {
+  JETREADER_ASSERT(threads_.empty(),
+                   "start() called while workers are already running");
+  if (!initialized_)
+    init();
+
+  queue_ = make_unique<BoundedQueue<ProcessedEvent>>(queue_size);
+  // holds every event that can be in flight: the queued events, one per
+  // worker and the user's
+  free_ =
+      make_unique<BoundedQueue<ProcessedEvent>>(queue_size + n_workers_ + 1);
+  active_workers_ = n_workers_;
+  for (unsigned i = 0; i < n_workers_; ++i)
+    threads_.emplace_back(&ParallelReader::fillQueue, this, i);
+}
+
+bool ParallelReader::next(ProcessedEvent &event) {
+  JETREADER_ASSERT(queue_ != nullptr,
+                   "start() must be called before next() is used");
+  // the user's previous event is handed back to the workers to be refilled
+  event.recycle();
+  free_->tryPush(std::move(event));
+  if (queue_->pop(event))
+    return true;
+
+  // the queue is only closed once all workers are done, or a worker failed
+  joinWorkers();
+  rethrowWorkerException();
+  return false;
+}
+
+void ParallelReader::stop() {
+  joinWorkers();
+  rethrowWorkerException();
+}
+
+void ParallelReader::fillQueue(unsigned worker) {
+  try {
+    Reader &reader = *readers_[worker];
+    ProcessedEvent event;
+    while (reader.next()) {
+      // reuse an event the user is done with, if there is one
+      free_->tryPop(event);
+      event.fill(reader);
+      // push fails when the queue is closed by stop()
+      if (!queue_->push(std::move(event)))
+        break;
+    }
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(error_mutex_);
+    if (!error_)
+      error_ = std::current_exception();
+    queue_->close();
+  }
+
+  // the last worker to finish closes the queue, signalling the end of the
+  // chain to next()
+  if (--active_workers_ == 0)
+    queue_->close();
+}
+
+void ParallelReader::joinWorkers() {
+  if (queue_ != nullptr)
+    queue_->close();
+  for (auto &thread : threads_)
+    if (thread.joinable())
+      thread.join();
+  threads_.clear();
+}
+
+void ParallelReader::rethrowWorkerException() {
+  std::exception_ptr error;
+  {
+    std::lock_guard<std::mutex> lock(error_mutex_);
+    std::swap(error, error_);
+  }
+  if (error)
+    std::rethrow_exception(error);
+}
+
+} // namespace jetreader
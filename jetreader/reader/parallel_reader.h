@@ -0,0 +1,110 @@
+#ifndef JETREADER_READER_PARALLEL_READER_H
+#define JETREADER_READER_PARALLEL_READER_H
+
+#include "jetreader/lib/bounded_queue.h"
+#include "jetreader/lib/memory.h"
+#include "jetreader/reader/processed_event.h"
+#include "jetreader/reader/reader.h"
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace jetreader {
+
+// Processes a picoDst chain on multiple threads. Each worker owns a complete
+// Reader (its own StPicoDstReader, TChain, selectors and hadronic correction)
+// over a disjoint, contiguous range of entries in the chain, so the events
+// accepted by the workers are exactly the events a single Reader would accept.
+// Events are either passed to a user callback on the worker thread, or copied
+// into a bounded queue that the user drains with next().
+class ParallelReader {
+public:
+  // The input file can be either a ROOT file containing a PicoDst tree, or a
+  // file containing a list of picoDst files, as with the Reader. If n_workers
+  // is zero, one worker is used per hardware thread.
+  ParallelReader(const std::string &input_file, unsigned n_workers = 0);
+
+  ~ParallelReader();
+
+  // YAML config file loaded by every worker's Reader before initialization.
+  // See Reader::loadConfig()
+  void loadConfig(const std::string &yaml_filename);
+
+  // function called on each worker's Reader before it is initialized. Used for
+  // anything that can't be set through the YAML config - custom selectors,
+  // branch status, centrality definitions, etc. It is called sequentially, on
+  // the thread that calls init()
+  void setReaderSetup(std::function<void(Reader &)> setup) { setup_ = setup; }
+
+  // creates and initializes the worker Readers and splits the chain between
+  // them. Called automatically by run() and start() if needed. If
+  // initialization fails, an exception is raised.
+  void init();
+
+  // processes all entries in the chain. callback is called once for each
+  // accepted event, on the worker thread that owns the event, with that
+  // worker's Reader and its index. Callbacks from different workers run
+  // concurrently, so any shared state must be synchronized by the user. Blocks
+  // until all workers are finished. If a worker raises an exception, it is
+  // re-raised here.
+  void run(std::function<void(Reader &reader, unsigned worker)> callback);
+
+  // starts the workers in the background. Accepted events are copied into a
+  // queue holding at most queue_size events, which is drained with next().
+  void start(size_t queue_size = 256);
+
+  // fills event with the next accepted event from any worker. Events are not
+  // ordered by entry. The previous contents of event are recycled and handed
+  // back to the workers, which refill them without allocating, so passing the
+  // same event to every call is cheapest. Returns false when all workers have
+  // finished and the queue is empty. If a worker raised an exception, it is
+  // re-raised here.
+  bool next(ProcessedEvent &event);
+
+  // stops all workers started by start() and discards any queued events
+  void stop();
+
+  unsigned workers() const { return n_workers_; }
+  int64_t entries() const { return entries_; }
+
+  // direct access to a worker's Reader - only safe while the workers are not
+  // running
+  Reader &reader(unsigned worker) { return *readers_.at(worker); }
+
+private:
+  // loop run by each worker thread in queue mode
+  void fillQueue(unsigned worker);
+
+  // stops the workers without re-raising their exceptions
+  void joinWorkers();
+
+  void rethrowWorkerException();
+
+  std::string input_file_;
+  std::string config_file_;
+  unsigned n_workers_;
+  int64_t entries_;
+  bool initialized_;
+
+  std::function<void(Reader &)> setup_;
+  std::vector<unique_ptr<Reader>> readers_;
+
+  std::vector<std::thread> threads_;
+  std::atomic<unsigned> active_workers_;
+  unique_ptr<BoundedQueue<ProcessedEvent>> queue_;
+  // events recycled by next(), refilled by the workers
+  unique_ptr<BoundedQueue<ProcessedEvent>> free_;
+
+  std::mutex error_mutex_;
+  std::exception_ptr error_;
+};
+
+} // namespace jetreader
+
+#endif // JETREADER_READER_PARALLEL_READER_H
@@ -0,0 +1,169 @@
+#include "gtest/gtest.h"
+
+#include "jetreader/lib/test_data.h"
+#include "jetreader/reader/parallel_reader.h"
+#include "jetreader/reader/processed_event.h"
+#include "jetreader/reader/reader.h"
+
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "yaml-cpp/yaml.h"
+
+// summary of an accepted event: number of pseudojets and their scalar sum pT
+typedef std::map<int64_t, std::pair<size_t, double>> EventSummary;
+
+std::pair<size_t, double> summarize(std::vector<fastjet::PseudoJet> &jets) {
+  double sum_pt = 0.0;
+  for (auto &jet : jets)
+    sum_pt += jet.pt();
+  return {jets.size(), sum_pt};
+}
+
+const std::string CONFIG_FILE = "parallel_reader_test_config.yaml";
+
+jetreader::ReaderTestConfig writeTestConfig() {
+  jetreader::ReaderTestConfig config = jetreader::GetTestConfig();
+  std::ofstream out_stream;
+  out_stream.open(CONFIG_FILE);
+  out_stream << config.config;
+  out_stream.close();
+  return config;
+}
+
+void removeTestConfig(jetreader::ReaderTestConfig &config) {
+  remove(config.bad_tower_file.c_str());
+  remove(config.bad_run_file.c_str());
+  remove(CONFIG_FILE.c_str());
+}
+
+EventSummary serialSummary(const std::string &config_file) {
+  EventSummary summary;
+  jetreader::Reader reader(jetreader::GetTestFile());
+  jetreader::TurnOffMostBranches(reader);
+  reader.loadConfig(config_file);
+  reader.init();
+  while (reader.next())
+    summary[reader.currentEntry()] = summarize(reader.pseudojets());
+  return summary;
+}
+
+TEST(ParallelReader, EntryRanges) {
+  jetreader::ParallelReader reader(jetreader::GetTestFile(), 3);
+  reader.setReaderSetup(
+      [](jetreader::Reader &r) { jetreader::TurnOffBranches(r); });
+  reader.init();
+
+  EXPECT_EQ(reader.entries(), 624);
+  int64_t expected_begin = 0;
+  for (unsigned i = 0; i < reader.workers(); ++i) {
+    EXPECT_EQ(reader.reader(i).entryRangeBegin(), expected_begin);
+    expected_begin = reader.reader(i).entryRangeEnd();
+  }
+  EXPECT_EQ(expected_begin, 624);
+}
+
+TEST(ParallelReader, Callback) {
+  jetreader::ReaderTestConfig config = writeTestConfig();
+  EventSummary expected = serialSummary(CONFIG_FILE);
+
+  EventSummary summary;
+  std::mutex summary_mutex;
+
+  jetreader::ParallelReader reader(jetreader::GetTestFile(), 4);
+  reader.loadConfig(CONFIG_FILE);
+  reader.setReaderSetup(
+      [](jetreader::Reader &r) { jetreader::TurnOffMostBranches(r); });
+  reader.run([&](jetreader::Reader &r, unsigned worker) {
+    auto result = summarize(r.pseudojets());
+    std::lock_guard<std::mutex> lock(summary_mutex);
+    summary[r.currentEntry()] = result;
+  });
+
+  EXPECT_GT(expected.size(), 0);
+  EXPECT_EQ(summary.size(), expected.size());
+  for (auto &entry : expected) {
+    ASSERT_EQ(summary.count(entry.first), 1);
+    EXPECT_EQ(summary[entry.first].first, entry.second.first);
+    EXPECT_EQ(summary[entry.first].second, entry.second.second);
+  }
+
+  removeTestConfig(config);
+}
+
+TEST(ParallelReader, Queue) {
+  jetreader::ReaderTestConfig config = writeTestConfig();
+  EventSummary expected = serialSummary(CONFIG_FILE);
+
+  jetreader::ParallelReader reader(jetreader::GetTestFile(), 4);
+  reader.loadConfig(CONFIG_FILE);
+  reader.setReaderSetup(
+      [](jetreader::Reader &r) { jetreader::TurnOffMostBranches(r); });
+  reader.start(16);
+
+  EventSummary summary;
+  jetreader::ProcessedEvent event;
+  int reused = 0;
+  while (reader.next(event)) {
+    EXPECT_EQ(summary.count(event.entry), 0);
+    summary[event.entry] = summarize(event.pseudojets);
+    // recycled events keep the VectorInfos of earlier, larger events
+    if (event.pool.size() > event.pseudojets.size())
+      ++reused;
+  }
+  EXPECT_GT(reused, 0);
+
+  EXPECT_EQ(summary.size(), expected.size());
+  for (auto &entry : expected) {
+    ASSERT_EQ(summary.count(entry.first), 1);
+    EXPECT_EQ(summary[entry.first].first, entry.second.first);
+    EXPECT_EQ(summary[entry.first].second, entry.second.second);
+  }
+
+  removeTestConfig(config);
+}
+
+TEST(ParallelReader, SmoothedCentrality) {
+  // smoothing is keyed on the event, so each worker's Reader smooths an event
+  // exactly as a single Reader reading the whole chain does
+  auto setup = [](jetreader::Reader &r) {
+    jetreader::TurnOffBranches(r);
+    r.centrality().loadCentralityDef(jetreader::CentDefId::Run14LowMid);
+    r.centrality().useSmoothing(true);
+  };
+
+  struct Centrality {
+    double refmultcorr;
+    int centrality16;
+    double weight;
+  };
+  std::map<int64_t, Centrality> expected;
+  jetreader::Reader serial(jetreader::GetTestFile());
+  setup(serial);
+  serial.init();
+  while (serial.next())
+    expected[serial.currentEntry()] = {serial.refMultCorr(),
+                                       serial.centrality16(),
+                                       serial.centralityWeight()};
+
+  jetreader::ParallelReader reader(jetreader::GetTestFile(), 4);
+  reader.setReaderSetup(setup);
+  reader.start(16);
+
+  size_t events = 0;
+  jetreader::ProcessedEvent event;
+  while (reader.next(event)) {
+    ASSERT_EQ(expected.count(event.entry), 1);
+    const Centrality &serial_event = expected[event.entry];
+    EXPECT_EQ(event.refmultcorr, serial_event.refmultcorr);
+    EXPECT_EQ(event.centrality16, serial_event.centrality16);
+    EXPECT_EQ(event.weight, serial_event.weight);
+    ++events;
+  }
+  EXPECT_GT(events, 0);
+  EXPECT_EQ(events, expected.size());
+}
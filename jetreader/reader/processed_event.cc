@@ -0,0 +1,48 @@
+#include "jetreader/reader/processed_event.h"
+#include "jetreader/lib/assert.h"
+#include "jetreader/reader/reader.h"
+
+#include <utility>
+
+namespace jetreader {
+
+void ProcessedEvent::fill(Reader &reader) {
+  JETREADER_ASSERT(reader.picoDst() != nullptr &&
+                       reader.picoDst()->event() != nullptr,
+                   "no event loaded: can't fill ProcessedEvent");
+
+  // the reader's internal state is used directly, since this is also called
+  // by the reader's prefetching thread, where the public accessors refer to
+  // the prefetched event instead
+  entry = reader.index_;
+  header = *reader.picoDst()->event();
+
+  // the pseudojets move to this event together with the pool that owns their
+  // VectorInfos, and the reader continues with this event's cleared buffers.
+  // No reference counts are shared between the event and the reader's pool
+  recycle();
+  std::swap(pseudojets, reader.pseudojets_);
+  std::swap(pool, reader.info_pool_);
+  std::swap(view, reader.event_view_);
+
+  if (reader.centrality_.isValid()) {
+    refmultcorr = reader.centrality_.refMultCorr();
+    centrality16 = reader.centrality_.centrality16();
+    centrality9 = reader.centrality_.centrality9();
+    weight = reader.centrality_.weight();
+  } else {
+    refmultcorr = header.refMult();
+    centrality16 = -1;
+    centrality9 = -1;
+    weight = 1.0;
+  }
+}
+
+void ProcessedEvent::recycle() {
+  pseudojets.clear();
+  view.clear();
+  pool.unshare();
+  pool.reset();
+}
+
+} // namespace jetreader
@@ -0,0 +1,59 @@
+#ifndef JETREADER_READER_PROCESSED_EVENT_H
+#define JETREADER_READER_PROCESSED_EVENT_H
+
+#include "jetreader/reader/event_view.h"
+#include "jetreader/reader/vector_info_pool.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "StPicoEvent/StPicoEvent.h"
+
+#include "fastjet/PseudoJet.hh"
+
+namespace jetreader {
+
+class Reader;
+
+// a self-contained copy of an accepted event: the event header, the selected
+// tracks and towers as PseudoJets, and the centrality information. Used to
+// hand events from a Reader on one thread to the user on another, where the
+// Reader's StPicoDst can not be shared.
+//
+// An event keeps its memory when it is refilled: the reader's pseudojets,
+// EventView and VectorInfo pool are swapped with the event's, so filling a
+// recycled event takes no heap allocation once the buffers are large enough.
+struct ProcessedEvent {
+  // takes the current event from the reader. The reader must have a loaded
+  // event (after next() or readEvent()). The event's pseudojets are swapped
+  // out of the reader, so reader.pseudojets() is empty afterwards. The same
+  // holds for the EventView
+  void fill(Reader &reader);
+
+  // clears the event, keeping its memory, so that it can be filled again. When
+  // the event is handed back to another thread to be refilled, this must be
+  // called first on the thread that used it, which drops the event's
+  // references to the VectorInfos of any PseudoJets copied by the user
+  void recycle();
+
+  // position of the event in the reader's chain
+  int64_t entry = -1;
+
+  StPicoEvent header;
+  std::vector<fastjet::PseudoJet> pseudojets;
+  // only filled if the reader's output includes the EventView
+  EventView view;
+  // owns the user info of pseudojets
+  VectorInfoPool pool;
+
+  // centrality information - if no centrality definition is loaded, these are
+  // refmult, -1, -1 and 1.0 respectively
+  double refmultcorr = -1.0;
+  int centrality16 = -1;
+  int centrality9 = -1;
+  double weight = 1.0;
+};
+
+} // namespace jetreader
+
+#endif // JETREADER_READER_PROCESSED_EVENT_H
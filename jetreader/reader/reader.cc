@@ -1,25 +1,63 @@
 #include "jetreader/reader/reader.h"
 #include "jetreader/lib/assert.h"
 #include "jetreader/reader/reader_utils.h"
+#include "jetreader/reader/shard_planner.h"
 
+#include <algorithm>
 #include <iostream>
+#include <limits>
+#include <typeinfo>
 
 #include "StPicoEvent/StPicoArrays.h"
 #include "StPicoEvent/StPicoBEmcPidTraits.h"
 
+#include "TFile.h"
+#include "TROOT.h"
+
 namespace jetreader {
 
+namespace {
+
+// energy deposited by a minimum ionizing particle in a tower at eta
+double MIPEnergy(double tow_eta) {
+  // copied from TStarJetPicoReader - has a note saying it may be 0.264
+  // instead of 0.261. MIP value taken from spin group nick: as its written
+  // its using eta - shouldn't it be using corrected eta?
+  double theta = 2.0 * atan(exp(tow_eta));
+  return 0.261 * (1. + 0.056 * pow(tow_eta, 2.0)) / sin(theta); // GeV
+}
+
+} // namespace
+
 Reader::Reader(const std::string &input_file)
-    : index_(-1), use_primary_tracks_(true),
-      StPicoDstReader(input_file.c_str()), use_had_corr_(true),
-      had_corr_fraction_(1.0), had_corr_map_(4800), use_mip_corr_(false),
-      approx_track_tower_match_(false), manager_(this) {
+    : input_file_(input_file), chain_entries_(-1), index_(-1),
+      entry_begin_(0), entry_end_(-1), shard_index_(0), shard_count_(0),
+      use_primary_tracks_(true), use_cut_flow_(false), cut_flow_timing_(false),
+      // file lists are added to the chain by the Reader, in buildChain()
+      StPicoDstReader(ChainMetadata::IsFileList(input_file)
+                          ? ""
+                          : input_file.c_str()),
+      use_had_corr_(true),
+      had_corr_fraction_(1.0), tower_matches_(BemcHelper::TOWERS),
+      use_mip_corr_(false),
+      approx_track_tower_match_(false),
+      track_tower_matching_(TrackTowerMatching::picoDst),
+      tower_energy_floor_(0.0),
+      manager_(this), prune_branches_(true),
+      event_output_(EventOutput::pseudoJets),
+      use_run_index_(false), use_chain_metadata_(false),
+      chain_metadata_threads_(0), use_header_cache_(false), prefetch_depth_(0) {
   event_selector_ = make_unique<EventSelector>();
   track_selector_ = make_unique<TrackSelector>();
   tower_selector_ = make_unique<TowerSelector>();
+
+  tower_matched_p_.assign(BemcHelper::TOWERS, 0.0);
+  const BemcHelper &helper = tower_kinematics_.bemcHelper();
+  for (unsigned ring = 0; ring < BemcHelper::ETA_RINGS; ++ring)
+    ring_mip_e_.push_back(MIPEnergy(helper.towerEta(helper.towerAt(ring, 0))));
 }
 
-Reader::~Reader() {}
+Reader::~Reader() { stopPrefetch(); }
 
 void Reader::loadConfig(const std::string &yaml_filename) {
   try {
@@ -39,21 +77,89 @@ void Reader::writeConfig(const std::string &yaml_filename) {
   }
 }
 
+void Reader::useCutFlow(bool flag, bool timing) {
+  use_cut_flow_ = flag;
+  cut_flow_timing_ = flag && timing;
+  event_selector_->cutFlow().setActive(use_cut_flow_, cut_flow_timing_);
+  track_selector_->cutFlow().setActive(use_cut_flow_, cut_flow_timing_);
+  tower_selector_->cutFlow().setActive(use_cut_flow_, cut_flow_timing_);
+}
+
+std::string Reader::cutFlowTable() {
+  return "event selection:\n" + event_selector_->cutFlow().table() +
+         "\ntrack selection:\n" + track_selector_->cutFlow().table() +
+         "\ntower selection:\n" + tower_selector_->cutFlow().table();
+}
+
+void Reader::writeCutFlow(const std::string &yaml_filename) {
+  try {
+    manager_.writeCutFlow(yaml_filename);
+  } catch (std::exception &e) {
+    std::cerr << "error writing cut flow file: " << yaml_filename
+              << "; caught exception: " << e.what() << std::endl;
+  }
+}
+
 bool Reader::next() {
+  if (prefetch_depth_ == 0)
+    return nextEvent();
+
+  if (prefetch_queue_ == nullptr)
+    startPrefetch();
+
+  // the previous event is handed back to the prefetching thread, which refills
+  // it without allocating. If the free list is full, it is discarded instead
+  current_event_.recycle();
+  prefetch_free_->tryPush(std::move(current_event_));
+
+  if (prefetch_queue_->pop(current_event_))
+    return true;
+
+  // the queue is closed by the prefetching thread at the end of the chain, or
+  // if it caught an exception
+  stopPrefetch();
+  if (prefetch_error_) {
+    std::exception_ptr error;
+    std::swap(error, prefetch_error_);
+    std::rethrow_exception(error);
+  }
+  return false;
+}
 
+bool Reader::nextEvent() {
   if (chain() == nullptr) {
     JETREADER_THROW("No input file loaded: next() failed");
   }
 
   // last valid index in the chain, make sure we don't try to load past this
-  int64_t last_event_index = chain()->GetEntries() - 1;
+  int64_t last_event_index = lastEntry();
+
+  // start at the beginning of the entry range if we haven't reached it yet
+  if (index_ < entry_begin_ - 1)
+    index_ = entry_begin_ - 1;
+
+  // custom event selectors may use information that isn't in the header cache
+  bool preselect = use_header_cache_ &&
+                   typeid(*event_selector_) == typeid(EventSelector);
 
   // loop to find the next accepted event, or until we hit the end of the chain.
   // for the special case of when we find a bad run index, we will attempt to
   // speed-up running through the event chain by disabling all branches except
   // for the Event branch.
-  while (chain()->GetReadEvent() < last_event_index) {
-    EventStatus load_status = readEvent(++index_);
+  while (index_ < last_event_index) {
+    // events rejected by the cached header are never read from the chain
+    if (preselect && preselectEvent(index_ + 1) != EventStatus::acceptEvent) {
+      ++index_;
+      continue;
+    }
+
+    EventStatus load_status;
+    {
+      // the event cuts of preselected events were already counted on the
+      // cached header
+      CutFlow::Pause pause(event_selector_->cutFlow(), preselect);
+      load_status = loadEvent(++index_);
+    }
 
     switch (load_status) {
     case EventStatus::acceptEvent:
@@ -61,8 +167,23 @@ bool Reader::next() {
     case EventStatus::rejectEvent:
       continue;
     case EventStatus::rejectRun:
-      if (findNextGoodRun())
-        return true;
+      if (use_run_index_) {
+        // jump to the last entry of the run, so the next iteration reads the
+        // first entry after it. If the index disagrees with the event, it is
+        // not trusted and the run is skipped event by event instead
+        const RunIndex::Range *range = run_index_.find(index_);
+        if (range != nullptr &&
+            range->run_id == (unsigned)picoDst()->event()->runId()) {
+          countSkippedEntries(std::min(range->end - 1, last_event_index) -
+                              index_);
+          index_ = range->end - 1;
+          break;
+        }
+      }
+      // the first event of the next good run still has to pass the event
+      // selection, so it is read through readEvent() on the next iteration
+      if (!findNextGoodRun())
+        return false;
       break;
     }
   }
@@ -70,6 +191,12 @@ bool Reader::next() {
 }
 
 EventStatus Reader::readEvent(size_t idx) {
+  JETREADER_ASSERT(prefetch_queue_ == nullptr,
+                   "readEvent() can not be used while prefetching events");
+  return loadEvent(idx);
+}
+
+EventStatus Reader::loadEvent(size_t idx) {
   // clear last event - prevents accumulation of stale pseudojets or tower-track
   // matches.
   clear();
@@ -77,9 +204,9 @@ EventStatus Reader::readEvent(size_t idx) {
   if (chain() == nullptr)
     JETREADER_THROW("No input file loaded: readEvent() failed");
 
-  if (idx >= chain()->GetEntries() || idx < 0)
+  if (idx >= entries() || idx < 0)
     JETREADER_THROW("Requested index: ", idx, "out of bounds: ", " chain has ",
-                    chain()->GetEntries(), "events");
+                    entries(), "events");
 
   // attempt to load the requested event
   index_ = idx;
@@ -92,8 +219,9 @@ EventStatus Reader::readEvent(size_t idx) {
   // event de-syncs for whatever reason
   if (centrality_.isValid()) {
     centrality_.setEvent(
-        picoDst()->event()->runId(), picoDst()->event()->refMult(),
-        picoDst()->event()->ZDCx(), picoDst()->event()->primaryVertex().Z());
+        picoDst()->event()->runId(), picoDst()->event()->eventId(),
+        picoDst()->event()->refMult(), picoDst()->event()->ZDCx(),
+        picoDst()->event()->primaryVertex().Z());
   }
 
   return makeEvent();
@@ -101,10 +229,53 @@ EventStatus Reader::readEvent(size_t idx) {
 
 void Reader::init() {
   StPicoDstReader::Init();
+  if (ChainMetadata::IsFileList(input_file_))
+    buildChain();
+  if (chain_entries_ < 0)
+    chain_entries_ = chain()->GetEntries();
+
   // make sure the event branch is loaded - otherwise, we can't use the data,
   // because we need vertex information, run ID, etc
   JETREADER_ASSERT(chain()->GetBranchStatus("Event"),
                    "Event branch is not loaded, can't process event");
+
+  if (prune_branches_)
+    pruneUnusedBranches();
+
+  if (use_run_index_)
+    loadRunIndex();
+  if (use_header_cache_)
+    loadEventHeaderCache();
+  if (shard_count_ > 0)
+    applyShard();
+}
+
+std::vector<std::string> Reader::activeBranches() {
+  JETREADER_ASSERT(chain() != nullptr,
+                   "No input file loaded: can't query branch status");
+  std::vector<std::string> branches;
+  for (int i = 0; i < StPicoArrays::NAllPicoArrays; ++i) {
+    std::string branchname = StPicoArrays::picoArrayNames[i];
+    if (chain()->GetBranchStatus(branchname.c_str()))
+      branches.push_back(branchname);
+  }
+  return branches;
+}
+
+void Reader::useRunIndex(bool flag, const std::string &index_file) {
+  use_run_index_ = flag;
+  run_index_file_ = index_file;
+  if (!use_run_index_)
+    run_index_.clear();
+}
+
+void Reader::useChainMetadata(bool flag, const std::string &cache_file,
+                              unsigned threads) {
+  use_chain_metadata_ = flag;
+  chain_metadata_file_ = cache_file;
+  chain_metadata_threads_ = threads;
+  if (!use_chain_metadata_)
+    chain_metadata_.clear();
 }
 
 void Reader::useMIPCorrection(bool flag) {
@@ -129,33 +300,124 @@ void Reader::useHadronicCorrection(bool flag, double fraction) {
   }
 }
 
+void Reader::usePrefetch(unsigned depth) {
+  JETREADER_ASSERT(prefetch_queue_ == nullptr,
+                   "usePrefetch() must be called before the first call to "
+                   "next()");
+  prefetch_depth_ = depth;
+
+  // the user's thread and the prefetching thread can use ROOT at the same time
+  if (prefetch_depth_ > 0)
+    ROOT::EnableThreadSafety();
+}
+
+StPicoEvent *Reader::event() {
+  if (prefetch_depth_)
+    return &current_event_.header;
+  return picoDst()->event();
+}
+
 std::vector<fastjet::PseudoJet> &Reader::pseudojets() {
+  if (prefetch_depth_) {
+    if (event_output_ == EventOutput::eventView &&
+        current_event_.pseudojets.empty())
+      current_event_.view.fillPseudoJets(current_event_.pseudojets);
+    return current_event_.pseudojets;
+  }
+
   // make sure the event was loaded through readEvent(), not directly through
   // the chain; this prevents loading an event in the chain and getting a
   // "stale" set of pseudojets
   if (chain()->GetReadEvent() != index_) {
-    readEvent(chain()->GetReadEvent());
+    loadEvent(chain()->GetReadEvent());
   }
 
+  if (event_output_ == EventOutput::eventView && pseudojets_.empty())
+    event_view_.fillPseudoJets(pseudojets_, &info_pool_);
+
   return pseudojets_;
 }
 
+double Reader::refMultCorr() {
+  if (prefetch_depth_)
+    return current_event_.refmultcorr;
+  if (centrality_.isValid())
+    return centrality_.refMultCorr();
+  return picoDst()->event()->refMult();
+}
+
+double Reader::centralityWeight() {
+  if (prefetch_depth_)
+    return current_event_.weight;
+  if (centrality_.isValid())
+    return centrality_.weight();
+  return 1.0;
+}
+
+EventView &Reader::eventView() {
+  if (prefetch_depth_)
+    return current_event_.view;
+
+  if (chain()->GetReadEvent() != index_) {
+    loadEvent(chain()->GetReadEvent());
+  }
+  return event_view_;
+}
+
+void Reader::setEntryRange(int64_t begin, int64_t end) {
+  JETREADER_ASSERT(begin >= 0, "entry range must begin at or after entry 0");
+  JETREADER_ASSERT(end < 0 || end >= begin, "entry range end: ", end,
+                   " is before entry range beginning: ", begin);
+  entry_begin_ = begin;
+  entry_end_ = end;
+  index_ = begin - 1;
+}
+
+void Reader::setShard(unsigned index, unsigned count) {
+  JETREADER_ASSERT(count > 0, "number of shards must be positive");
+  JETREADER_ASSERT(index < count, "shard index ", index,
+                   " out of range: there are ", count, " shards");
+  shard_index_ = index;
+  shard_count_ = count;
+  if (chain() != nullptr)
+    applyShard();
+}
+
+void Reader::applyShard() {
+  ShardPlanner planner;
+  if (use_run_index_ && run_index_.entries() == entries())
+    planner.addRuns(run_index_, event_selector_->badRuns());
+  else
+    planner.addEntries(entries());
+  ShardPlanner::Shard shard = planner.shard(shard_index_, shard_count_);
+  setEntryRange(shard.begin, shard.end);
+}
+
 void Reader::setEventSelector(EventSelector *selector) {
   event_selector_ = unique_ptr<EventSelector>(selector);
+  if (use_cut_flow_)
+    event_selector_->cutFlow().setActive(true, cut_flow_timing_);
 }
 
 void Reader::setTrackSelector(TrackSelector *selector) {
   track_selector_ = unique_ptr<TrackSelector>(selector);
+  if (use_cut_flow_)
+    track_selector_->cutFlow().setActive(true, cut_flow_timing_);
 }
 
 void Reader::setTowerSelector(TowerSelector *selector) {
   tower_selector_ = unique_ptr<TowerSelector>(selector);
+  if (use_cut_flow_)
+    tower_selector_->cutFlow().setActive(true, cut_flow_timing_);
 }
 
 void Reader::clear() {
   pseudojets_.clear();
-  for (auto &c : had_corr_map_)
-    c.clear();
+  info_pool_.reset();
+  event_view_.clear();
+  for (unsigned tow_idx : tower_matches_.touched())
+    tower_matched_p_[tow_idx] = 0.0;
+  tower_matches_.clear();
 }
 
 EventStatus Reader::makeEvent() {
@@ -172,6 +434,7 @@ EventStatus Reader::makeEvent() {
   if (chain()->GetBranchStatus("Track"))
     if (!selectTracks())
       return EventStatus::rejectEvent;
+  tower_matches_.build();
   if (chain()->GetBranchStatus("BTowHit"))
     if (!selectTowers())
       return EventStatus::rejectEvent;
@@ -182,95 +445,476 @@ EventStatus Reader::makeEvent() {
 bool Reader::selectTracks() {
   bool event_status = true;
   TVector3 vertex = picoDst()->event()->primaryVertex();
-  for (int track_id = 0; track_id < picoDst()->numberOfTracks(); ++track_id) {
-    StPicoTrack *track = picoDst()->track(track_id);
-    TrackStatus track_status =
-        track_selector_->select(track, vertex, use_primary_tracks_);
-    if (track_status == TrackStatus::acceptTrack) {
-      pseudojets_.push_back(MakePseudoJet(*track, vertex, use_primary_tracks_));
-
-      // if we accept the track, then we will also use it for hadronic
-      // correction/MIPS if it has been matched to a tower
-      int match_tower_id = track->bemcTowerIndex();
-      if (match_tower_id >= 0) {
-        if (approx_track_tower_match_ || track->isBemcMatchedExact())
-          had_corr_map_[match_tower_id].push_back(track_id);
-      }
-
-    } else if (track_status == TrackStatus::rejectEvent) {
-      event_status = false;
+  int n_tracks = picoDst()->numberOfTracks();
+
+  // derived quantities are computed once per track, and reused for the
+  // selection, the event output and the hadronic correction
+  track_table_.clear();
+  track_table_.reserve(n_tracks);
+  if (track_tower_matching_ == TrackTowerMatching::grid)
+    track_tower_matcher_.setEvent(vertex.Z(), picoDst()->event()->bField());
+  for (int track_id = 0; track_id < n_tracks; ++track_id)
+    track_table_.add(*picoDst()->track(track_id), vertex, use_primary_tracks_);
+
+  // custom track selectors may override select(), so they are called one
+  // track at a time
+  if (typeid(*track_selector_) != typeid(TrackSelector)) {
+    for (int track_id = 0; track_id < n_tracks; ++track_id) {
+      StPicoTrack *track = picoDst()->track(track_id);
+      TrackStatus track_status =
+          track_selector_->select(track, vertex, use_primary_tracks_);
+      if (track_status == TrackStatus::acceptTrack)
+        acceptTrack(track_id, *track);
+      else if (track_status == TrackStatus::rejectEvent)
+        event_status = false;
     }
+    return event_status;
+  }
+
+  event_status = track_selector_->selectBatch(track_table_, use_primary_tracks_,
+                                              track_mask_);
+  for (int track_id = 0; track_id < n_tracks; ++track_id) {
+    if (track_mask_[track_id])
+      acceptTrack(track_id, *picoDst()->track(track_id));
   }
   return event_status;
 }
 
+void Reader::acceptTrack(int track_id, const StPicoTrack &track) {
+  track_table_.setKinematics(track_id, track, use_primary_tracks_);
+
+  // if we accept the track, then we will also use it for hadronic
+  // correction/MIPS if it has been matched to a tower. The matched tower is
+  // stored with the track, so it agrees with the tower's matched tracks
+  int match_tower_idx = track.bemcTowerIndex();
+  if (track_tower_matching_ == TrackTowerMatching::grid) {
+    match_tower_idx = track_tower_matcher_.match(
+        track_table_.pt()[track_id], track_table_.eta()[track_id],
+        track_table_.phi()[track_id], track.charge());
+    if (match_tower_idx >= 0)
+      tower_matches_.add(match_tower_idx, track_id);
+  } else if (match_tower_idx >= 0) {
+    if (approx_track_tower_match_ || track.isBemcMatchedExact())
+      tower_matches_.add(match_tower_idx, track_id);
+  }
+
+  if (event_output_ != EventOutput::eventView)
+    pseudojets_.push_back(MakePseudoJet(info_pool_, track, track_table_,
+                                        track_id, use_primary_tracks_,
+                                        match_tower_idx));
+  if (event_output_ != EventOutput::pseudoJets)
+    event_view_.addTrack(track, track_table_, track_id, use_primary_tracks_,
+                         match_tower_idx);
+}
+
+namespace {
+
+// the Select functors of the tower loop. Each selects a tower before its
+// energy is corrected, and again after. Batch functors select all corrected
+// towers at once with selectCorrected(), others are called again per tower
+
+// calls a TowerSelector through the virtual select(), for custom selectors
+struct VirtualTowerSelect {
+  static constexpr bool batch = false;
+  TowerStatus operator()(StPicoBTowHit &tower, unsigned id, double eta,
+                         double cosh_eta) const {
+    return selector->select(&tower, id, eta);
+  }
+  TowerSelector *selector;
+};
+
+// calls TowerSelector::select() with a precomputed cosh(eta), for the
+// default selector with expressions
+struct ExpressionTowerSelect {
+  static constexpr bool batch = false;
+  TowerStatus operator()(StPicoBTowHit &tower, unsigned id, double eta,
+                         double cosh_eta) const {
+    return selector->select(&tower, id, eta, cosh_eta);
+  }
+  TowerSelector *selector;
+};
+
+// the TowerSelector::Kernel for the active cuts of the default selector
+template <class Kernel> struct KernelTowerSelect {
+  static constexpr bool batch = true;
+  TowerStatus operator()(StPicoBTowHit &tower, unsigned id, double eta,
+                         double cosh_eta) const {
+    return kernel(tower, id, eta, cosh_eta);
+  }
+  void selectCorrected(const double *energy, const double *cosh_eta, size_t n,
+                       uint8_t *accept) const {
+    kernel.selectCorrected(energy, cosh_eta, n, accept);
+  }
+  Kernel kernel;
+};
+
+} // namespace
+
 bool Reader::selectTowers() {
-  int init_size = pseudojets_.size();
+  // towers at or below the floor can not be accepted by the default selector,
+  // so only the others are selected. It rejects towers below its ET min cut as
+  // well. A custom selector may reject the event on any tower, so it is passed
+  // every tower, as is the selector while counting the cut flow
+  double floor = -std::numeric_limits<double>::infinity();
+  if (typeid(*tower_selector_) == typeid(TowerSelector) &&
+      !tower_selector_->cutFlow().active())
+    floor = std::max(tower_energy_floor_, tower_selector_->energyFloor());
+
+  unsigned n_towers = picoDst()->numberOfBTowHits();
+  JETREADER_ASSERT(n_towers <= BemcHelper::TOWERS, "found ", n_towers,
+                   " BEMC towers, but the barrel only has ",
+                   BemcHelper::TOWERS);
+  tower_energy_.resize(n_towers);
+  tower_hits_.resize(n_towers);
+  for (unsigned tow_idx = 0; tow_idx < n_towers; ++tow_idx)
+    tower_energy_[tow_idx] = picoDst()->btowHit(tow_idx)->energy();
+  tower_hits_.resize(FindTowerHits(tower_energy_.data(), n_towers, floor,
+                                   tower_hits_.data()));
+
+  // custom tower selectors may override select(), so they are called through
+  // it. Expressions are not part of the Kernel. Otherwise, the tower loop is
+  // instantiated for the active cuts of the TowerSelector, which are resolved
+  // once per event instead of per tower
+  if (typeid(*tower_selector_) != typeid(TowerSelector))
+    return selectTowers(VirtualTowerSelect{tower_selector_.get()});
+  if (!tower_selector_->expressions().empty())
+    return selectTowers(ExpressionTowerSelect{tower_selector_.get()});
+
+  bool event_status = true;
+  tower_selector_->withKernel([&](const auto &kernel) {
+    event_status = selectTowers(KernelTowerSelect<decltype(kernel)>{kernel});
+  });
+  return event_status;
+}
+
+template <class Select> bool Reader::selectTowers(const Select &select) {
   bool event_status = true;
   TVector3 vertex = picoDst()->event()->primaryVertex();
-  for (unsigned tow_idx = 0; tow_idx < picoDst()->numberOfBTowHits();
-       ++tow_idx) {
+  tower_kinematics_.setVertex(vertex.Z());
+  const TowerKinematics &kinematics = tower_kinematics_;
+
+  // selection on the raw tower energies
+  accepted_towers_.clear();
+  for (unsigned tow_idx : tower_hits_) {
     StPicoBTowHit tower = *picoDst()->btowHit(tow_idx);
-    unsigned tower_id = tow_idx + 1;
-    double eta = bemc_helper_.towerEta(tower_id);
-    double phi = bemc_helper_.towerPhi(tower_id);
-    double corrected_eta =
-        bemc_helper_.vertexCorrectedEta(tower_id, vertex.Z());
     TowerStatus tower_status =
-        tower_selector_->select(&tower, tower_id, corrected_eta);
-    if (tower_status == TowerStatus::acceptTower) {
-      double e_corr = tower.energy();
-      if (use_had_corr_)
-        e_corr = towerHadronicCorrection(tow_idx);
-      else if (use_mip_corr_)
-        e_corr = towerMIPCorrection(tow_idx, eta);
-      // check if corrected ET is still valid
-      tower.setEnergy(e_corr);
-      if (e_corr > 0.0 &&
-          tower_selector_->select(&tower, tower_id, corrected_eta) ==
-              TowerStatus::acceptTower) {
-        pseudojets_.push_back(MakePseudoJet(tower, tower_id, eta, phi,
-                                            corrected_eta, e_corr,
-                                            had_corr_map_[tow_idx]));
-      }
-    } else if (tower_status == TowerStatus::rejectEvent) {
+        select(tower, tow_idx + 1, kinematics.correctedEta(tow_idx),
+               kinematics.coshEta(tow_idx));
+    if (tower_status == TowerStatus::acceptTower)
+      accepted_towers_.push_back(tow_idx);
+    else if (tower_status == TowerStatus::rejectEvent)
       event_status = false;
+  }
+
+  // the accepted towers are corrected all at once, and selected again to
+  // check that their corrected ET is still valid. They were already counted
+  // in the cut flow before correction
+  correctTowers();
+  size_t n = accepted_towers_.size();
+  {
+    CutFlow::Pause pause(tower_selector_->cutFlow());
+    if constexpr (Select::batch) {
+      select.selectCorrected(corrected_stored_e_.data(),
+                             corrected_cosh_eta_.data(), n,
+                             corrected_accept_.data());
+    } else {
+      for (size_t i = 0; i < n; ++i) {
+        unsigned tow_idx = accepted_towers_[i];
+        if (corrected_accept_[i])
+          corrected_accept_[i] =
+              select(corrected_towers_[i], tow_idx + 1,
+                     kinematics.correctedEta(tow_idx),
+                     kinematics.coshEta(tow_idx)) == TowerStatus::acceptTower;
+      }
     }
   }
+
+  for (size_t i = 0; i < n; ++i) {
+    if (!corrected_accept_[i])
+      continue;
+    unsigned tow_idx = accepted_towers_[i];
+    const StPicoBTowHit &tower = corrected_towers_[i];
+    double e_corr = corrected_e_[i];
+    if (event_output_ != EventOutput::eventView)
+      pseudojets_.push_back(MakePseudoJet(info_pool_, tower, tow_idx + 1,
+                                          kinematics, e_corr,
+                                          tower_matches_.tracks(tow_idx)));
+    if (event_output_ != EventOutput::pseudoJets)
+      event_view_.addTower(tower, tow_idx + 1, kinematics, e_corr,
+                           tower_matches_.tracks(tow_idx));
+  }
   return event_status;
 }
 
-double Reader::towerMIPCorrection(unsigned tow_idx, double tow_eta) {
-  // copied from TStarJetPicoReader - has a note saying it may be 0.264
-  // instead of 0.261. MIP value taken from spin group nick: as its written
-  // its using eta - shouldn't it be using corrected eta?
+void Reader::correctTowers() {
+  size_t n = accepted_towers_.size();
+  const unsigned *tow_idx = accepted_towers_.data();
+  const float *energy = tower_energy_.data();
+  corrected_e_.resize(n);
+
+  // each correction is one loop over the accepted towers, without branches
+  if (use_had_corr_) {
+    // hadronic correction subtracts had_corr_fraction_ percent of the total
+    // momentum of each track that points to a tower from that tower's energy.
+    // Deciding what tracks point to which towers is done during creation of
+    // the StPicoDsts by extrapolating the track helix from the TPC into the
+    // barrel. tower_matches_ only holds accepted tracks, so their total
+    // momentum has already been cached in track_table_ by acceptTrack()
+    const std::vector<double> &p = track_table_.p();
+    for (unsigned tower : tower_matches_.touched()) {
+      double sum = 0.0;
+      for (unsigned track_idx : tower_matches_.tracks(tower))
+        sum += p[track_idx];
+      tower_matched_p_[tower] = sum;
+    }
+    const double *matched_p = tower_matched_p_.data();
+    for (size_t i = 0; i < n; ++i)
+      corrected_e_[i] =
+          energy[tow_idx[i]] - matched_p[tow_idx[i]] * had_corr_fraction_;
+  } else if (use_mip_corr_) {
+    // one MIP energy is subtracted for each matched track
+    const unsigned char *ring =
+        tower_kinematics_.bemcHelper().towerEtaRings().data();
+    for (size_t i = 0; i < n; ++i)
+      corrected_e_[i] = energy[tow_idx[i]] -
+                        tower_matches_.count(tow_idx[i]) *
+                            ring_mip_e_[ring[tow_idx[i]]];
+  } else {
+    for (size_t i = 0; i < n; ++i)
+      corrected_e_[i] = energy[tow_idx[i]];
+  }
 
-  double tow_energy = picoDst()->btowHit(tow_idx)->energy();
-  double theta = 2.0 * atan(exp(tow_eta));
-  double mip_e = 0.261 * (1. + 0.056 * pow(tow_eta, 2.0)) / sin(theta); // GeV
-  int n_tracks = had_corr_map_[tow_idx].size();
-  double corrected_e = tow_energy - n_tracks * mip_e;
-  return corrected_e;
+  // the corrected towers are selected with the corrected energy as stored in
+  // a StPicoBTowHit, and are only accepted if it is positive
+  corrected_towers_.resize(n);
+  corrected_stored_e_.resize(n);
+  corrected_cosh_eta_.resize(n);
+  corrected_accept_.resize(n);
+  for (size_t i = 0; i < n; ++i) {
+    corrected_towers_[i] = *picoDst()->btowHit(tow_idx[i]);
+    corrected_towers_[i].setEnergy(corrected_e_[i]);
+    corrected_stored_e_[i] = corrected_towers_[i].energy();
+    corrected_cosh_eta_[i] = tower_kinematics_.coshEta(tow_idx[i]);
+    corrected_accept_[i] = corrected_e_[i] > 0.0;
+  }
 }
 
-double Reader::towerHadronicCorrection(unsigned tow_idx) {
-  // hadronic correction subtracts had_corr_fraction_ percent of the total
-  // momentum of each track that points to a tower from that tower's energy.
-  // Deciding what tracks point to which towers is done during creation of the
-  // StPicoDsts by extrapolating the track helix from the TPC into the barrel.
+void Reader::startPrefetch() {
+  if (chain() == nullptr)
+    JETREADER_THROW("No input file loaded: next() failed");
+
+  prefetch_queue_ = make_unique<BoundedQueue<ProcessedEvent>>(prefetch_depth_);
+  // holds every event that can be in flight: the queued events, the user's
+  // current event and the one being filled
+  prefetch_free_ =
+      make_unique<BoundedQueue<ProcessedEvent>>(prefetch_depth_ + 2);
+  prefetch_thread_ = std::thread(&Reader::prefetchEvents, this);
+}
 
-  double corrected_e = picoDst()->btowHit(tow_idx)->energy();
-  for (auto &track_idx : had_corr_map_[tow_idx]) {
-    StPicoTrack *track = picoDst()->track(track_idx);
-    if (use_primary_tracks_)
-      corrected_e -= track->pPtot() * had_corr_fraction_;
-    else
-      corrected_e -= track->gPtot() * had_corr_fraction_;
+void Reader::stopPrefetch() {
+  if (prefetch_queue_ != nullptr)
+    prefetch_queue_->close();
+  if (prefetch_thread_.joinable())
+    prefetch_thread_.join();
+}
+
+void Reader::prefetchEvents() {
+  try {
+    ProcessedEvent event;
+    while (nextEvent()) {
+      // reuse an event the user is done with, if there is one
+      prefetch_free_->tryPop(event);
+      event.fill(*this);
+      // push fails if the queue was closed by stopPrefetch()
+      if (!prefetch_queue_->push(std::move(event)))
+        break;
+    }
+  } catch (...) {
+    prefetch_error_ = std::current_exception();
   }
-  return corrected_e;
+  prefetch_queue_->close();
 }
 
 bool Reader::findNextGoodRun() {
+  auto branch_status = readEventBranchOnly();
+
+  bool found_good_run = false;
+  int64_t first_event = index_;
+  int64_t current_event = index_;
+  int64_t last_event = lastEntry();
+  {
+    // the scanned events are counted in the cut flow below: the current event
+    // was already counted, and the first event of a good run is counted when
+    // it is read by readEvent()
+    CutFlow::Pause pause(event_selector_->cutFlow());
+    EventStatus event_status = event_selector_->select(picoDst()->event());
+
+    // scan forward until we find a new run, or we reach the end of the entry
+    // range
+    while (event_status == EventStatus::rejectRun &&
+           current_event < last_event) {
+      // attempt to load next entry
+      ++current_event;
+
+      int load_status = chain()->GetEntry(current_event);
+      JETREADER_ASSERT(load_status > 0, "Failure attempting to load event ",
+                       current_event, " in the chain, returned status ",
+                       load_status);
+      event_status = event_selector_->select(picoDst()->event());
+    }
+    found_good_run = event_status != EventStatus::rejectRun;
+  }
+
+  // put branches back to their original state. If we found a good run, its
+  // first event will be fully loaded by the next readEvent()
+  restoreBranchStatus(branch_status);
+  index_ = found_good_run ? current_event - 1 : current_event;
+
+  countSkippedEntries(index_ - first_event);
+  return found_good_run;
+}
+
+void Reader::countSkippedEntries(int64_t n) {
+  CutFlow &flow = event_selector_->cutFlow();
+  flow.record(flow.index("badRuns"), n, 0);
+  flow.count(n, 0);
+}
+
+void Reader::pruneUnusedBranches() {
+  // the event header is needed for event selection, tracks for track
+  // pseudojets and tower corrections, and tower hits for tower pseudojets
+  std::set<std::string> used{"Event", "Track", "BTowHit"};
+  used.insert(kept_branches_.begin(), kept_branches_.end());
+
+  // only branches that are on are touched: branches turned off by the user
+  // stay off, and ROOT complains about branches missing from the tree
+  for (auto &branch : activeBranches())
+    if (used.count(branch) == 0)
+      chain()->SetBranchStatus(branch.c_str(), 0);
+}
+
+void Reader::buildChain() {
+  std::vector<std::string> files = ChainMetadata::ReadFileList(input_file_);
+  if (!use_chain_metadata_) {
+    // every file is checked when it is added, like StPicoDstReader does
+    for (auto &file : files) {
+      unique_ptr<TFile> tmp(TFile::Open(file.c_str()));
+      if (tmp && !tmp->IsZombie() && tmp->GetNkeys())
+        chain()->Add(file.c_str());
+    }
+    return;
+  }
+
+  std::string filename = chain_metadata_file_.empty()
+                             ? input_file_ + ".chainmeta"
+                             : chain_metadata_file_;
+  ChainMetadata cached;
+  bool loaded = cached.load(filename);
+  if (loaded && cached.matches(files)) {
+    chain_metadata_ = std::move(cached);
+  } else {
+    chain_metadata_.build(files, chain_metadata_threads_,
+                          loaded ? &cached : nullptr);
+    if (!chain_metadata_.save(filename))
+      std::cerr << "could not save chain metadata to " << filename
+                << ", it will be rebuilt next time" << std::endl;
+  }
+
+  // with a known number of entries, TChain does not open the file until it is
+  // needed
+  for (auto &info : chain_metadata_.files()) {
+    if (info.good && info.fingerprint.entries > 0)
+      chain()->Add(info.filename.c_str(), info.fingerprint.entries);
+  }
+  chain_entries_ = chain_metadata_.entries();
+}
+
+FileFingerprint Reader::inputFingerprint() {
+  FileFingerprint fingerprint;
+  if (!ChainMetadata::IsFileList(input_file_)) {
+    JETREADER_ASSERT(FileFingerprint::Make(input_file_, entries(), fingerprint),
+                     "can not find input file ", input_file_);
+    return fingerprint;
+  }
+
+  // for a file list, the member files are fingerprinted rather than the list.
+  // The chain metadata already has them, otherwise they are looked up here -
+  // files that can't be found are left out of the chain, and have an empty
+  // fingerprint
+  std::vector<std::string> files;
+  std::vector<FileFingerprint> members;
+  if (use_chain_metadata_) {
+    for (auto &info : chain_metadata_.files()) {
+      files.push_back(info.filename);
+      members.push_back(info.fingerprint);
+    }
+  } else {
+    files = ChainMetadata::ReadFileList(input_file_);
+    members.resize(files.size());
+    for (size_t i = 0; i < files.size(); ++i)
+      FileFingerprint::Make(files[i], 0, members[i]);
+  }
+  return FileFingerprint::Combine(files, members, entries());
+}
+
+void Reader::loadRunIndex() {
+  std::string filename =
+      run_index_file_.empty() ? input_file_ + ".runindex" : run_index_file_;
+  int64_t entries = this->entries();
+  FileFingerprint fingerprint = inputFingerprint();
+  if (run_index_.load(filename, fingerprint))
+    return;
+
+  auto branch_status = readEventBranchOnly();
+  for (int64_t entry = 0; entry < entries; ++entry) {
+    int load_status = chain()->GetEntry(entry);
+    JETREADER_ASSERT(load_status > 0, "Failure attempting to load event ",
+                     entry, " in the chain, returned status ", load_status);
+    run_index_.add(picoDst()->event()->runId());
+  }
+  restoreBranchStatus(branch_status);
+
+  if (!run_index_.save(filename, fingerprint))
+    std::cerr << "could not save run index to " << filename
+              << ", it will be rebuilt next time" << std::endl;
+}
+
+void Reader::useEventHeaderCache(bool flag, const std::string &cache_file) {
+  use_header_cache_ = flag;
+  header_cache_file_ = cache_file;
+  if (!use_header_cache_)
+    header_cache_.clear();
+}
+
+void Reader::loadEventHeaderCache() {
+  std::string filename = header_cache_file_.empty()
+                             ? input_file_ + ".hdrcache"
+                             : header_cache_file_;
+  int64_t entries = this->entries();
+  FileFingerprint fingerprint = inputFingerprint();
+  if (header_cache_.load(filename, fingerprint))
+    return;
+
+  auto branch_status = readEventBranchOnly();
+  for (int64_t entry = 0; entry < entries; ++entry) {
+    int load_status = chain()->GetEntry(entry);
+    JETREADER_ASSERT(load_status > 0, "Failure attempting to load event ",
+                     entry, " in the chain, returned status ", load_status);
+    header_cache_.add(*picoDst()->event());
+  }
+  restoreBranchStatus(branch_status);
+
+  if (!header_cache_.save(filename, fingerprint))
+    std::cerr << "could not save event header cache to " << filename
+              << ", it will be rebuilt next time" << std::endl;
+}
+
+EventStatus Reader::preselectEvent(int64_t idx) {
+  header_cache_.fill(idx, cached_event_);
+  return event_selector_->select(&cached_event_);
+}
+
+std::vector<std::pair<std::string, int>> Reader::readEventBranchOnly() {
   std::vector<std::pair<std::string, int>> status_map;
 
   for (int i = 0; i < StPicoArrays::NAllPicoArrays; ++i) {
@@ -286,37 +930,20 @@ bool Reader::findNextGoodRun() {
       chain()->SetBranchStatus(branchname.c_str(), 1);
     }
   }
+  return status_map;
+}
 
-  bool found_good_run = false;
-  int current_event = index_;
-  EventStatus event_status = event_selector_->select(picoDst()->event());
-
-  while (event_status == EventStatus::rejectRun) {
-    // attempt to load next entry
-    ++current_event;
-
-    int load_status = chain()->GetEntry(current_event);
-    JETREADER_ASSERT(load_status > 0, "Failure attempting to load event ",
-                     current_event, " in the chain, returned status ",
-                     load_status);
-    event_status = event_selector_->select(picoDst()->event());
-
-    if (event_status != EventStatus::rejectRun) {
-      found_good_run = true;
-      break;
-    }
-
-    // check if we're at the end of the chain - if so, break
-    if (current_event >= chain()->GetEntries() - 1)
-      break;
-  }
-
-  // put branches back to their original state and reload the current event
-  for (auto &branch : status_map)
+void Reader::restoreBranchStatus(
+    const std::vector<std::pair<std::string, int>> &status) {
+  for (auto &branch : status)
     chain()->SetBranchStatus(branch.first.c_str(), branch.second);
-  readEvent(current_event);
+}
 
-  return found_good_run;
+int64_t Reader::lastEntry() {
+  int64_t chain_entries = entries();
+  if (entry_end_ < 0 || entry_end_ > chain_entries)
+    return chain_entries - 1;
+  return entry_end_ - 1;
 }
 
 } // namespace jetreader
\ No newline at end of file
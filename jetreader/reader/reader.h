@@ -1,16 +1,31 @@
 #ifndef JETREADER_READER_READER_H
 #define JETREADER_READER_READER_H
 
+#include "jetreader/lib/bounded_queue.h"
 #include "jetreader/lib/memory.h"
 #include "jetreader/reader/bemc_helper.h"
 #include "jetreader/reader/centrality.h"
+#include "jetreader/reader/chain_metadata.h"
 #include "jetreader/reader/config/config_manager.h"
+#include "jetreader/reader/event_header_cache.h"
 #include "jetreader/reader/event_selector.h"
+#include "jetreader/reader/event_view.h"
+#include "jetreader/reader/processed_event.h"
+#include "jetreader/reader/run_index.h"
+#include "jetreader/reader/tower_kinematics.h"
+#include "jetreader/reader/tower_matches.h"
 #include "jetreader/reader/tower_selector.h"
 #include "jetreader/reader/track_selector.h"
+#include "jetreader/reader/track_table.h"
+#include "jetreader/reader/track_tower_matcher.h"
+#include "jetreader/reader/vector_info_pool.h"
 #include "jetreader/reader/vector_info.h"
 
+#include <exception>
+#include <set>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include "StPicoEvent/StPicoDstReader.h"
@@ -21,9 +36,19 @@ namespace jetreader {
 
 class ReaderConfigHelper;
 
+// selected tracks and towers can be output as PseudoJets, as an EventView, or
+// both
+enum class EventOutput { pseudoJets, eventView, both };
+
+// tracks are matched to towers for the hadronic and MIP corrections either by
+// the tower index stored in the StPicoTrack, or by projecting the track to the
+// barrel with a TrackTowerMatcher
+enum class TrackTowerMatching { picoDst, grid };
+
 class Reader : public StPicoDstReader {
 public:
   friend class ReaderConfigHelper;
+  friend struct ProcessedEvent;
 
   // Reader initialization requires an input file name, and an optional
   // configuration file. The input file can be either a ROOT file containing a
@@ -42,6 +67,27 @@ public:
   // reader and its selectors.
   void writeConfig(const std::string &yaml_filename);
 
+  // the config written by writeConfig(), as a YAML string
+  std::string configString() { return manager_.configString(); }
+
+  // Turns on cut-flow counting in the event, track and tower selectors (see
+  // CutFlow): the number of events, tracks and towers tested and passed by
+  // each cut. With timing, the time spent in each cut is measured as well.
+  // Events of bad runs skipped by next() are counted as failing the bad run
+  // cut. Applies to selectors set later with setEventSelector() etc. as well.
+  // While prefetching, the counts must only be read once next() has returned
+  // false.
+  void useCutFlow(bool flag, bool timing = false);
+  bool cutFlowActive() const { return use_cut_flow_; }
+  bool cutFlowTiming() const { return cut_flow_timing_; }
+
+  // the cut flows of the event, track and tower selectors, as a table or as
+  // YAML. writeCutFlow() writes the YAML to a file, in the same layout as
+  // writeConfig()
+  std::string cutFlowTable();
+  std::string cutFlowString() { return manager_.cutFlowString(); }
+  void writeCutFlow(const std::string &yaml_filename);
+
   // Reads until the next event that satisfies event selection criteria is
   // found, or the end of the chain is reached. Returns false when it reaches
   // the end of the chain, or if there is an error during loading.
@@ -51,14 +97,79 @@ public:
   // criteria. If loading is successful and event passes event cuts,  returns
   // EventStatus::acceptEvent. If the event does not pass event selection,
   // returns EventStatus:rejectEvent. If there is an io error, returns
-  // EventStatus::ioFailure
+  // EventStatus::ioFailure. Not available when prefetching is turned on.
   EventStatus readEvent(size_t idx);
 
+  // Turns on asynchronous prefetching for next(): a background thread reads and
+  // selects up to depth events ahead of the current event, while the user
+  // works on the current event. A depth of zero (the default) turns
+  // prefetching off. Must be called before the first call to next(). While
+  // prefetching, the StPicoDst belongs to the background thread - the current
+  // event must be accessed through event(), pseudojets(), currentEntry(),
+  // centrality16() and centrality9(), and readEvent() can not be used.
+  void usePrefetch(unsigned depth);
+  unsigned prefetchDepth() const { return prefetch_depth_; }
+
+  // header of the current event. Unlike picoDst()->event(), this is also valid
+  // when prefetching is turned on
+  StPicoEvent *event();
+
   // Initializes event, track and tower selectors and the reader. Must be called
   // before next() or readEvent(). If initialization fails, an exception is
   // raised.
   void init();
 
+  // By default, init() turns off every picoDst branch that the reader does not
+  // need to build events: only Event, Track and BTowHit are kept. Tracks or
+  // towers can still be turned off entirely with SetStatus() before init().
+  // Branches that are read directly through picoDst() by the user must be
+  // kept with keepBranch(), or pruning can be turned off. Must be called before
+  // init().
+  void pruneBranches(bool flag) { prune_branches_ = flag; }
+  bool branchPruning() const { return prune_branches_; }
+  void keepBranch(const std::string &branch) { kept_branches_.insert(branch); }
+
+  // names of the branches that are currently read from the chain
+  std::vector<std::string> activeBranches();
+
+  // Turns on the run index (see RunIndex), which lets next() skip a run
+  // rejected by the event selector in one step, without reading any more of
+  // its events. During init(), the index is loaded from index_file if it was
+  // built from the same input (same number of entries, and same size and
+  // modification time of the input file, or of every file in a file list),
+  // otherwise it is built by scanning the run ID of every event and saved to
+  // index_file. By default, index_file is the input file name with
+  // ".runindex" appended. Must be called before init().
+  void useRunIndex(bool flag, const std::string &index_file = "");
+  bool runIndexActive() const { return use_run_index_; }
+  const RunIndex &runIndex() const { return run_index_; }
+
+  // Turns on the event header cache (see EventHeaderCache). next() evaluates
+  // the event cuts on the cached header of each entry first, and only reads
+  // entries from the chain that pass. During init(), the cache is loaded from
+  // cache_file if it was built from the same input (as for the run index),
+  // otherwise it is built by scanning the Event branch and saved to
+  // cache_file. By default, cache_file is the input file name with ".hdrcache"
+  // appended. Pre-selection is skipped when a custom EventSelector is used,
+  // since it may depend on quantities that are not cached. Must be called
+  // before init().
+  void useEventHeaderCache(bool flag, const std::string &cache_file = "");
+  bool eventHeaderCacheActive() const { return use_header_cache_; }
+  const EventHeaderCache &eventHeaderCache() const { return header_cache_; }
+
+  // Turns on the chain metadata cache for file list inputs (see
+  // ChainMetadata). During init(), the number of entries and run IDs of every
+  // file in the list are loaded from cache_file. Files that are new or have
+  // changed since are opened, up to threads at a time (0 uses one thread per
+  // core), and the cache is saved again. The chain is then set up without
+  // opening any file: each file is only opened when next() reaches it. By
+  // default, cache_file is the input file name with ".chainmeta" appended. Has
+  // no effect for a single picoDst file. Must be called before init().
+  void useChainMetadata(bool flag, const std::string &cache_file = "",
+                        unsigned threads = 0);
+  bool chainMetadataActive() const { return use_chain_metadata_; }
+  const ChainMetadata &chainMetadata() const { return chain_metadata_; }
+
   // Switch between primary and global tracks. Primary tracks are the default
   void usePrimaryTracks() { use_primary_tracks_ = true; }
   void useGlobalTracks() { use_primary_tracks_ = false; }
@@ -87,10 +198,59 @@ public:
     return approx_track_tower_match_;
   }
 
+  // selects how accepted tracks are matched to towers. With
+  // TrackTowerMatching::grid, each track is projected along its helix to the
+  // barrel and matched to the nearest tower within the match distance, see
+  // TrackTowerMatcher. This also matches tracks without a stored tower index,
+  // and ignores useApproximateTrackTowerMatching(). Default
+  // TrackTowerMatching::picoDst
+  void setTrackTowerMatching(TrackTowerMatching matching) {
+    track_tower_matching_ = matching;
+  }
+  TrackTowerMatching trackTowerMatching() const {
+    return track_tower_matching_;
+  }
+  void setTrackTowerMatchDistance(double distance) {
+    track_tower_matcher_.setMaxDistance(distance);
+  }
+  double trackTowerMatchDistance() const {
+    return track_tower_matcher_.maxDistance();
+  }
+
+  // with the default TowerSelector, towers with an energy at or below the
+  // floor are skipped before selection: they are rejected without being
+  // passed to the selector, corrected or converted. Corrections only lower the
+  // tower energy (for a hadronic correction fraction >= 0), so with the
+  // default floor of zero the output is the same as without it. The floor is
+  // raised to the selector's ET min cut. Custom tower selectors, which may
+  // reject the event on any tower, are passed every tower, as is the default
+  // selector while the cut flow is counted
+  void setTowerEnergyFloor(double floor) { tower_energy_floor_ = floor; }
+  double towerEnergyFloor() const { return tower_energy_floor_; }
+
   // processes the event and returns a list of selected tracks and towers, which
-  // have been converted into PseudoJets
+  // have been converted into PseudoJets. If the output is
+  // EventOutput::eventView only, the PseudoJets are converted from the
+  // EventView on the first call for each event
   std::vector<fastjet::PseudoJet> &pseudojets();
 
+  // the pool of VectorInfos attached to pseudojets(), which are reused between
+  // events. When prefetching, each event carries its own pool, which is reused
+  // once the event is handed back by the next call to next()
+  const VectorInfoPool &vectorInfoPool() const {
+    return prefetch_depth_ ? current_event_.pool : info_pool_;
+  }
+
+  // chooses how selected tracks and towers are stored for each event: as
+  // PseudoJets (the default), as a structure-of-arrays EventView, or both.
+  // Both are filled in the same pass over the tracks and towers
+  void setEventOutput(EventOutput output) { event_output_ = output; }
+  EventOutput eventOutput() const { return event_output_; }
+
+  // the selected tracks and towers of the current event as an EventView. Empty
+  // unless the output includes EventOutput::eventView
+  EventView &eventView();
+
   // returns the StRefMultCorr-compatible centrality implementation of the
   // reader. Before centrality9() or centrality16() can be used, the user must
   // call reader.centrality().loadCentralityDef(id) with the proper CentDefId
@@ -103,8 +263,19 @@ public:
   // -1 = the event is not valid for the given definition, either due to run id,
   // vz, luminosity, etc, or no centrality definition has been loaded
   // 16 (or 9) = the event is in the 80-100% centrality bin
-  int centrality16() { return centrality_.centrality16(); }
-  int centrality9() { return centrality_.centrality9(); }
+  int centrality16() {
+    return prefetch_depth_ ? current_event_.centrality16
+                           : centrality_.centrality16();
+  }
+  int centrality9() {
+    return prefetch_depth_ ? current_event_.centrality9
+                           : centrality_.centrality9();
+  }
+
+  // corrected refmult and weight of the current event. If the event is not
+  // valid for the centrality definition, these are refmult and 1.0
+  double refMultCorr();
+  double centralityWeight();
 
   // direct access to event, track and tower selectors
   EventSelector *eventSelector() { return event_selector_.get(); }
@@ -118,14 +289,45 @@ public:
   void setTrackSelector(TrackSelector *selector);
   void setTowerSelector(TowerSelector *selector);
 
-  int64_t currentEntry() { return chain()->GetReadEntry(); }
-  int64_t entries() { return chain()->GetEntries(); }
+  int64_t currentEntry() {
+    return prefetch_depth_ ? current_event_.entry : chain()->GetReadEntry();
+  }
+  // number of entries in the chain. After init(), this does not require
+  // opening the files of the chain
+  int64_t entries() {
+    return chain_entries_ >= 0 ? chain_entries_ : chain()->GetEntries();
+  }
+
+  // restricts next() to the entries [begin, end) of the chain. An end of -1
+  // reads until the end of the chain. readEvent() is not restricted. This is
+  // used by the ParallelReader to give each worker a disjoint set of entries.
+  void setEntryRange(int64_t begin, int64_t end = -1);
+  int64_t entryRangeBegin() const { return entry_begin_; }
+  int64_t entryRangeEnd() const { return entry_end_; }
+
+  // restricts next() to shard index of count contiguous entry ranges of
+  // balanced cost (see ShardPlanner), for splitting a chain between batch
+  // jobs. When the run index is used, entries in runs rejected by the event
+  // selector are counted as cheap. The entry range is computed during init(),
+  // or immediately if init() has already been called.
+  void setShard(unsigned index, unsigned count);
 
 private:
   // used when reading a new event to clear state from previous
   // event
   void clear();
 
+  // implementations of next() and readEvent() on the thread that owns the
+  // StPicoDst
+  bool nextEvent();
+  EventStatus loadEvent(size_t idx);
+
+  // start and stop the prefetching thread. prefetchEvents() is the loop run by
+  // the prefetching thread
+  void startPrefetch();
+  void stopPrefetch();
+  void prefetchEvents();
+
   // called by next() and readEvent() to process tracks and towers into
   // pseudojets. Returning failure indicates that the event should not be used
   // when calling next()
@@ -136,25 +338,109 @@ private:
   bool selectTracks();
   bool selectTowers();
 
-  // tower E correction schemes - either MIP or hadronic correction
-  double towerMIPCorrection(unsigned tow_idx, double tow_eta);
-  double towerHadronicCorrection(unsigned tow_idx);
+  // the tower loop of selectTowers(), with select(tower, id, eta, cosh_eta)
+  // used in place of TowerSelector::select()
+  template <class Select> bool selectTowers(const Select &select);
+
+  // adds an accepted track to the event output, and to the tower matches
+  // used by the corrections. Kinematics are taken from track_table_
+  void acceptTrack(int track_id, const StPicoTrack &track);
+
+  // tower E correction schemes - either MIP or hadronic correction. Fills
+  // the corrected_* vectors for all towers in accepted_towers_ at once
+  void correctTowers();
 
   // used to speed-up reading through consecutive events in bad runs which won't
   // be processed. Disables large branches such as tracks and towers and scans
   // each event runID without processing the full event. Returns true if a new
-  // run is found, returns false at the end of the chain.
+  // run is found, in which case the first event of that run is the next event
+  // to be read by next(). Returns false at the end of the entry range.
   bool findNextGoodRun();
 
+  // counts n entries of bad runs that next() skipped without selecting them in
+  // the event selector's cut flow
+  void countSkippedEntries(int64_t n);
+
+  // last entry that next() is allowed to load
+  int64_t lastEntry();
+
+  // turns off all branches not needed by the reader or kept by the user
+  void pruneUnusedBranches();
+
+  // adds the files of a file list input to the chain - lazily, using the
+  // chain metadata, if it is turned on
+  void buildChain();
+
+  // loads the run index from its file, or builds and saves it
+  void loadRunIndex();
+
+  // fingerprint of the input, used to check that a saved run index or header
+  // cache was built from the current input. For a file list, it covers the
+  // member files
+  FileFingerprint inputFingerprint();
+
+  // sets the entry range of the shard selected with setShard()
+  void applyShard();
+
+  // loads the event header cache from its file, or builds and saves it
+  void loadEventHeaderCache();
+
+  // evaluates the event selection on the cached header of entry idx
+  EventStatus preselectEvent(int64_t idx);
+
+  // turns off every branch except for Event, to quickly scan run IDs. Returns
+  // the previous status of every branch, to be passed to
+  // restoreBranchStatus()
+  std::vector<std::pair<std::string, int>> readEventBranchOnly();
+  void restoreBranchStatus(
+      const std::vector<std::pair<std::string, int>> &status);
+
+  std::string input_file_;
+  // number of entries in the chain, once known
+  int64_t chain_entries_;
+
   int64_t index_;
+  int64_t entry_begin_;
+  int64_t entry_end_;
+
+  unsigned shard_index_;
+  unsigned shard_count_;
 
   bool use_primary_tracks_;
 
+  bool use_cut_flow_;
+  bool cut_flow_timing_;
+
   bool use_had_corr_;
   double had_corr_fraction_;
-  std::vector<std::vector<unsigned>> had_corr_map_;
+  // accepted tracks matched to each tower, for the corrections
+  TowerMatches tower_matches_;
   bool use_mip_corr_;
   bool approx_track_tower_match_;
+  TrackTowerMatching track_tower_matching_;
+  TrackTowerMatcher track_tower_matcher_;
+  double tower_energy_floor_;
+
+  // per-event energies of all towers, and indices of the towers above the
+  // energy floor, filled by selectTowers()
+  std::vector<float> tower_energy_;
+  std::vector<unsigned> tower_hits_;
+
+  // indices of the towers accepted before correction, and for each of them a
+  // copy of the tower with its corrected energy, the corrected energy before
+  // and after it is stored in the tower, cosh(eta) and whether the tower is
+  // still accepted after correction. Filled by selectTowers()
+  std::vector<unsigned> accepted_towers_;
+  std::vector<StPicoBTowHit> corrected_towers_;
+  std::vector<double> corrected_e_;
+  std::vector<double> corrected_stored_e_;
+  std::vector<double> corrected_cosh_eta_;
+  std::vector<uint8_t> corrected_accept_;
+  // total momentum of the tracks matched to each tower, zero for towers
+  // without matches
+  std::vector<double> tower_matched_p_;
+  // energy deposited by a MIP in a tower of each eta ring
+  std::vector<double> ring_mip_e_;
 
   ConfigManager manager_;
 
@@ -164,9 +450,46 @@ private:
   unique_ptr<TrackSelector> track_selector_;
   unique_ptr<TowerSelector> tower_selector_;
 
-  BemcHelper bemc_helper_;
+  // per-event track kinematics, filled once by selectTracks() and shared by
+  // TrackSelector::selectBatch(), the event output and the hadronic correction
+  TrackTable track_table_;
+  std::vector<uint8_t> track_mask_;
+
+  // per-event vertex corrected tower eta, computed once per eta ring by
+  // selectTowers()
+  TowerKinematics tower_kinematics_;
+
+  bool prune_branches_;
+  std::set<std::string> kept_branches_;
+
+  bool use_run_index_;
+  std::string run_index_file_;
+  RunIndex run_index_;
+
+  bool use_chain_metadata_;
+  std::string chain_metadata_file_;
+  unsigned chain_metadata_threads_;
+  ChainMetadata chain_metadata_;
+
+  bool use_header_cache_;
+  std::string header_cache_file_;
+  EventHeaderCache header_cache_;
+  // filled from header_cache_ for preselectEvent()
+  StPicoEvent cached_event_;
 
+  EventOutput event_output_;
   std::vector<fastjet::PseudoJet> pseudojets_;
+  // storage for the user info of pseudojets_, reused between events
+  VectorInfoPool info_pool_;
+  EventView event_view_;
+
+  unsigned prefetch_depth_;
+  std::thread prefetch_thread_;
+  unique_ptr<BoundedQueue<ProcessedEvent>> prefetch_queue_;
+  // events returned by the user, refilled by the prefetching thread
+  unique_ptr<BoundedQueue<ProcessedEvent>> prefetch_free_;
+  std::exception_ptr prefetch_error_;
+  ProcessedEvent current_event_;
 };
 
 } // namespace jetreader
@@ -0,0 +1,185 @@
+#include "gtest/gtest.h"
+
+#include "jetreader/lib/test_data.h"
+#include "jetreader/reader/event_selector.h"
+#include "jetreader/reader/reader.h"
+#include "jetreader/reader/reader_utils.h"
+#include "jetreader/reader/vector_info_pool.h"
+
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "fastjet/PseudoJet.hh"
+
+#include "StPicoEvent/StPicoBTowHit.h"
+#include "StPicoEvent/StPicoEvent.h"
+#include "StPicoEvent/StPicoTrack.h"
+
+#include "TVector3.h"
+
+// every heap allocation goes through the replaced global operator new below,
+// which is why this test is built as its own executable, and is not part of
+// jetreader_gtest_main
+
+namespace {
+
+// allocations are only counted on a thread while an AllocationCounter is alive
+thread_local bool counting = false;
+thread_local size_t allocations = 0;
+
+class AllocationCounter {
+public:
+  AllocationCounter() : start_(allocations) { counting = true; }
+  ~AllocationCounter() { counting = false; }
+
+  // allocations since construction, or since the last restart()
+  size_t count() const { return allocations - start_; }
+  void restart() { start_ = allocations; }
+
+private:
+  size_t start_;
+};
+
+} // namespace
+
+void *operator new(std::size_t size) {
+  if (counting)
+    ++allocations;
+  if (void *ptr = std::malloc(size ? size : 1))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size) { return operator new(size); }
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, std::size_t) noexcept { std::free(ptr); }
+
+namespace {
+
+// a synthetic event, built the same way the Reader builds pseudojets
+struct TestEvent {
+  TestEvent() : tracks(500), towers(300), matched(300) {
+    for (unsigned i = 0; i < tracks.size(); ++i) {
+      tracks[i].setId(i);
+      tracks[i].setPrimaryMomentum(TVector3(1.0, 0.5 + 0.01 * i, 2.0));
+      tracks[i].setGlobalMomentum(TVector3(1.0, 0.5 + 0.01 * i, 2.0));
+      tracks[i].setOrigin(TVector3(0.1, 0.1, 0.0));
+    }
+    for (unsigned i = 0; i < towers.size(); ++i) {
+      towers[i].setAdc(20);
+      towers[i].setEnergy(1.0 + 0.01 * i);
+      if (i % 3 == 0)
+        matched[i] = {i, i + 1};
+    }
+  }
+
+  void build(jetreader::VectorInfoPool &pool,
+             std::vector<fastjet::PseudoJet> &pseudojets) {
+    TVector3 vertex(0, 0, 0);
+    pool.reset();
+    pseudojets.clear();
+    for (auto &track : tracks)
+      pseudojets.push_back(jetreader::MakePseudoJet(pool, track, vertex));
+    for (unsigned i = 0; i < towers.size(); ++i)
+      pseudojets.push_back(jetreader::MakePseudoJet(
+          pool, towers[i], i + 1, 0.5, 1.0, 0.5, 2.0, matched[i]));
+  }
+
+  std::vector<StPicoTrack> tracks;
+  std::vector<StPicoBTowHit> towers;
+  std::vector<std::vector<unsigned>> matched;
+};
+
+// records the allocation count when an event is selected, which is after it
+// was read from the chain - allocations made by ROOT while reading are not
+// counted against the event
+class MarkingEventSelector : public jetreader::EventSelector {
+public:
+  jetreader::EventStatus select(StPicoEvent *event) override {
+    mark = allocations;
+    return EventSelector::select(event);
+  }
+
+  size_t mark = 0;
+};
+
+// reads the whole chain once, so that every buffer of the Reader grows to fit
+// the largest event, then expects the processing of each event in a second
+// pass to make no heap allocation
+void ExpectNoAllocationAfterWarmup(jetreader::Reader &reader,
+                                   const MarkingEventSelector &selector) {
+  while (reader.next()) {
+  }
+  reader.readEvent(0);
+
+  int events = 0;
+  AllocationCounter counter;
+  while (reader.next()) {
+    size_t event_allocations = allocations - selector.mark;
+    EXPECT_EQ(event_allocations, 0u) << "entry " << reader.currentEntry();
+    ++events;
+  }
+  EXPECT_GT(events, 0);
+}
+
+} // namespace
+
+TEST(ReaderAllocation, CounterCountsAllocations) {
+  AllocationCounter counter;
+  std::vector<int> *v = new std::vector<int>(10);
+  EXPECT_EQ(counter.count(), 2u);
+  delete v;
+  counter.restart();
+  EXPECT_EQ(counter.count(), 0u);
+}
+
+TEST(ReaderAllocation, VectorInfoPool) {
+  TestEvent event;
+  jetreader::VectorInfoPool pool;
+  std::vector<fastjet::PseudoJet> pseudojets;
+  event.build(pool, pseudojets);
+
+  AllocationCounter counter;
+  for (int i = 0; i < 10; ++i)
+    event.build(pool, pseudojets);
+  EXPECT_EQ(counter.count(), 0u);
+}
+
+TEST(ReaderAllocation, Next) {
+  jetreader::Reader reader(jetreader::GetTestFile());
+  jetreader::TurnOffMostBranches(reader);
+  MarkingEventSelector *selector = new MarkingEventSelector;
+  reader.setEventSelector(selector);
+  reader.init();
+
+  ExpectNoAllocationAfterWarmup(reader, *selector);
+}
+
+TEST(ReaderAllocation, NextWithCorrectionAndEventView) {
+  jetreader::Reader reader(jetreader::GetTestFile());
+  jetreader::TurnOffMostBranches(reader);
+  MarkingEventSelector *selector = new MarkingEventSelector;
+  reader.setEventSelector(selector);
+  reader.setTrackTowerMatching(jetreader::TrackTowerMatching::grid);
+  reader.useHadronicCorrection(true, 1.0);
+  reader.setEventOutput(jetreader::EventOutput::both);
+  reader.init();
+
+  ExpectNoAllocationAfterWarmup(reader, *selector);
+}
+
+TEST(ReaderAllocation, NextWithTrackExpression) {
+  jetreader::Reader reader(jetreader::GetTestFile());
+  jetreader::TurnOffMostBranches(reader);
+  MarkingEventSelector *selector = new MarkingEventSelector;
+  reader.setEventSelector(selector);
+  reader.trackSelector()->addExpression(
+      "nHitsFit / nHitsMax > 0.52 && abs(gDCAz) < 1 && pt > 0.2");
+  reader.init();
+
+  ExpectNoAllocationAfterWarmup(reader, *selector);
+}
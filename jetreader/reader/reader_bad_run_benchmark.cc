@@ -37,6 +37,27 @@ static void BM_BadRunReader(benchmark::State &state) {
     ReaderLoadAndRunBadRuns();
 }
 
+// same as above, but rejected runs are skipped using the run index. The index
+// is built in the first iteration and loaded from file afterwards
+void ReaderLoadAndRunBadRunsIndexed() {
+  std::string filename = jetreader::GetTestFile();
+  jetreader::Reader reader(filename.c_str());
+  std::vector<unsigned> bad_run;
+  bad_run.push_back(15095020);
+  reader.eventSelector()->addBadRuns(bad_run);
+  reader.useRunIndex(true, "reader_bad_run_benchmark.runindex");
+  reader.init();
+  while(reader.next()) {
+    continue;
+  }
+}
+
+static void BM_BadRunReaderIndexed(benchmark::State &state) {
+  for (auto _ : state)
+    ReaderLoadAndRunBadRunsIndexed();
+}
+
 BENCHMARK(BM_Reader);
 BENCHMARK(BM_BadRunReader);
+BENCHMARK(BM_BadRunReaderIndexed);
 BENCHMARK_MAIN();
\ No newline at end of file
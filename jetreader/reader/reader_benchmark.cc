@@ -3,6 +3,8 @@
 #include "jetreader/lib/test_data.h"
 #include "jetreader/reader/reader.h"
 
+#include "fastjet/ClusterSequence.hh"
+
 constexpr unsigned EVENTS = 500;
 
 void StPicoDstReaderLoadAndRun() {
@@ -54,7 +56,30 @@ static void BM_JetReader(benchmark::State &state) {
     JetReaderLoadAndRun();
 }
 
+// reads and clusters events, with the given prefetch depth (0 turns prefetching
+// off), so that event reading can overlap with the clustering
+double JetReaderLoadAndCluster(unsigned prefetch_depth) {
+  std::string filename = jetreader::GetTestFile();
+  jetreader::Reader reader(filename);
+  reader.usePrefetch(prefetch_depth);
+  reader.init();
+  fastjet::JetDefinition jet_def(fastjet::antikt_algorithm, 0.4);
+  double total = 0.0;
+  for (int i = 0; i < EVENTS && reader.next(); ++i) {
+    fastjet::ClusterSequence cluster(reader.pseudojets(), jet_def);
+    for (auto &jet : cluster.inclusive_jets(5.0))
+      total += jet.pt();
+  }
+  return total;
+}
+
+static void BM_JetReaderWithClustering(benchmark::State &state) {
+  for (auto _ : state)
+    benchmark::DoNotOptimize(JetReaderLoadAndCluster(state.range(0)));
+}
+
 BENCHMARK(BM_StPicoDstReader);
 BENCHMARK(BM_StPicoDstReaderWithTowersTracks);
 BENCHMARK(BM_JetReader);
+BENCHMARK(BM_JetReaderWithClustering)->Arg(0)->Arg(1)->Arg(8)->Arg(64);
 BENCHMARK_MAIN();
\ No newline at end of file
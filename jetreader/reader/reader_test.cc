@@ -5,10 +5,15 @@
 #include "jetreader/lib/test_data.h"
 #include "jetreader/reader/event_selector.h"
 #include "jetreader/reader/reader.h"
+#include "jetreader/reader/skim_reader.h"
+#include "jetreader/reader/skim_writer.h"
+#include "jetreader/reader/vector_info.h"
 
 #include <algorithm>
 #include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <limits>
 #include <random>
 #include <set>
 #include <string>
@@ -32,6 +37,8 @@
 #include "StPicoEvent/StPicoTrack.h"
 #include "StPicoEvent/StPicoTrackCovMatrix.h"
 
+#include "yaml-cpp/yaml.h"
+
 TEST(Reader, Load) {
   std::string filename = jetreader::GetTestFile();
 
@@ -41,6 +48,40 @@ TEST(Reader, Load) {
   EXPECT_EQ(reader.chain()->GetEntries(), 624);
 }
 
+TEST(Reader, ChainMetadata) {
+  std::string filename = jetreader::GetTestFile();
+  std::string list = "reader_test_chain_tmp.list";
+  std::string metadata_file = list + ".chainmeta";
+  std::ofstream out(list);
+  out << filename << "\n" << filename << "\n";
+  out.close();
+
+  // the metadata is built the first time, and loaded the second
+  for (int i = 0; i < 2; ++i) {
+    jetreader::Reader reader(list);
+    TurnOffBranches(reader);
+    reader.useChainMetadata(true);
+    reader.init();
+    EXPECT_EQ(reader.entries(), 2 * 624);
+    EXPECT_EQ(reader.chainMetadata().files().size(), 2);
+
+    jetreader::Reader uncached(list);
+    TurnOffBranches(uncached);
+    uncached.init();
+    EXPECT_EQ(uncached.entries(), 2 * 624);
+
+    while (uncached.next()) {
+      ASSERT_TRUE(reader.next());
+      EXPECT_EQ(reader.currentEntry(), uncached.currentEntry());
+      EXPECT_EQ(reader.event()->eventId(), uncached.event()->eventId());
+    }
+    EXPECT_FALSE(reader.next());
+  }
+
+  remove(list.c_str());
+  remove(metadata_file.c_str());
+}
+
 TEST(Reader, ReadEvent) {
   std::string filename = jetreader::GetTestFile();
 
@@ -52,6 +93,35 @@ TEST(Reader, ReadEvent) {
   EXPECT_EQ(reader.picoDst()->event()->eventId(), 22661);
 }
 
+TEST(Reader, BranchPruning) {
+  std::string filename = jetreader::GetTestFile();
+
+  jetreader::Reader reader(filename);
+  reader.init();
+  std::vector<std::string> expected{"Event", "Track", "BTowHit"};
+  EXPECT_EQ(reader.activeBranches(), expected);
+
+  // branches turned off by the user stay off
+  jetreader::Reader no_tracks(filename);
+  TurnOffBranches(no_tracks);
+  no_tracks.init();
+  expected = {"Event"};
+  EXPECT_EQ(no_tracks.activeBranches(), expected);
+
+  jetreader::Reader kept(filename);
+  kept.keepBranch("BTofPidTraits");
+  kept.init();
+  auto active = kept.activeBranches();
+  EXPECT_EQ(active.size(), 4);
+  EXPECT_NE(std::find(active.begin(), active.end(), "BTofPidTraits"),
+            active.end());
+
+  jetreader::Reader unpruned(filename);
+  unpruned.pruneBranches(false);
+  unpruned.init();
+  EXPECT_GT(unpruned.activeBranches().size(), 4);
+}
+
 TEST(Reader, Next) {
   std::string filename = jetreader::GetTestFile();
 
@@ -73,6 +143,34 @@ TEST(Reader, Next) {
   EXPECT_EQ(reader.chain()->GetReadEntry(), 623);
 }
 
+TEST(Reader, Shard) {
+  std::string filename = jetreader::GetTestFile();
+  unsigned count = 3;
+
+  // every event accepted by the full chain is read by exactly one shard
+  std::vector<int64_t> expected;
+  jetreader::Reader full(filename);
+  TurnOffBranches(full);
+  full.init();
+  while (full.next())
+    expected.push_back(full.currentEntry());
+
+  std::vector<int64_t> sharded;
+  int64_t next_begin = 0;
+  for (unsigned i = 0; i < count; ++i) {
+    jetreader::Reader reader(filename);
+    TurnOffBranches(reader);
+    reader.setShard(i, count);
+    reader.init();
+    EXPECT_EQ(reader.entryRangeBegin(), next_begin);
+    next_begin = reader.entryRangeEnd();
+    while (reader.next())
+      sharded.push_back(reader.currentEntry());
+  }
+  EXPECT_EQ(next_begin, full.entries());
+  EXPECT_EQ(sharded, expected);
+}
+
 TEST(Reader, MixedReading) {
   std::string filename = jetreader::GetTestFile();
 
@@ -113,6 +211,105 @@ TEST(Reader, OverloadSelector) {
   EXPECT_EQ(0, accepted_events);
 }
 
+// a custom selector with the default selection. Since select() may be
+// overridden, the reader selects its tracks one at a time
+class PerTrackSelector : public jetreader::TrackSelector {};
+
+void SetTestTrackCuts(jetreader::TrackSelector *selector) {
+  selector->setDcaMax(3.0);
+  selector->setNHitsMin(15);
+  selector->setNHitsFracMin(0.52);
+  selector->setPtMin(0.2);
+  selector->setPtMax(30.0);
+}
+
+TEST(Reader, BatchTrackSelection) {
+  std::string filename = jetreader::GetTestFile();
+
+  jetreader::Reader batch(filename);
+  TurnOffMostBranches(batch);
+  SetTestTrackCuts(batch.trackSelector());
+  batch.init();
+
+  jetreader::Reader per_track(filename);
+  TurnOffMostBranches(per_track);
+  per_track.setTrackSelector(new PerTrackSelector);
+  SetTestTrackCuts(per_track.trackSelector());
+  per_track.init();
+
+  while (per_track.next()) {
+    ASSERT_TRUE(batch.next());
+    EXPECT_EQ(batch.currentEntry(), per_track.currentEntry());
+    auto &expected = per_track.pseudojets();
+    auto &jets = batch.pseudojets();
+    ASSERT_EQ(jets.size(), expected.size());
+    for (size_t i = 0; i < jets.size(); ++i) {
+      EXPECT_EQ(jets[i].pt(), expected[i].pt());
+      EXPECT_EQ(jets[i].E(), expected[i].E());
+    }
+  }
+  EXPECT_FALSE(batch.next());
+}
+
+TEST(Reader, TowerEnergyFloor) {
+  std::string filename = jetreader::GetTestFile();
+
+  // every tower is selected when the floor is -infinity
+  jetreader::Reader dense(filename);
+  TurnOffMostBranches(dense);
+  dense.setTowerEnergyFloor(-std::numeric_limits<double>::infinity());
+  dense.towerSelector()->setEtMin(0.2);
+  dense.init();
+
+  jetreader::Reader sparse(filename);
+  TurnOffMostBranches(sparse);
+  EXPECT_EQ(sparse.towerEnergyFloor(), 0.0);
+  sparse.towerSelector()->setEtMin(0.2);
+  sparse.init();
+
+  while (dense.next()) {
+    ASSERT_TRUE(sparse.next());
+    auto &expected = dense.pseudojets();
+    auto &jets = sparse.pseudojets();
+    ASSERT_EQ(jets.size(), expected.size());
+    for (size_t i = 0; i < jets.size(); ++i) {
+      EXPECT_EQ(jets[i].pt(), expected[i].pt());
+      EXPECT_EQ(jets[i].eta(), expected[i].eta());
+      EXPECT_EQ(jets[i].E(), expected[i].E());
+    }
+  }
+  EXPECT_FALSE(sparse.next());
+}
+
+// counts the towers it is passed
+class CountingTowerSelector : public jetreader::TowerSelector {
+public:
+  jetreader::TowerStatus select(StPicoBTowHit *tower, unsigned id,
+                                double eta) override {
+    ++selected;
+    return TowerSelector::select(tower, id, eta);
+  }
+  int64_t selected = 0;
+};
+
+// the floor does not apply to custom tower selectors, which may reject the
+// event on towers below it
+TEST(Reader, TowerEnergyFloorCustomSelector) {
+  std::string filename = jetreader::GetTestFile();
+
+  CountingTowerSelector *selector = new CountingTowerSelector;
+  jetreader::Reader reader(filename);
+  TurnOffMostBranches(reader);
+  reader.setTowerSelector(selector);
+  reader.init();
+
+  int64_t towers = 0;
+  while (reader.next())
+    towers += reader.picoDst()->numberOfBTowHits();
+  EXPECT_GT(towers, 0);
+  EXPECT_EQ(selector->selected, towers);
+}
+
 TEST(Reader, BasicPseudoJets) {
   std::string filename = jetreader::GetTestFile();
 
@@ -126,6 +323,217 @@ TEST(Reader, BasicPseudoJets) {
   EXPECT_GT(jets.size(), 0);
 }
 
+TEST(Reader, Prefetch) {
+  std::string filename = jetreader::GetTestFile();
+
+  jetreader::Reader serial(filename);
+  TurnOffMostBranches(serial);
+  serial.init();
+
+  jetreader::Reader prefetch(filename);
+  TurnOffMostBranches(prefetch);
+  prefetch.usePrefetch(4);
+  prefetch.init();
+
+  int events = 0;
+  int reused = 0;
+  while (serial.next()) {
+    ASSERT_TRUE(prefetch.next());
+    EXPECT_EQ(prefetch.currentEntry(), serial.currentEntry());
+    EXPECT_EQ(prefetch.event()->eventId(), serial.event()->eventId());
+    auto &jets = prefetch.pseudojets();
+    auto &expected = serial.pseudojets();
+    ASSERT_EQ(jets.size(), expected.size());
+    for (size_t i = 0; i < jets.size(); ++i) {
+      EXPECT_EQ(jets[i].pt(), expected[i].pt());
+      auto &info = jets[i].user_info<jetreader::VectorInfo>();
+      auto &expected_info = expected[i].user_info<jetreader::VectorInfo>();
+      EXPECT_EQ(info.isBemcTower(), expected_info.isBemcTower());
+      EXPECT_EQ(info.trackId(), expected_info.trackId());
+      EXPECT_EQ(info.towerId(), expected_info.towerId());
+      EXPECT_EQ(info.matchedTracks(), expected_info.matchedTracks());
+    }
+
+    // events handed back by next() are refilled by the prefetching thread, so
+    // their pools keep the VectorInfos of earlier, larger events
+    if (prefetch.vectorInfoPool().size() > jets.size())
+      ++reused;
+    ++events;
+  }
+  EXPECT_FALSE(prefetch.next());
+  EXPECT_GT(events, 0);
+  EXPECT_GT(reused, 0);
+
+  EXPECT_THROW(prefetch.readEvent(0), jetreader::AssertionFailure);
+}
+
+TEST(Reader, EventHeaderCache) {
+  std::string filename = jetreader::GetTestFile();
+  std::string cache_file = "reader_test_tmp.hdrcache";
+
+  std::vector<int64_t> expected;
+  jetreader::Reader serial(filename);
+  TurnOffBranches(serial);
+  serial.eventSelector()->setVzRange(-30, 30);
+  serial.eventSelector()->setRefMultRange(10, 500);
+  serial.init();
+  while (serial.next())
+    expected.push_back(serial.currentEntry());
+
+  // the first reader builds the cache, the second loads it from file
+  for (int pass = 0; pass < 2; ++pass) {
+    jetreader::Reader reader(filename);
+    TurnOffBranches(reader);
+    reader.eventSelector()->setVzRange(-30, 30);
+    reader.eventSelector()->setRefMultRange(10, 500);
+    reader.useEventHeaderCache(true, cache_file);
+    reader.init();
+    EXPECT_EQ(reader.eventHeaderCache().entries(), reader.entries());
+
+    std::vector<int64_t> accepted;
+    while (reader.next())
+      accepted.push_back(reader.currentEntry());
+    EXPECT_GT(accepted.size(), 0);
+    EXPECT_EQ(accepted, expected);
+  }
+
+  remove(cache_file.c_str());
+}
+
+// expressions can use header fields the stock cuts don't, which must be
+// cached as well
+TEST(Reader, EventHeaderCacheExpression) {
+  std::string filename = jetreader::GetTestFile();
+  std::string cache_file = "reader_test_expression_tmp.hdrcache";
+  std::string expression = "bField != 0 && eventId > 0 && bbcX >= 0";
+
+  std::vector<int64_t> expected;
+  jetreader::Reader serial(filename);
+  TurnOffBranches(serial);
+  serial.eventSelector()->addExpression(expression);
+  serial.init();
+  while (serial.next())
+    expected.push_back(serial.currentEntry());
+  EXPECT_GT(expected.size(), 0);
+
+  jetreader::Reader reader(filename);
+  TurnOffBranches(reader);
+  reader.eventSelector()->addExpression(expression);
+  reader.useEventHeaderCache(true, cache_file);
+  reader.init();
+
+  std::vector<int64_t> accepted;
+  while (reader.next())
+    accepted.push_back(reader.currentEntry());
+  EXPECT_EQ(accepted, expected);
+
+  remove(cache_file.c_str());
+}
+
+// once the pool holds as many VectorInfos as the largest event so far, the
+// next event does not allocate any
+TEST(Reader, VectorInfoReuse) {
+  std::string filename = jetreader::GetTestFile();
+  jetreader::Reader reader(filename);
+  TurnOffMostBranches(reader);
+  reader.init();
+
+  int steady_events = 0;
+  while (reader.next()) {
+    size_t pool_size = reader.vectorInfoPool().size();
+    size_t allocations = reader.vectorInfoPool().allocations();
+    size_t constituents = reader.pseudojets().size();
+    if (!reader.next())
+      break;
+
+    // only VectorInfos that grow the pool are allocated
+    const jetreader::VectorInfoPool &pool = reader.vectorInfoPool();
+    EXPECT_EQ(pool.allocations() - allocations, pool.size() - pool_size);
+    if (reader.pseudojets().size() <= pool_size) {
+      EXPECT_EQ(pool.allocations(), allocations);
+      ++steady_events;
+    }
+    EXPECT_GE(pool.size(), std::max(constituents, reader.pseudojets().size()));
+  }
+  EXPECT_GT(steady_events, 0);
+}
+
+TEST(Reader, EventView) {
+  std::string filename = jetreader::GetTestFile();
+
+  jetreader::Reader reader(filename);
+  TurnOffMostBranches(reader);
+  reader.setEventOutput(jetreader::EventOutput::both);
+  reader.init();
+
+  jetreader::Reader view_only(filename);
+  TurnOffMostBranches(view_only);
+  view_only.setEventOutput(jetreader::EventOutput::eventView);
+  view_only.init();
+
+  for (int i = 0; i < 20 && reader.next(); ++i) {
+    ASSERT_TRUE(view_only.next());
+    auto &jets = reader.pseudojets();
+    auto &view = reader.eventView();
+    ASSERT_EQ(jets.size(), view.size());
+    for (size_t j = 0; j < jets.size(); ++j) {
+      EXPECT_NEAR(jets[j].pt(), view.pt()[j], 1e-5);
+      EXPECT_NEAR(jets[j].eta(), view.eta()[j], 1e-5);
+      EXPECT_NEAR(jets[j].phi(), view.phi()[j], 1e-5);
+    }
+
+    // PseudoJets are converted from the EventView on demand
+    EXPECT_EQ(view_only.eventView().size(), view.size());
+    auto &converted = view_only.pseudojets();
+    ASSERT_EQ(converted.size(), jets.size());
+    for (size_t j = 0; j < jets.size(); ++j)
+      EXPECT_NEAR(converted[j].pt(), jets[j].pt(), 1e-5);
+  }
+}
+
+TEST(Reader, Skim) {
+  std::string filename = jetreader::GetTestFile();
+  std::string skim_file = "reader_test_tmp.skim";
+
+  // with hadronic correction, so that corrected tower energies are replayed
+  jetreader::Reader reader(filename);
+  TurnOffMostBranches(reader);
+  reader.useHadronicCorrection(true);
+  reader.init();
+
+  std::vector<std::vector<fastjet::PseudoJet>> expected;
+  std::vector<int> run_ids;
+  {
+    jetreader::SkimWriter writer(skim_file, reader);
+    for (int i = 0; i < 20 && reader.next(); ++i) {
+      writer.write(reader);
+      expected.push_back(reader.pseudojets());
+      run_ids.push_back(reader.event()->runId());
+    }
+  }
+
+  jetreader::SkimReader skim(skim_file);
+  EXPECT_TRUE(skim.matchesConfig(reader.configString()));
+  size_t n_events = 0;
+  while (skim.next()) {
+    ASSERT_LT(n_events, expected.size());
+    EXPECT_EQ(skim.event()->runId(), run_ids[n_events]);
+    auto &jets = skim.pseudojets();
+    auto &expected_jets = expected[n_events++];
+    ASSERT_EQ(jets.size(), expected_jets.size());
+    // a replayed event reproduces the Reader's output exactly
+    for (size_t j = 0; j < jets.size(); ++j) {
+      EXPECT_EQ(jets[j].px(), expected_jets[j].px());
+      EXPECT_EQ(jets[j].py(), expected_jets[j].py());
+      EXPECT_EQ(jets[j].pz(), expected_jets[j].pz());
+      EXPECT_EQ(jets[j].e(), expected_jets[j].e());
+    }
+  }
+  EXPECT_EQ(n_events, expected.size());
+
+  remove(skim_file.c_str());
+}
+
 struct TestPicoInfo {
   std::string filename = "";
   int good_events = 0;
@@ -182,6 +590,124 @@ TEST(Reader, findNextGoodRun) {
   }
 }
 
+TEST(Reader, RunIndex) {
+  std::string index_file = "reader_test_pico_tmp.runindex";
+  for (int i = 0; i < 10; ++i) {
+    TestPicoInfo test_config = makePicoFile(i);
+
+    std::vector<unsigned> bad_runs;
+    for (auto &run : test_config.bad_runs)
+      bad_runs.push_back(run);
+
+    // the first reader builds the index, the second loads it from file
+    for (int pass = 0; pass < 2; ++pass) {
+      jetreader::Reader reader(test_config.filename);
+      reader.eventSelector()->addBadRuns(bad_runs);
+      reader.useRunIndex(true, index_file);
+      reader.init();
+      EXPECT_EQ(reader.runIndex().entries(), reader.entries());
+
+      int good_events = 0;
+      while (reader.next()) {
+        int runid = reader.picoDst()->event()->runId();
+        EXPECT_TRUE(test_config.bad_runs.find(runid) ==
+                    test_config.bad_runs.end());
+        good_events++;
+      }
+      EXPECT_EQ(good_events, test_config.good_events);
+    }
+
+    remove(index_file.c_str());
+    if (remove(test_config.filename.c_str()) != 0)
+      std::cerr << "error removing file after test: " << test_config.filename
+                << std::endl;
+  }
+}
+
+// an index that loads, but disagrees with the events, must not skip good runs
+TEST(Reader, StaleRunIndex) {
+  std::string index_file = "reader_test_pico_tmp.runindex";
+  for (int i = 0; i < 5; ++i) {
+    TestPicoInfo test_config = makePicoFile(i);
+
+    std::vector<unsigned> bad_runs;
+    for (auto &run : test_config.bad_runs)
+      bad_runs.push_back(run);
+
+    int64_t entries = 0;
+    {
+      jetreader::Reader reader(test_config.filename);
+      reader.init();
+      entries = reader.entries();
+    }
+
+    // a single range with a run ID that isn't in the file
+    jetreader::FileFingerprint fingerprint;
+    ASSERT_TRUE(jetreader::FileFingerprint::Make(test_config.filename, entries,
+                                                 fingerprint));
+    jetreader::RunIndex stale;
+    for (int64_t entry = 0; entry < entries; ++entry)
+      stale.add(0);
+    ASSERT_TRUE(stale.save(index_file, fingerprint));
+
+    jetreader::Reader reader(test_config.filename);
+    reader.eventSelector()->addBadRuns(bad_runs);
+    reader.useRunIndex(true, index_file);
+    reader.init();
+    ASSERT_EQ(reader.runIndex().ranges().size(), 1);
+
+    int good_events = 0;
+    while (reader.next())
+      good_events++;
+    EXPECT_EQ(good_events, test_config.good_events);
+
+    remove(index_file.c_str());
+    if (remove(test_config.filename.c_str()) != 0)
+      std::cerr << "error removing file after test: " << test_config.filename
+                << std::endl;
+  }
+}
+
+TEST(Reader, CutFlow) {
+  std::string index_file = "reader_test_pico_tmp.runindex";
+  for (int i = 0; i < 5; ++i) {
+    TestPicoInfo test_config = makePicoFile(i);
+
+    std::vector<unsigned> bad_runs;
+    for (auto &run : test_config.bad_runs)
+      bad_runs.push_back(run);
+
+    // bad runs are skipped by findNextGoodRun() or by the run index, and
+    // both are counted in the cut flow
+    for (int use_index = 0; use_index < 2; ++use_index) {
+      jetreader::Reader reader(test_config.filename);
+      reader.eventSelector()->addBadRuns(bad_runs);
+      reader.useRunIndex(use_index, index_file);
+      reader.useCutFlow(true);
+      reader.init();
+
+      int good_events = 0;
+      while (reader.next())
+        good_events++;
+
+      const jetreader::CutFlow &flow = reader.eventSelector()->cutFlow();
+      const auto &bad_run_cut = flow.cuts()[flow.index("badRuns")];
+      EXPECT_EQ(flow.tested(), reader.entries());
+      EXPECT_EQ(flow.accepted(), good_events);
+      EXPECT_EQ(bad_run_cut.tested, reader.entries());
+      EXPECT_EQ(bad_run_cut.passed, good_events);
+
+      YAML::Node node = YAML::Load(reader.cutFlowString());
+      EXPECT_EQ(node["eventSelector"]["accepted"].as<int>(), good_events);
+    }
+
+    remove(index_file.c_str());
+    if (remove(test_config.filename.c_str()) != 0)
+      std::cerr << "error removing file after test: " << test_config.filename
+                << std::endl;
+  }
+}
+
 TestPicoInfo makePicoFile(unsigned seed) {
   // filename must end in .picoDst.root
   TestPicoInfo info;
@@ -2,14 +2,35 @@
 
 namespace jetreader {
 
-fastjet::PseudoJet MakePseudoJet(const StPicoTrack &track, TVector3 vertex,
-                                 bool primary_track) {
-  fastjet::PseudoJet j;
+namespace {
+
+void SetTrackMomentum(fastjet::PseudoJet &j, const StPicoTrack &track,
+                      bool primary_track) {
   if (primary_track) {
     j.reset_PtYPhiM(track.pPt(), track.pMom().Eta(), track.pMom().Phi());
   } else {
     j.reset_PtYPhiM(track.gPt(), track.gMom().Eta(), track.gMom().Phi());
   }
+}
+
+void SetTowerMomentum(fastjet::PseudoJet &j, double phi, double eta_corr,
+                      double cosh_eta_corr, double e_corr) {
+  double et = e_corr / cosh_eta_corr;
+  double mass = 0.0;
+  j.reset_PtYPhiM(et, eta_corr, phi, mass);
+}
+
+void SetTowerMomentum(fastjet::PseudoJet &j, double phi, double eta_corr,
+                      double e_corr) {
+  SetTowerMomentum(j, phi, eta_corr, cosh(eta_corr), e_corr);
+}
+
+} // namespace
+
+fastjet::PseudoJet MakePseudoJet(const StPicoTrack &track, TVector3 vertex,
+                                 bool primary_track) {
+  fastjet::PseudoJet j;
+  SetTrackMomentum(j, track, primary_track);
 
   VectorInfo *info = new VectorInfo(track, vertex, primary_track);
   j.set_user_info(info);
@@ -21,10 +42,8 @@ fastjet::PseudoJet MakePseudoJet(const StPicoBTowHit &tower, unsigned tower_id,
                                  double eta, double phi, double eta_corr,
                                  double e_corr,
                                  std::vector<unsigned> &matched_tracks) {
-  double et = e_corr / cosh(eta_corr);
-  double mass = 0.0;
   fastjet::PseudoJet j;
-  j.reset_PtYPhiM(et, eta_corr, phi, mass);
+  SetTowerMomentum(j, phi, eta_corr, e_corr);
 
   VectorInfo *info = new VectorInfo(tower, tower_id, eta, matched_tracks);
   j.set_user_info(info);
@@ -32,4 +51,60 @@ fastjet::PseudoJet MakePseudoJet(const StPicoBTowHit &tower, unsigned tower_id,
   return j;
 }
 
-} // namespace jetreader
\ No newline at end of file
+fastjet::PseudoJet MakePseudoJet(VectorInfoPool &pool, const StPicoTrack &track,
+                                 TVector3 vertex, bool primary_track) {
+  fastjet::PseudoJet j;
+  SetTrackMomentum(j, track, primary_track);
+  pool.attach(j).setTrack(track, vertex, primary_track);
+  return j;
+}
+
+fastjet::PseudoJet MakePseudoJet(VectorInfoPool &pool, const StPicoTrack &track,
+                                 const TrackTable &table, size_t idx,
+                                 bool primary_track, int matched_tower) {
+  fastjet::PseudoJet j;
+  j.reset_PtYPhiM(table.pt()[idx], table.eta()[idx], table.phi()[idx]);
+  pool.attach(j).setTrack(track.id(), primary_track, track.charge(),
+                          table.dca()[idx], track.nHitsFit(),
+                          track.nHitsPoss(), matched_tower);
+  return j;
+}
+
+fastjet::PseudoJet MakePseudoJet(VectorInfoPool &pool,
+                                 const StPicoBTowHit &tower, unsigned tower_id,
+                                 double eta, double phi, double eta_corr,
+                                 double e_corr,
+                                 std::vector<unsigned> &matched_tracks) {
+  fastjet::PseudoJet j;
+  SetTowerMomentum(j, phi, eta_corr, e_corr);
+  pool.attach(j).setTower(tower, tower_id, eta, matched_tracks);
+  return j;
+}
+
+fastjet::PseudoJet MakePseudoJet(VectorInfoPool &pool,
+                                 const StPicoBTowHit &tower, unsigned tower_id,
+                                 const TowerKinematics &kinematics,
+                                 double e_corr,
+                                 Span<const unsigned> matched_tracks) {
+  unsigned tow_idx = tower_id - 1;
+  fastjet::PseudoJet j;
+  SetTowerMomentum(j, kinematics.phi(tow_idx),
+                   kinematics.correctedEta(tow_idx),
+                   kinematics.coshEta(tow_idx), e_corr);
+  pool.attach(j).setTower(tower, tower_id, kinematics.eta(tow_idx),
+                          matched_tracks);
+  return j;
+}
+
+size_t FindTowerHits(const float *energy, size_t n, double floor,
+                     unsigned *hits) {
+  // every index is written, but only kept if the next one is written past it
+  size_t n_hits = 0;
+  for (size_t i = 0; i < n; ++i) {
+    hits[n_hits] = i;
+    n_hits += energy[i] > floor;
+  }
+  return n_hits;
+}
+
+} // namespace jetreader
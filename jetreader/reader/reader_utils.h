@@ -3,7 +3,10 @@
 
 #include "jetreader/lib/memory.h"
 #include "jetreader/reader/bemc_helper.h"
+#include "jetreader/reader/tower_kinematics.h"
+#include "jetreader/reader/track_table.h"
 #include "jetreader/reader/vector_info.h"
+#include "jetreader/reader/vector_info_pool.h"
 
 #include "fastjet/PseudoJet.hh"
 
@@ -25,6 +28,40 @@ fastjet::PseudoJet MakePseudoJet(const StPicoTrack &track, TVector3 vertex,
 fastjet::PseudoJet MakePseudoJet(const StPicoBTowHit &tower, unsigned tower_id,
                                  double eta, double phi, double eta_corr,
                                  double e_corr, std::vector<unsigned>& matched_tracks);
+
+// same as above, but the user info is taken from pool instead of being
+// allocated for each PseudoJet
+fastjet::PseudoJet MakePseudoJet(VectorInfoPool &pool, const StPicoTrack &track,
+                                 TVector3 vertex, bool primary_track = true);
+
+// same as above, with the kinematics and DCA taken from entry idx of a
+// TrackTable filled with the same vertex and primary_track instead of being
+// recomputed from the track. Requires TrackTable::setKinematics() for idx.
+// matched_tower is the index of the tower the track is matched to, or -1 -
+// track.bemcTowerIndex(), or the tower found by a TrackTowerMatcher
+fastjet::PseudoJet MakePseudoJet(VectorInfoPool &pool, const StPicoTrack &track,
+                                 const TrackTable &table, size_t idx,
+                                 bool primary_track, int matched_tower);
+
+fastjet::PseudoJet MakePseudoJet(VectorInfoPool &pool,
+                                 const StPicoBTowHit &tower, unsigned tower_id,
+                                 double eta, double phi, double eta_corr,
+                                 double e_corr,
+                                 std::vector<unsigned> &matched_tracks);
+
+// same as above, with eta, phi, the vertex corrected eta and its cosh taken
+// from kinematics, set for the vertex of the event
+fastjet::PseudoJet MakePseudoJet(VectorInfoPool &pool,
+                                 const StPicoBTowHit &tower, unsigned tower_id,
+                                 const TowerKinematics &kinematics,
+                                 double e_corr,
+                                 Span<const unsigned> matched_tracks);
+
+// writes the index of every entry of energy[0, n) above floor to hits, in
+// order, and returns their number. hits must have room for n entries. The scan
+// has no branches, so its cost does not depend on the number of hits
+size_t FindTowerHits(const float *energy, size_t n, double floor,
+                     unsigned *hits);
 } // namespace jetreader
 
 #endif // JETREADER_READER_READER_UTILS_H
\ No newline at end of file
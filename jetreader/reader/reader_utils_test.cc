@@ -1,6 +1,7 @@
 #include "gtest/gtest.h"
 
 #include "jetreader/reader/reader_utils.h"
+#include "jetreader/reader/track_table.h"
 #include "jetreader/reader/vector_info.h"
 #include "jetreader/reader/bemc_helper.h"
 
@@ -101,4 +102,91 @@ TEST(ReaderUtils, MakePseudoJetFromTower) {
   EXPECT_EQ(id, i.towerId());
   EXPECT_EQ(adc, i.towerAdc());
   EXPECT_EQ(matched, i.matchedTracks());
-}
\ No newline at end of file
+}
+TEST(ReaderUtils, MakePseudoJetFromTrackTable) {
+  TVector3 vertex(0.1, -0.2, 5.0);
+
+  StPicoTrack track;
+  track.setId(4);
+  track.setPrimaryMomentum(TVector3(-2, 1, 2));
+  track.setGlobalMomentum(TVector3(-2.1, 1.1, 2.1));
+  track.setOrigin(TVector3(0.5, 0.5, 5.0));
+  track.setNHitsFit(25);
+  track.setNHitsPossible(40);
+
+  jetreader::VectorInfoPool pool;
+  for (bool primary : {true, false}) {
+    jetreader::TrackTable table;
+    table.add(track, vertex, primary);
+    table.setKinematics(0, track, primary);
+    EXPECT_EQ(table.p()[0], primary ? track.pPtot() : track.gPtot());
+
+    auto expected = jetreader::MakePseudoJet(track, vertex, primary);
+    auto j = jetreader::MakePseudoJet(pool, track, table, 0, primary,
+                                      track.bemcTowerIndex());
+    EXPECT_EQ(expected.pt(), j.pt());
+    EXPECT_EQ(expected.eta(), j.eta());
+    EXPECT_EQ(expected.phi(), j.phi());
+    EXPECT_EQ(expected.E(), j.E());
+
+    auto &info = j.user_info<jetreader::VectorInfo>();
+    auto &expected_info = expected.user_info<jetreader::VectorInfo>();
+    EXPECT_EQ(info.isPrimary(), expected_info.isPrimary());
+    EXPECT_EQ(info.trackId(), expected_info.trackId());
+    EXPECT_EQ(info.dca(), expected_info.dca());
+    EXPECT_EQ(info.nhits(), expected_info.nhits());
+    EXPECT_EQ(info.nhitsPoss(), expected_info.nhitsPoss());
+    EXPECT_EQ(info.matchedTower(), expected_info.matchedTower());
+
+    // the matched tower is taken as given, e.g. from a TrackTowerMatcher
+    auto grid = jetreader::MakePseudoJet(pool, track, table, 0, primary, 42);
+    EXPECT_EQ(grid.user_info<jetreader::VectorInfo>().matchedTower(), 42);
+  }
+}
+
+TEST(ReaderUtils, MakePseudoJetFromTowerKinematics) {
+  StPicoBTowHit tower;
+  tower.setAdc(30);
+  tower.setEnergy(4.1);
+  std::vector<unsigned> matched{2, 9};
+
+  jetreader::BemcHelper helper;
+  jetreader::TowerKinematics kinematics;
+  kinematics.setVertex(-12.5);
+  jetreader::VectorInfoPool pool;
+  for (unsigned id : {1, 2400, 4800}) {
+    double eta = helper.towerEta(id);
+    double phi = helper.towerPhi(id);
+    double eta_corr = helper.vertexCorrectedEta(id, -12.5);
+    auto expected =
+        jetreader::MakePseudoJet(tower, id, eta, phi, eta_corr, 3.7, matched);
+    auto j = jetreader::MakePseudoJet(
+        pool, tower, id, kinematics, 3.7,
+        jetreader::Span<const unsigned>(matched.data(), matched.size()));
+    EXPECT_EQ(expected.pt(), j.pt());
+    EXPECT_EQ(expected.eta(), j.eta());
+    EXPECT_EQ(expected.phi(), j.phi());
+    EXPECT_EQ(expected.E(), j.E());
+
+    auto &info = j.user_info<jetreader::VectorInfo>();
+    EXPECT_EQ(info.towerId(), id);
+    EXPECT_EQ(info.towerRawEta(), eta);
+    EXPECT_EQ(info.matchedTracks(), matched);
+  }
+}
+
+TEST(ReaderUtils, FindTowerHits) {
+  std::vector<float> energy{0.0, 1.5, -0.2, 0.3, 0.0, 4.0};
+  std::vector<unsigned> hits(energy.size());
+
+  size_t n = jetreader::FindTowerHits(energy.data(), energy.size(), 0.0,
+                                      hits.data());
+  hits.resize(n);
+  EXPECT_EQ(hits, (std::vector<unsigned>{1, 3, 5}));
+
+  hits.resize(energy.size());
+  n = jetreader::FindTowerHits(energy.data(), energy.size(), 1.5,
+                               hits.data());
+  EXPECT_EQ(n, 1);
+  EXPECT_EQ(hits[0], 5);
+}
@@ -0,0 +1,86 @@
+#include "jetreader/reader/run_index.h"
+
+#include <algorithm>
+#include <fstream>
+
+namespace jetreader {
+
+namespace {
+const std::string RUN_INDEX_HEADER = "jetreader_run_index_v3";
+} // namespace
+
+void RunIndex::add(unsigned run_id) {
+  if (ranges_.empty() || ranges_.back().run_id != run_id)
+    ranges_.push_back({run_id, entries_, entries_});
+  ranges_.back().end = ++entries_;
+}
+
+const RunIndex::Range *RunIndex::find(int64_t entry) const {
+  if (entry < 0 || entry >= entries_)
+    return nullptr;
+
+  // first range that ends after entry
+  auto range = std::upper_bound(
+      ranges_.begin(), ranges_.end(), entry,
+      [](int64_t entry, const Range &range) { return entry < range.end; });
+  return &*range;
+}
+
+void RunIndex::clear() {
+  ranges_.clear();
+  entries_ = 0;
+}
+
+bool RunIndex::save(const std::string &filename,
+                    const FileFingerprint &fingerprint) const {
+  std::ofstream out(filename);
+  if (!out.good())
+    return false;
+
+  out << RUN_INDEX_HEADER << " " << fingerprint.size << " "
+      << fingerprint.mtime << " " << fingerprint.members << " " << entries_
+      << " " << ranges_.size() << "\n";
+  for (auto &range : ranges_)
+    out << range.run_id << " " << range.begin << " " << range.end << "\n";
+  return out.good();
+}
+
+bool RunIndex::load(const std::string &filename,
+                    const FileFingerprint &fingerprint) {
+  clear();
+  std::ifstream in(filename);
+  if (!in.good())
+    return false;
+
+  std::string header;
+  FileFingerprint cached_fingerprint;
+  size_t n_ranges = 0;
+  if (!(in >> header >> cached_fingerprint.size >> cached_fingerprint.mtime >>
+        cached_fingerprint.members >> cached_fingerprint.entries >>
+        n_ranges) ||
+      header != RUN_INDEX_HEADER || !(cached_fingerprint == fingerprint))
+    return false;
+  int64_t entries = fingerprint.entries;
+
+  // ranges must cover the entries contiguously, in order
+  int64_t expected_begin = 0;
+  Range range;
+  for (size_t i = 0; i < n_ranges; ++i) {
+    if (!(in >> range.run_id >> range.begin >> range.end) ||
+        range.begin != expected_begin || range.end <= range.begin) {
+      clear();
+      return false;
+    }
+    ranges_.push_back(range);
+    expected_begin = range.end;
+  }
+
+  if (expected_begin != entries) {
+    clear();
+    return false;
+  }
+  entries_ = entries;
+  return true;
+}
+
+} // namespace jetreader
@@ -0,0 +1,61 @@
+#ifndef JETREADER_READER_RUN_INDEX_H
+#define JETREADER_READER_RUN_INDEX_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "jetreader/reader/event_header_cache.h"
+
+namespace jetreader {
+
+// maps the entries of a chain to the runs they belong to, as a list of
+// contiguous entry ranges. Used by the Reader to skip a rejected run in a
+// single step, instead of reading the run ID of each of its events. A run that
+// appears in several places in the chain has one range for each.
+//
+// The index can be saved to and loaded from a small text file, so that it only
+// has to be built once for a given input.
+class RunIndex {
+public:
+  // a contiguous set of entries [begin, end) from a single run
+  struct Range {
+    unsigned run_id;
+    int64_t begin;
+    int64_t end;
+  };
+
+  RunIndex() : entries_(0) {}
+
+  // appends the next entry of the chain to the index. Entries must be added in
+  // order, starting from zero
+  void add(unsigned run_id);
+
+  // the range containing entry, or nullptr if entry is not in the index
+  const Range *find(int64_t entry) const;
+
+  const std::vector<Range> &ranges() const { return ranges_; }
+
+  // number of entries in the index
+  int64_t entries() const { return entries_; }
+
+  void clear();
+
+  // writes the index to filename, along with the fingerprint of its input.
+  // Returns false if the file can not be written
+  bool save(const std::string &filename,
+            const FileFingerprint &fingerprint) const;
+
+  // reads an index written by save(). If the file can't be read, is malformed
+  // or was built from an input that does not match fingerprint, returns false
+  // and the index is left empty
+  bool load(const std::string &filename, const FileFingerprint &fingerprint);
+
+private:
+  std::vector<Range> ranges_;
+  int64_t entries_;
+};
+
+} // namespace jetreader
+
+#endif // JETREADER_READER_RUN_INDEX_H
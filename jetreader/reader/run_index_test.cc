@@ -0,0 +1,90 @@
+#include "gtest/gtest.h"
+
+#include "jetreader/reader/run_index.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+jetreader::RunIndex MakeRunIndex() {
+  // run 3 appears twice, in separate places in the chain
+  std::vector<unsigned> runs{1, 1, 1, 2, 3, 3, 4, 4, 4, 4, 3};
+  jetreader::RunIndex index;
+  for (auto run : runs)
+    index.add(run);
+  return index;
+}
+
+TEST(RunIndex, Ranges) {
+  jetreader::RunIndex index = MakeRunIndex();
+  EXPECT_EQ(index.entries(), 11);
+  ASSERT_EQ(index.ranges().size(), 5);
+
+  std::vector<unsigned> runs{1, 2, 3, 4, 3};
+  std::vector<int64_t> ends{3, 4, 6, 10, 11};
+  int64_t begin = 0;
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(index.ranges()[i].run_id, runs[i]);
+    EXPECT_EQ(index.ranges()[i].begin, begin);
+    EXPECT_EQ(index.ranges()[i].end, ends[i]);
+    begin = ends[i];
+  }
+}
+
+TEST(RunIndex, Find) {
+  jetreader::RunIndex index = MakeRunIndex();
+  std::vector<unsigned> runs{1, 1, 1, 2, 3, 3, 4, 4, 4, 4, 3};
+  for (int64_t entry = 0; entry < runs.size(); ++entry) {
+    auto range = index.find(entry);
+    ASSERT_NE(range, nullptr);
+    EXPECT_EQ(range->run_id, runs[entry]);
+    EXPECT_LE(range->begin, entry);
+    EXPECT_GT(range->end, entry);
+  }
+  EXPECT_EQ(index.find(-1), nullptr);
+  EXPECT_EQ(index.find(11), nullptr);
+}
+
+TEST(RunIndex, SaveAndLoad) {
+  std::string filename = "run_index_test_tmp.runindex";
+  jetreader::FileFingerprint fingerprint;
+  fingerprint.size = 12345;
+  fingerprint.mtime = 1500000000;
+  fingerprint.entries = 11;
+
+  jetreader::RunIndex index = MakeRunIndex();
+  ASSERT_TRUE(index.save(filename, fingerprint));
+
+  jetreader::RunIndex loaded;
+  EXPECT_TRUE(loaded.load(filename, fingerprint));
+  ASSERT_EQ(loaded.ranges().size(), index.ranges().size());
+  for (int i = 0; i < index.ranges().size(); ++i) {
+    EXPECT_EQ(loaded.ranges()[i].run_id, index.ranges()[i].run_id);
+    EXPECT_EQ(loaded.ranges()[i].begin, index.ranges()[i].begin);
+    EXPECT_EQ(loaded.ranges()[i].end, index.ranges()[i].end);
+  }
+
+  // an index for a chain with a different number of entries is not used
+  jetreader::FileFingerprint modified = fingerprint;
+  modified.entries = 12;
+  EXPECT_FALSE(loaded.load(filename, modified));
+  EXPECT_EQ(loaded.entries(), 0);
+  EXPECT_TRUE(loaded.ranges().empty());
+
+  // neither is one for a modified input with the same number of entries
+  modified = fingerprint;
+  modified.mtime += 1;
+  EXPECT_FALSE(loaded.load(filename, modified));
+
+  // or a corrupted index
+  std::ofstream out(filename);
+  out << "jetreader_run_index_v3 12345 1500000000 0 11 2\n1 0 3\n2 4 11\n";
+  out.close();
+  EXPECT_FALSE(loaded.load(filename, fingerprint));
+
+  EXPECT_FALSE(
+      loaded.load("run_index_test_missing.runindex", fingerprint));
+
+  remove(filename.c_str());
+}
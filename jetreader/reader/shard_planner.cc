@@ -0,0 +1,104 @@
+#include "jetreader/reader/shard_planner.h"
+#include "jetreader/lib/assert.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace jetreader {
+
+ShardPlanner::ShardPlanner(double rejected_cost)
+    : entries_(0), cost_(0.0), rejected_cost_(rejected_cost) {
+  JETREADER_ASSERT(rejected_cost_ >= 0.0,
+                   "cost of rejected entries can not be negative: ",
+                   rejected_cost_);
+}
+
+void ShardPlanner::addEntries(int64_t entries, double good_fraction) {
+  JETREADER_ASSERT(entries >= 0, "number of entries can not be negative");
+  JETREADER_ASSERT(good_fraction >= 0.0 && good_fraction <= 1.0,
+                   "good run fraction must be in [0, 1], received ",
+                   good_fraction);
+  addSegment(entries,
+             good_fraction + (1.0 - good_fraction) * rejected_cost_);
+}
+
+void ShardPlanner::addRuns(const RunIndex &index,
+                           const std::set<unsigned> &bad_runs) {
+  for (auto &range : index.ranges()) {
+    bool bad = bad_runs.find(range.run_id) != bad_runs.end();
+    addSegment(range.end - range.begin, bad ? rejected_cost_ : 1.0);
+  }
+}
+
+void ShardPlanner::addSegment(int64_t entries, double weight) {
+  if (entries == 0)
+    return;
+  Segment segment;
+  segment.begin = entries_;
+  segment.end = entries_ + entries;
+  segment.weight = weight;
+  segment.cost_before = cost_;
+  segments_.push_back(segment);
+  entries_ += entries;
+  cost_ += weight * entries;
+}
+
+ShardPlanner::Shard ShardPlanner::shard(unsigned index, unsigned count) const {
+  JETREADER_ASSERT(count > 0, "number of shards must be positive");
+  JETREADER_ASSERT(index < count, "shard index ", index,
+                   " out of range: there are ", count, " shards");
+  Shard shard;
+  shard.begin = boundary(index, count);
+  shard.end = boundary(index + 1, count);
+  shard.cost = costBefore(shard.end) - costBefore(shard.begin);
+  return shard;
+}
+
+std::vector<ShardPlanner::Shard> ShardPlanner::plan(unsigned count) const {
+  std::vector<Shard> shards;
+  for (unsigned i = 0; i < count; ++i)
+    shards.push_back(shard(i, count));
+  return shards;
+}
+
+void ShardPlanner::clear() {
+  segments_.clear();
+  entries_ = 0;
+  cost_ = 0.0;
+}
+
+int64_t ShardPlanner::boundary(unsigned index, unsigned count) const {
+  // the first and last boundaries are exact, regardless of rounding
+  if (index == 0)
+    return 0;
+  if (index >= count)
+    return entries_;
+
+  // the shard starts at the first entry at which the cumulative cost reaches
+  // its share of the total
+  double target = cost_ * index / count;
+  auto segment = std::upper_bound(
+      segments_.begin(), segments_.end(), target,
+      [](double value, const Segment &s) {
+        return value < s.cost_before + s.weight * (s.end - s.begin);
+      });
+  if (segment == segments_.end())
+    return entries_;
+  if (segment->weight <= 0.0)
+    return segment->begin;
+  double offset = std::ceil((target - segment->cost_before) / segment->weight);
+  return std::min(segment->end,
+                  segment->begin + std::max<int64_t>(0, offset));
+}
+
+double ShardPlanner::costBefore(int64_t entry) const {
+  auto segment = std::upper_bound(
+      segments_.begin(), segments_.end(), entry,
+      [](int64_t value, const Segment &s) { return value < s.end; });
+  if (segment == segments_.end())
+    return cost_;
+  return segment->cost_before +
+         segment->weight * std::max<int64_t>(0, entry - segment->begin);
+}
+
+} // namespace jetreader
@@ -0,0 +1,77 @@
+#ifndef JETREADER_READER_SHARD_PLANNER_H
+#define JETREADER_READER_SHARD_PLANNER_H
+
+#include "jetreader/reader/run_index.h"
+
+#include <cstdint>
+#include <set>
+#include <vector>
+
+namespace jetreader {
+
+// splits a chain into contiguous entry ranges ("shards") of roughly equal
+// processing cost, for batch jobs. Entries are described as segments with a
+// cost per entry: an entry in a good run costs 1, an entry in a rejected run
+// costs rejectedCost(), since it is skipped after reading its header (or
+// without reading anything, when the Reader uses a RunIndex).
+//
+// The plan is deterministic, and the shards of a plan cover every entry of the
+// chain exactly once, in order.
+class ShardPlanner {
+public:
+  struct Shard {
+    int64_t begin;
+    int64_t end;
+    // estimated cost of the shard, in units of good entries
+    double cost;
+  };
+
+  explicit ShardPlanner(double rejected_cost = 0.05);
+
+  // appends entries to the chain, of which a fraction good_fraction is
+  // expected to be in good runs
+  void addEntries(int64_t entries, double good_fraction = 1.0);
+
+  // appends the entries covered by a RunIndex. Entries in bad_runs are
+  // rejected
+  void addRuns(const RunIndex &index, const std::set<unsigned> &bad_runs);
+
+  int64_t entries() const { return entries_; }
+  double cost() const { return cost_; }
+  double rejectedCost() const { return rejected_cost_; }
+
+  // shard index of count. Shards can be empty if count is larger than the
+  // number of entries
+  Shard shard(unsigned index, unsigned count) const;
+
+  // all count shards
+  std::vector<Shard> plan(unsigned count) const;
+
+  void clear();
+
+private:
+  struct Segment {
+    int64_t begin;
+    int64_t end;
+    double weight;
+    // total cost of all preceding segments
+    double cost_before;
+  };
+
+  void addSegment(int64_t entries, double weight);
+
+  // first entry of shard index of count
+  int64_t boundary(unsigned index, unsigned count) const;
+
+  // cost of the entries [0, entry)
+  double costBefore(int64_t entry) const;
+
+  std::vector<Segment> segments_;
+  int64_t entries_;
+  double cost_;
+  double rejected_cost_;
+};
+
+} // namespace jetreader
+
+#endif // JETREADER_READER_SHARD_PLANNER_H
@@ -0,0 +1,99 @@
+#include "gtest/gtest.h"
+
+#include "jetreader/lib/assert.h"
+#include "jetreader/reader/run_index.h"
+#include "jetreader/reader/shard_planner.h"
+
+#include <set>
+#include <vector>
+
+// checks that the shards cover [0, entries) exactly once, in order
+void ExpectShardsCoverChain(
+    const std::vector<jetreader::ShardPlanner::Shard> &shards,
+    int64_t entries) {
+  int64_t next = 0;
+  for (auto &shard : shards) {
+    EXPECT_EQ(shard.begin, next);
+    EXPECT_GE(shard.end, shard.begin);
+    next = shard.end;
+  }
+  EXPECT_EQ(next, entries);
+}
+
+TEST(ShardPlanner, UniformEntries) {
+  jetreader::ShardPlanner planner;
+  // files of very different sizes
+  planner.addEntries(10);
+  planner.addEntries(1000);
+  planner.addEntries(37);
+  EXPECT_EQ(planner.entries(), 1047);
+
+  for (unsigned count : {1, 2, 3, 7, 100, 1047, 2000}) {
+    auto shards = planner.plan(count);
+    ASSERT_EQ(shards.size(), count);
+    ExpectShardsCoverChain(shards, 1047);
+    for (auto &shard : shards) {
+      int64_t size = shard.end - shard.begin;
+      EXPECT_LE(size, 1047 / count + 1);
+      EXPECT_GE(size, 1047 / count);
+    }
+  }
+}
+
+TEST(ShardPlanner, GoodRunFraction) {
+  jetreader::ShardPlanner planner(0.0);
+  // the first file is only half good, so it costs half as much per entry
+  planner.addEntries(400, 0.5);
+  planner.addEntries(200, 1.0);
+  EXPECT_DOUBLE_EQ(planner.cost(), 400.0);
+
+  auto shards = planner.plan(2);
+  ExpectShardsCoverChain(shards, 600);
+  EXPECT_EQ(shards[0].end, 400);
+  EXPECT_DOUBLE_EQ(shards[0].cost, 200.0);
+  EXPECT_DOUBLE_EQ(shards[1].cost, 200.0);
+}
+
+TEST(ShardPlanner, BadRuns) {
+  jetreader::RunIndex index;
+  std::vector<std::pair<unsigned, int>> runs{
+      {1, 100}, {2, 500}, {3, 100}, {4, 100}, {2, 100}};
+  for (auto &run : runs)
+    for (int i = 0; i < run.second; ++i)
+      index.add(run.first);
+
+  jetreader::ShardPlanner planner(0.1);
+  planner.addRuns(index, std::set<unsigned>{2});
+  EXPECT_EQ(planner.entries(), 900);
+  EXPECT_DOUBLE_EQ(planner.cost(), 300 + 0.1 * 600);
+
+  for (unsigned count : {2, 3, 4, 9}) {
+    auto shards = planner.plan(count);
+    ExpectShardsCoverChain(shards, 900);
+    // shards are balanced to within one good entry
+    for (auto &shard : shards)
+      EXPECT_NEAR(shard.cost, planner.cost() / count, 1.0);
+  }
+
+  // the plan is deterministic
+  jetreader::ShardPlanner other(0.1);
+  other.addRuns(index, std::set<unsigned>{2});
+  for (unsigned i = 0; i < 4; ++i) {
+    EXPECT_EQ(planner.shard(i, 4).begin, other.shard(i, 4).begin);
+    EXPECT_EQ(planner.shard(i, 4).end, other.shard(i, 4).end);
+  }
+}
+
+TEST(ShardPlanner, Errors) {
+  jetreader::ShardPlanner planner;
+  planner.addEntries(10);
+  EXPECT_THROW(planner.shard(0, 0), jetreader::AssertionFailure);
+  EXPECT_THROW(planner.shard(3, 3), jetreader::AssertionFailure);
+  EXPECT_THROW(planner.addEntries(10, 1.5), jetreader::AssertionFailure);
+  EXPECT_THROW(jetreader::ShardPlanner(-1.0), jetreader::AssertionFailure);
+
+  // an empty chain has empty shards
+  jetreader::ShardPlanner empty;
+  auto shards = empty.plan(3);
+  ExpectShardsCoverChain(shards, 0);
+}
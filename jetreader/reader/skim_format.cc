@@ -0,0 +1,14 @@
+#include "jetreader/reader/skim_format.h"
+
+namespace jetreader {
+
+uint64_t SkimConfigKey(const std::string &config) {
+  uint64_t hash = 14695981039346656037ull;
+  for (unsigned char c : config) {
+    hash ^= c;
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+} // namespace jetreader
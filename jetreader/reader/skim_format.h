@@ -0,0 +1,122 @@
+#ifndef JETREADER_READER_SKIM_FORMAT_H
+#define JETREADER_READER_SKIM_FORMAT_H
+
+// binary layout of jetreader skim files, written by the SkimWriter and read by
+// the SkimReader. A skim file contains:
+//
+// SkimFileHeader
+// the reader config, as YAML (SkimFileHeader::config_size bytes)
+// for each event, starting at a multiple of SKIM_ALIGNMENT:
+//   SkimEventHeader
+//   SkimConstituent x SkimEventHeader::n_constituents
+//   uint32_t x SkimEventHeader::n_matched - matched track indices of all towers
+//   uint32_t x SkimEventHeader::n_triggers - trigger IDs
+// the event index, starting at a multiple of SKIM_ALIGNMENT:
+//   uint64_t x SkimFileFooter::n_events - file offset of each event
+// SkimFileFooter
+//
+// Every record is aligned, so a memory-mapped skim can be read in place (see
+// MappedSkim). All values are stored in the byte order of the machine that
+// wrote the file.
+
+#include <cstdint>
+#include <string>
+
+namespace jetreader {
+
+const uint32_t SKIM_MAGIC = 0x4b534a52; // "RJSK"
+const uint32_t SKIM_VERSION = 3;
+// alignment of event records and of the event index, in bytes
+const uint64_t SKIM_ALIGNMENT = 8;
+
+struct SkimFileHeader {
+  uint32_t magic;
+  uint32_t version;
+  // SkimConfigKey() of the config
+  uint64_t config_key;
+  uint64_t config_size;
+};
+
+// written when the SkimWriter is closed. A skim without a footer is incomplete
+struct SkimFileFooter {
+  uint64_t n_events;
+  uint64_t index_offset;
+  uint32_t magic;
+  uint32_t version;
+};
+
+struct SkimEventHeader {
+  int64_t entry;
+  double refmultcorr;
+  double weight;
+  int32_t run_id;
+  int32_t event_id;
+  int32_t centrality16;
+  int32_t centrality9;
+  float vx;
+  float vy;
+  float vz;
+  float vz_vpd;
+  float zdcx;
+  float bfield;
+  int32_t refmult;
+  int32_t refmult2;
+  int32_t refmult3;
+  int32_t refmult4;
+  int32_t grefmult;
+  uint32_t n_constituents;
+  uint32_t n_matched;
+  uint32_t n_triggers;
+};
+
+// a selected track or tower. The four-vector and the derived track and tower
+// quantities are stored in double precision, as they are computed by the
+// Reader, so that a replayed event reproduces its PseudoJets exactly
+struct SkimConstituent {
+  double px;
+  double py;
+  double pz;
+  double e;
+  double dca;
+  double tower_raw_e;
+  double tower_raw_eta;
+  // StPicoTrack::id() for tracks, tower ID for towers
+  uint32_t index;
+  int32_t matched_tower;
+  uint16_t nhits;
+  uint16_t nhits_poss;
+  uint16_t tower_adc;
+  // number of matched tracks of a tower, stored after the constituents
+  uint16_t n_matched;
+  int8_t charge;
+  // a VectorType
+  uint8_t type;
+  uint8_t padding[6];
+};
+
+static_assert(sizeof(SkimFileHeader) == 24, "unexpected SkimFileHeader size");
+static_assert(sizeof(SkimFileFooter) == 24, "unexpected SkimFileFooter size");
+static_assert(sizeof(SkimEventHeader) == 96,
+              "unexpected SkimEventHeader size");
+static_assert(sizeof(SkimConstituent) == 80,
+              "unexpected SkimConstituent size");
+
+// size of an event record, without the padding that follows it
+inline uint64_t SkimEventSize(const SkimEventHeader &header) {
+  return sizeof(SkimEventHeader) +
+         sizeof(SkimConstituent) * uint64_t(header.n_constituents) +
+         sizeof(uint32_t) * (uint64_t(header.n_matched) + header.n_triggers);
+}
+
+// rounds a file offset up to the next multiple of SKIM_ALIGNMENT
+inline uint64_t SkimAlign(uint64_t offset) {
+  return (offset + SKIM_ALIGNMENT - 1) / SKIM_ALIGNMENT * SKIM_ALIGNMENT;
+}
+
+// 64 bit FNV-1a hash of a reader config, used to check that a skim was made
+// with a given config
+uint64_t SkimConfigKey(const std::string &config);
+
+} // namespace jetreader
+
+#endif // JETREADER_READER_SKIM_FORMAT_H
@@ -0,0 +1,88 @@
+#include "jetreader/reader/skim_reader.h"
+#include "jetreader/lib/assert.h"
+#include "jetreader/reader/event_view.h"
+#include "jetreader/reader/vector_info.h"
+
+namespace jetreader {
+
+SkimReader::SkimReader(const std::string &filename)
+    : skim_(filename), next_(0), record_(), empty_header_() {
+  record_.header = &empty_header_;
+}
+
+bool SkimReader::next() {
+  if (next_ >= skim_.size())
+    return false;
+  readEvent(next_);
+  return true;
+}
+
+void SkimReader::readEvent(size_t i) {
+  record_ = skim_.event(i);
+  next_ = i + 1;
+  makeEvent();
+}
+
+void SkimReader::makeEvent() {
+  const SkimEventHeader &header = *record_.header;
+  event_.setRunId(header.run_id);
+  event_.setEventId(header.event_id);
+  event_.setPrimaryVertexPosition(header.vx, header.vy, header.vz);
+  event_.setVzVpd(header.vz_vpd);
+  event_.setZDCx(header.zdcx);
+  event_.setBField(header.bfield);
+
+  // only the sums of the refmult components are stored
+  event_.setRefMultPos(header.refmult);
+  event_.setRefMultNeg(0);
+  event_.setRefMult2PosEast(header.refmult2);
+  event_.setRefMult2NegEast(0);
+  event_.setRefMult2PosWest(0);
+  event_.setRefMult2NegWest(0);
+  event_.setRefMult3PosEast(header.refmult3);
+  event_.setRefMult3NegEast(0);
+  event_.setRefMult3PosWest(0);
+  event_.setRefMult3NegWest(0);
+  event_.setRefMult4PosEast(header.refmult4);
+  event_.setRefMult4NegEast(0);
+  event_.setRefMult4PosWest(0);
+  event_.setRefMult4NegWest(0);
+  event_.setGRefMult(header.grefmult);
+  event_.setTriggerIds(std::vector<unsigned int>(record_.triggers.begin(),
+                                                 record_.triggers.end()));
+
+  // the old PseudoJets are cleared first, so that their VectorInfos can be
+  // reused
+  pseudojets_.clear();
+  pseudojets_.resize(record_.constituents.size());
+  info_pool_.reset();
+  size_t matched_offset = 0;
+  for (size_t i = 0; i < record_.constituents.size(); ++i) {
+    const SkimConstituent &constituent = record_.constituents[i];
+    fastjet::PseudoJet &j = pseudojets_[i];
+    j.reset(constituent.px, constituent.py, constituent.pz, constituent.e);
+
+    VectorInfo &info = info_pool_.attach(j);
+    if (constituent.type == static_cast<uint8_t>(VectorType::tower)) {
+      JETREADER_ASSERT(matched_offset + constituent.n_matched <=
+                           record_.matched.size(),
+                       "corrupted skim file ", skim_.filename(), ": event ",
+                       header.entry, " has too few matched tracks");
+      matched_scratch_.assign(record_.matched.begin() + matched_offset,
+                              record_.matched.begin() + matched_offset +
+                                  constituent.n_matched);
+      matched_offset += constituent.n_matched;
+      info.setTower(constituent.index, constituent.tower_adc,
+                    constituent.tower_raw_eta, constituent.tower_raw_e,
+                    matched_scratch_);
+    } else {
+      info.setTrack(constituent.index,
+                    constituent.type ==
+                        static_cast<uint8_t>(VectorType::primaryTrack),
+                    constituent.charge, constituent.dca, constituent.nhits,
+                    constituent.nhits_poss, constituent.matched_tower);
+    }
+  }
+}
+
+} // namespace jetreader
@@ -0,0 +1,90 @@
+#ifndef JETREADER_READER_SKIM_READER_H
+#define JETREADER_READER_SKIM_READER_H
+
+#include "jetreader/lib/span.h"
+#include "jetreader/reader/mapped_skim.h"
+#include "jetreader/reader/skim_format.h"
+#include "jetreader/reader/vector_info_pool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "StPicoEvent/StPicoEvent.h"
+
+#include "fastjet/PseudoJet.hh"
+
+namespace jetreader {
+
+// replays a skim file written by the SkimWriter. Events are read sequentially
+// with next(), and the current event is accessed through the same methods as
+// with the Reader: event(), pseudojets(), centrality16(), etc. The skim is
+// memory-mapped (see MappedSkim): the raw event record is read in place, and
+// only event() and pseudojets() are built from it.
+class SkimReader {
+public:
+  // opens a skim file. If the file can't be opened or is not a skim file, an
+  // exception is raised
+  SkimReader(const std::string &filename);
+
+  // the reader config the skim was made with, as YAML
+  const std::string &config() const { return skim_.config(); }
+  uint64_t configKey() const { return skim_.configKey(); }
+
+  // true if the skim was made with the given config (as returned by
+  // Reader::configString())
+  bool matchesConfig(const std::string &config) const {
+    return skim_.matchesConfig(config);
+  }
+
+  // number of events in the skim
+  size_t entries() const { return skim_.size(); }
+
+  // reads the next event. Returns false at the end of the file
+  bool next();
+
+  // goes back to the first event
+  void rewind() { next_ = 0; }
+
+  // reads event i of the skim
+  void readEvent(size_t i);
+
+  // header of the current event. Only the quantities stored in the skim are
+  // set: run and event ID, vertex, VPD vz, refmult variants, ZDCx, magnetic
+  // field and trigger IDs
+  StPicoEvent *event() { return &event_; }
+
+  // selected tracks and towers of the current event, with VectorInfo
+  std::vector<fastjet::PseudoJet> &pseudojets() { return pseudojets_; }
+
+  // raw event record, read in place from the mapped file
+  const SkimEventHeader &header() const { return *record_.header; }
+  Span<const SkimConstituent> constituents() const {
+    return record_.constituents;
+  }
+
+  int64_t currentEntry() const { return record_.header->entry; }
+  int centrality16() const { return record_.header->centrality16; }
+  int centrality9() const { return record_.header->centrality9; }
+  double refMultCorr() const { return record_.header->refmultcorr; }
+  double centralityWeight() const { return record_.header->weight; }
+
+private:
+  void makeEvent();
+
+  MappedSkim skim_;
+  size_t next_;
+  SkimEventRecord record_;
+  // header of record_ before the first event is read
+  SkimEventHeader empty_header_;
+
+  StPicoEvent event_;
+  std::vector<fastjet::PseudoJet> pseudojets_;
+  VectorInfoPool info_pool_;
+  std::vector<unsigned> matched_scratch_;
+};
+
+} // namespace jetreader
+
+#endif // JETREADER_READER_SKIM_READER_H
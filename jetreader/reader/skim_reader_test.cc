@@ -0,0 +1,126 @@
+#include "gtest/gtest.h"
+
+#include "jetreader/reader/processed_event.h"
+#include "jetreader/reader/reader_utils.h"
+#include "jetreader/reader/skim_reader.h"
+#include "jetreader/reader/skim_writer.h"
+#include "jetreader/reader/vector_info.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "StPicoEvent/StPicoBTowHit.h"
+#include "StPicoEvent/StPicoEvent.h"
+#include "StPicoEvent/StPicoTrack.h"
+
+#include "TVector3.h"
+
+jetreader::ProcessedEvent MakeSkimTestEvent(int i) {
+  jetreader::ProcessedEvent event;
+  event.entry = 10 * i;
+  event.header.setRunId(15095020);
+  event.header.setEventId(i);
+  event.header.setPrimaryVertexPosition(0.1, 0.2, -5.0 + i);
+  event.header.setVzVpd(-4.5 + i);
+  event.header.setRefMultPos(100 + i);
+  event.header.setRefMultNeg(50);
+  event.header.setZDCx(20000.0);
+  event.header.setTriggerIds({450005, 450015});
+  event.refmultcorr = 140.5 + i;
+  event.centrality16 = 3;
+  event.centrality9 = 2;
+  event.weight = 0.9;
+
+  TVector3 vertex(0.1, 0.2, -5.0 + i);
+  for (int j = 0; j < 5 + i; ++j) {
+    StPicoTrack track;
+    track.setId(j);
+    track.setPrimaryMomentum(TVector3(1.0 + j, 0.5 * j, 0.2 * j - 0.5));
+    track.setGlobalMomentum(TVector3(1.0 + j, 0.5 * j, 0.2 * j - 0.5));
+    track.setOrigin(TVector3(0.2, 0.3, -5.0 + i));
+    track.setNHitsFit(20 + j);
+    track.setNHitsPossible(40);
+    event.pseudojets.push_back(jetreader::MakePseudoJet(track, vertex));
+  }
+  for (int j = 0; j < 3; ++j) {
+    StPicoBTowHit tower;
+    tower.setAdc(30 + j);
+    tower.setEnergy(2.0 + j);
+    std::vector<unsigned> matched(j, j);
+    event.pseudojets.push_back(jetreader::MakePseudoJet(
+        tower, 100 + j, 0.1 * j, 0.5 * j, 0.1 * j + 0.01, 1.5 + j, matched));
+  }
+  return event;
+}
+
+TEST(SkimReader, RoundTrip) {
+  std::string filename = "skim_reader_test_tmp.skim";
+  std::string config = "reader:\n  usePrimary: true\n";
+
+  std::vector<jetreader::ProcessedEvent> events;
+  {
+    jetreader::SkimWriter writer(filename, config);
+    for (int i = 0; i < 4; ++i) {
+      events.push_back(MakeSkimTestEvent(i));
+      writer.write(events.back());
+    }
+    EXPECT_EQ(writer.events(), 4);
+  }
+
+  jetreader::SkimReader reader(filename);
+  EXPECT_EQ(reader.config(), config);
+  EXPECT_TRUE(reader.matchesConfig(config));
+  EXPECT_FALSE(reader.matchesConfig("reader:\n  usePrimary: false\n"));
+
+  // replay twice, to check rewind()
+  for (int pass = 0; pass < 2; ++pass) {
+    int n_events = 0;
+    while (reader.next()) {
+      auto &expected = events[n_events++];
+      EXPECT_EQ(reader.currentEntry(), expected.entry);
+      EXPECT_EQ(reader.event()->runId(), expected.header.runId());
+      EXPECT_EQ(reader.event()->eventId(), expected.header.eventId());
+      EXPECT_NEAR(reader.event()->primaryVertex().Z(),
+                  expected.header.primaryVertex().Z(), 1e-5);
+      EXPECT_EQ(reader.event()->refMult(), expected.header.refMult());
+      EXPECT_TRUE(reader.event()->isTrigger(450015));
+      EXPECT_EQ(reader.centrality16(), expected.centrality16);
+      EXPECT_EQ(reader.centrality9(), expected.centrality9);
+      EXPECT_NEAR(reader.refMultCorr(), expected.refmultcorr, 1e-5);
+      EXPECT_NEAR(reader.centralityWeight(), expected.weight, 1e-5);
+
+      auto &jets = reader.pseudojets();
+      ASSERT_EQ(jets.size(), expected.pseudojets.size());
+      for (size_t j = 0; j < jets.size(); ++j) {
+        auto &jet = jets[j];
+        auto &expected_jet = expected.pseudojets[j];
+        // the replayed four-vectors are exact
+        EXPECT_EQ(jet.px(), expected_jet.px());
+        EXPECT_EQ(jet.py(), expected_jet.py());
+        EXPECT_EQ(jet.pz(), expected_jet.pz());
+        EXPECT_EQ(jet.e(), expected_jet.e());
+        EXPECT_EQ(jet.pt(), expected_jet.pt());
+        EXPECT_EQ(jet.eta(), expected_jet.eta());
+        EXPECT_EQ(jet.phi(), expected_jet.phi());
+
+        auto &info = jet.user_info<jetreader::VectorInfo>();
+        auto &expected_info = expected_jet.user_info<jetreader::VectorInfo>();
+        EXPECT_EQ(info.isPrimary(), expected_info.isPrimary());
+        EXPECT_EQ(info.isBemcTower(), expected_info.isBemcTower());
+        EXPECT_EQ(info.trackId(), expected_info.trackId());
+        EXPECT_EQ(info.dca(), expected_info.dca());
+        EXPECT_EQ(info.nhits(), expected_info.nhits());
+        EXPECT_EQ(info.towerId(), expected_info.towerId());
+        EXPECT_EQ(info.towerAdc(), expected_info.towerAdc());
+        EXPECT_EQ(info.towerRawE(), expected_info.towerRawE());
+        EXPECT_EQ(info.towerRawEta(), expected_info.towerRawEta());
+        EXPECT_EQ(info.matchedTracks(), expected_info.matchedTracks());
+      }
+    }
+    EXPECT_EQ(n_events, events.size());
+    reader.rewind();
+  }
+
+  remove(filename.c_str());
+}
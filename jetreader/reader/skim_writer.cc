@@ -0,0 +1,153 @@
+#include "jetreader/reader/skim_writer.h"
+#include "jetreader/lib/assert.h"
+#include "jetreader/reader/event_view.h"
+#include "jetreader/reader/reader.h"
+#include "jetreader/reader/vector_info.h"
+
+namespace jetreader {
+
+SkimWriter::SkimWriter(const std::string &filename, Reader &reader)
+    : events_(0), offset_(0) {
+  open(filename, reader.configString());
+}
+
+SkimWriter::SkimWriter(const std::string &filename, const std::string &config)
+    : events_(0), offset_(0) {
+  open(filename, config);
+}
+
+SkimWriter::~SkimWriter() { close(); }
+
+void SkimWriter::open(const std::string &filename, const std::string &config) {
+  out_.open(filename, std::ios::binary);
+  JETREADER_ASSERT(out_.good(), "could not open skim file ", filename,
+                   " for writing");
+
+  SkimFileHeader header;
+  header.magic = SKIM_MAGIC;
+  header.version = SKIM_VERSION;
+  header.config_key = SkimConfigKey(config);
+  header.config_size = config.size();
+  out_.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  out_.write(config.data(), config.size());
+  offset_ = sizeof(header) + config.size();
+  align();
+}
+
+void SkimWriter::write(Reader &reader) {
+  writeEvent(reader.currentEntry(), *reader.event(), reader.pseudojets(),
+             reader.refMultCorr(), reader.centrality16(), reader.centrality9(),
+             reader.centralityWeight());
+}
+
+void SkimWriter::write(const ProcessedEvent &event) {
+  writeEvent(event.entry, event.header, event.pseudojets, event.refmultcorr,
+             event.centrality16, event.centrality9, event.weight);
+}
+
+void SkimWriter::close() {
+  if (!out_.is_open())
+    return;
+
+  SkimFileFooter footer;
+  footer.n_events = index_.size();
+  footer.index_offset = offset_;
+  footer.magic = SKIM_MAGIC;
+  footer.version = SKIM_VERSION;
+  out_.write(reinterpret_cast<const char *>(index_.data()),
+             sizeof(uint64_t) * index_.size());
+  out_.write(reinterpret_cast<const char *>(&footer), sizeof(footer));
+  out_.close();
+}
+
+void SkimWriter::align() {
+  static const char zeros[SKIM_ALIGNMENT] = {0};
+  uint64_t aligned = SkimAlign(offset_);
+  out_.write(zeros, aligned - offset_);
+  offset_ = aligned;
+}
+
+void SkimWriter::writeEvent(int64_t entry, const StPicoEvent &header,
+                            const std::vector<fastjet::PseudoJet> &pseudojets,
+                            double refmultcorr, int centrality16,
+                            int centrality9, double weight) {
+  JETREADER_ASSERT(out_.is_open(), "skim file is closed: can't write event");
+
+  constituents_.clear();
+  matched_.clear();
+  for (auto &pseudojet : pseudojets) {
+    JETREADER_ASSERT(pseudojet.has_user_info<VectorInfo>(),
+                     "PseudoJet without VectorInfo can't be skimmed");
+    auto &info = pseudojet.user_info<VectorInfo>();
+
+    SkimConstituent constituent = SkimConstituent();
+    constituent.px = pseudojet.px();
+    constituent.py = pseudojet.py();
+    constituent.pz = pseudojet.pz();
+    constituent.e = pseudojet.e();
+    if (info.isBemcTower()) {
+      constituent.type = static_cast<uint8_t>(VectorType::tower);
+      constituent.index = info.towerId();
+      constituent.tower_adc = info.towerAdc();
+      constituent.tower_raw_e = info.towerRawE();
+      constituent.tower_raw_eta = info.towerRawEta();
+      constituent.n_matched = info.matchedTracks().size();
+      matched_.insert(matched_.end(), info.matchedTracks().begin(),
+                      info.matchedTracks().end());
+    } else {
+      constituent.type =
+          static_cast<uint8_t>(info.isPrimary() ? VectorType::primaryTrack
+                                                : VectorType::globalTrack);
+      constituent.index = info.trackId();
+      constituent.charge = info.charge();
+      constituent.dca = info.dca();
+      constituent.nhits = info.nhits();
+      constituent.nhits_poss = info.nhitsPoss();
+      constituent.matched_tower = info.matchedTower();
+    }
+    constituents_.push_back(constituent);
+  }
+
+  std::vector<unsigned int> triggers = header.triggerIds();
+  TVector3 vertex = header.primaryVertex();
+
+  SkimEventHeader event = SkimEventHeader();
+  event.entry = entry;
+  event.refmultcorr = refmultcorr;
+  event.weight = weight;
+  event.run_id = header.runId();
+  event.event_id = header.eventId();
+  event.centrality16 = centrality16;
+  event.centrality9 = centrality9;
+  event.vx = vertex.X();
+  event.vy = vertex.Y();
+  event.vz = vertex.Z();
+  event.vz_vpd = header.vzVpd();
+  event.zdcx = header.ZDCx();
+  event.bfield = header.bField();
+  event.refmult = header.refMult();
+  event.refmult2 = header.refMult2();
+  event.refmult3 = header.refMult3();
+  event.refmult4 = header.refMult4();
+  event.grefmult = header.grefMult();
+  event.n_constituents = constituents_.size();
+  event.n_matched = matched_.size();
+  event.n_triggers = triggers.size();
+
+  index_.push_back(offset_);
+  out_.write(reinterpret_cast<const char *>(&event), sizeof(event));
+  out_.write(reinterpret_cast<const char *>(constituents_.data()),
+             sizeof(SkimConstituent) * constituents_.size());
+  out_.write(reinterpret_cast<const char *>(matched_.data()),
+             sizeof(uint32_t) * matched_.size());
+  for (auto trigger : triggers) {
+    uint32_t id = trigger;
+    out_.write(reinterpret_cast<const char *>(&id), sizeof(id));
+  }
+  offset_ += SkimEventSize(event);
+  align();
+  JETREADER_ASSERT(out_.good(), "failed to write event to skim file");
+  ++events_;
+}
+
+} // namespace jetreader
@@ -0,0 +1,70 @@
+#ifndef JETREADER_READER_SKIM_WRITER_H
+#define JETREADER_READER_SKIM_WRITER_H
+
+#include "jetreader/reader/processed_event.h"
+#include "jetreader/reader/skim_format.h"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "StPicoEvent/StPicoEvent.h"
+
+#include "fastjet/PseudoJet.hh"
+
+namespace jetreader {
+
+class Reader;
+
+// writes accepted events - the event header, centrality information and the
+// selected, corrected tracks and towers with their VectorInfo - to a skim file
+// (see skim_format.h), which can be replayed with the SkimReader without
+// repeating event processing. The skim is stamped with the reader's config.
+class SkimWriter {
+public:
+  // opens filename for writing, and records the config of reader. If the file
+  // can not be opened, an exception is raised
+  SkimWriter(const std::string &filename, Reader &reader);
+  SkimWriter(const std::string &filename, const std::string &config);
+
+  ~SkimWriter();
+
+  // writes the current event of the reader
+  void write(Reader &reader);
+
+  // writes an event taken from a Reader or ParallelReader
+  void write(const ProcessedEvent &event);
+
+  // writes the event index and closes the file. Called by the destructor. A
+  // skim can only be read once it has been closed
+  void close();
+
+  size_t events() const { return events_; }
+
+private:
+  void open(const std::string &filename, const std::string &config);
+
+  void writeEvent(int64_t entry, const StPicoEvent &header,
+                  const std::vector<fastjet::PseudoJet> &pseudojets,
+                  double refmultcorr, int centrality16, int centrality9,
+                  double weight);
+
+  // writes the padding needed to align the next record
+  void align();
+
+  std::ofstream out_;
+  size_t events_;
+  // current position in the file
+  uint64_t offset_;
+  // file offset of each event
+  std::vector<uint64_t> index_;
+
+  // buffers for the current event, reused between events
+  std::vector<SkimConstituent> constituents_;
+  std::vector<uint32_t> matched_;
+};
+
+} // namespace jetreader
+
+#endif // JETREADER_READER_SKIM_WRITER_H
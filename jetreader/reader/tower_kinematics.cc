@@ -0,0 +1,27 @@
+#include "jetreader/reader/tower_kinematics.h"
+
+#include <cmath>
+
+namespace jetreader {
+
+TowerKinematics::TowerKinematics()
+    : eta_(bemc_helper_.towerEtas()), phi_(bemc_helper_.towerPhis()),
+      ring_(bemc_helper_.towerEtaRings()), initialized_(false), vz_(0.0) {
+  for (unsigned ring = 0; ring < BemcHelper::ETA_RINGS; ++ring)
+    ring_tower_[ring] = bemc_helper_.towerAt(ring, 0);
+}
+
+void TowerKinematics::setVertex(double vz) {
+  if (initialized_ && vz == vz_)
+    return;
+  for (unsigned ring = 0; ring < BemcHelper::ETA_RINGS; ++ring) {
+    corrected_eta_[ring] =
+        bemc_helper_.vertexCorrectedEta(ring_tower_[ring], vz);
+    cosh_eta_[ring] = cosh(corrected_eta_[ring]);
+    inv_cosh_eta_[ring] = 1.0 / cosh_eta_[ring];
+  }
+  vz_ = vz;
+  initialized_ = true;
+}
+
+} // namespace jetreader
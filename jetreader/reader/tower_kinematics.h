@@ -0,0 +1,62 @@
+#ifndef JETREADER_READER_TOWER_KINEMATICS_H
+#define JETREADER_READER_TOWER_KINEMATICS_H
+
+#include "jetreader/reader/bemc_helper.h"
+
+namespace jetreader {
+
+// per-event cache of the vertex corrected BEMC tower kinematics. The vertex
+// corrected eta of a tower only depends on its eta ring and the vertex
+// position along the beam line, so it is computed once per event for each of
+// the 40 rings, along with cosh(eta) and 1 / cosh(eta), instead of once per
+// tower. Shared by the tower selection and the PseudoJet/EventView conversion.
+// Towers are indexed by tower id - 1.
+class TowerKinematics {
+public:
+  TowerKinematics();
+
+  // recomputes the ring quantities for a vertex at vz. Does nothing if vz is
+  // unchanged
+  void setVertex(double vz);
+  double vz() const { return vz_; }
+
+  // uncorrected eta and phi of the tower, as given by the BemcHelper
+  double eta(unsigned tow_idx) const { return eta_[tow_idx]; }
+  double phi(unsigned tow_idx) const { return phi_[tow_idx]; }
+
+  // vertex corrected eta, as given by BemcHelper::vertexCorrectedEta(), and
+  // its cosh. ET computed as E / coshEta() is identical to E / cosh(eta), and
+  // E * invCoshEta() is equal to it up to rounding
+  double correctedEta(unsigned tow_idx) const {
+    return corrected_eta_[ring_[tow_idx]];
+  }
+  double coshEta(unsigned tow_idx) const { return cosh_eta_[ring_[tow_idx]]; }
+  double invCoshEta(unsigned tow_idx) const {
+    return inv_cosh_eta_[ring_[tow_idx]];
+  }
+
+  // the same, for eta ring ring
+  double ringCorrectedEta(unsigned ring) const { return corrected_eta_[ring]; }
+  double ringCoshEta(unsigned ring) const { return cosh_eta_[ring]; }
+  double ringInvCoshEta(unsigned ring) const { return inv_cosh_eta_[ring]; }
+
+  const BemcHelper &bemcHelper() const { return bemc_helper_; }
+
+private:
+  BemcHelper bemc_helper_;
+  Span<const double> eta_;
+  Span<const double> phi_;
+  Span<const unsigned char> ring_;
+
+  bool initialized_;
+  double vz_;
+  // a tower in each ring, from which the ring quantities are computed
+  unsigned ring_tower_[BemcHelper::ETA_RINGS];
+  double corrected_eta_[BemcHelper::ETA_RINGS];
+  double cosh_eta_[BemcHelper::ETA_RINGS];
+  double inv_cosh_eta_[BemcHelper::ETA_RINGS];
+};
+
+} // namespace jetreader
+
+#endif // JETREADER_READER_TOWER_KINEMATICS_H
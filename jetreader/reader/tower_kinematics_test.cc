@@ -0,0 +1,39 @@
+#include "gtest/gtest.h"
+
+#include "jetreader/reader/bemc_helper.h"
+#include "jetreader/reader/tower_kinematics.h"
+
+#include <cmath>
+
+TEST(TowerKinematics, MatchesBemcHelper) {
+  jetreader::BemcHelper helper;
+  jetreader::TowerKinematics kinematics;
+  for (double vz : {-35.2, 0.0, 0.0, 12.7}) {
+    kinematics.setVertex(vz);
+    EXPECT_EQ(kinematics.vz(), vz);
+    for (unsigned id = 1; id <= jetreader::BemcHelper::TOWERS; ++id) {
+      unsigned idx = id - 1;
+      double eta_corr = helper.vertexCorrectedEta(id, vz);
+      EXPECT_EQ(kinematics.eta(idx), helper.towerEta(id));
+      EXPECT_EQ(kinematics.phi(idx), helper.towerPhi(id));
+      EXPECT_EQ(kinematics.correctedEta(idx), eta_corr);
+      EXPECT_EQ(kinematics.coshEta(idx), cosh(eta_corr));
+      EXPECT_NEAR(kinematics.invCoshEta(idx), 1.0 / cosh(eta_corr), 1e-12);
+    }
+  }
+}
+
+TEST(TowerKinematics, Rings) {
+  jetreader::BemcHelper helper;
+  jetreader::TowerKinematics kinematics;
+  kinematics.setVertex(5.0);
+  for (unsigned ring = 0; ring < jetreader::BemcHelper::ETA_RINGS; ++ring) {
+    unsigned id = helper.towerAt(ring, 17);
+    EXPECT_EQ(kinematics.ringCorrectedEta(ring),
+              kinematics.correctedEta(id - 1));
+    EXPECT_EQ(kinematics.ringCoshEta(ring), kinematics.coshEta(id - 1));
+    if (ring > 0)
+      EXPECT_GT(kinematics.ringCorrectedEta(ring),
+                kinematics.ringCorrectedEta(ring - 1));
+  }
+}
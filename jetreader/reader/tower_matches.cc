@@ -0,0 +1,49 @@
+#include "jetreader/reader/tower_matches.h"
+
+#include "jetreader/lib/assert.h"
+
+namespace jetreader {
+
+TowerMatches::TowerMatches(unsigned towers)
+    : count_(towers, 0), offset_(towers, 0) {}
+
+void TowerMatches::add(unsigned tow_idx, unsigned track) {
+  JETREADER_ASSERT(tow_idx < count_.size(), "track ", track,
+                   " is matched to tower index ", tow_idx, ", but there are ",
+                   count_.size(), " towers");
+  if (count_[tow_idx]++ == 0)
+    touched_.push_back(tow_idx);
+  added_tower_.push_back(tow_idx);
+  added_track_.push_back(track);
+}
+
+void TowerMatches::build() {
+  // the start of each tower's range, in the order the towers were touched
+  unsigned offset = 0;
+  for (unsigned tow_idx : touched_) {
+    offset_[tow_idx] = offset;
+    offset += count_[tow_idx];
+  }
+
+  // each match is placed after the previous matches of its tower. offset_ is
+  // used as the insertion point, and moved back to the start of the range
+  // afterwards
+  tracks_.resize(added_track_.size());
+  for (size_t i = 0; i < added_track_.size(); ++i)
+    tracks_[offset_[added_tower_[i]]++] = added_track_[i];
+  for (unsigned tow_idx : touched_)
+    offset_[tow_idx] -= count_[tow_idx];
+}
+
+void TowerMatches::clear() {
+  for (unsigned tow_idx : touched_) {
+    count_[tow_idx] = 0;
+    offset_[tow_idx] = 0;
+  }
+  touched_.clear();
+  added_tower_.clear();
+  added_track_.clear();
+  tracks_.clear();
+}
+
+} // namespace jetreader
@@ -0,0 +1,65 @@
+#ifndef JETREADER_READER_TOWER_MATCHES_H
+#define JETREADER_READER_TOWER_MATCHES_H
+
+#include "jetreader/lib/span.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace jetreader {
+
+// per-event table of the tracks matched to each BEMC tower, used by the
+// hadronic and MIP corrections. The matches of all towers are stored in one
+// array in compressed sparse row layout, sorted by tower with a counting sort
+// once all tracks are known: the matches of tower i are a contiguous range of
+// the array. Only towers with matches are visited by build() and clear(), so
+// the cost per event does not depend on the number of towers. Towers are
+// indexed by tower id - 1.
+class TowerMatches {
+public:
+  // a table for towers with indices in [0, towers)
+  explicit TowerMatches(unsigned towers);
+
+  // records that track is matched to tower tow_idx. Throws an
+  // AssertionFailure if there is no such tower
+  void add(unsigned tow_idx, unsigned track);
+
+  // sorts the recorded matches by tower. Must be called once all matches of
+  // the event are added, before tracks()
+  void build();
+
+  // the tracks matched to tower tow_idx, in the order they were added. Valid
+  // until the next clear()
+  Span<const unsigned> tracks(unsigned tow_idx) const {
+    return Span<const unsigned>(tracks_.data() + offset_[tow_idx],
+                                count_[tow_idx]);
+  }
+  unsigned count(unsigned tow_idx) const { return count_[tow_idx]; }
+
+  // the towers with at least one match, in the order of their first match
+  const std::vector<unsigned> &touched() const { return touched_; }
+
+  // total number of matches
+  size_t size() const { return added_tower_.size(); }
+  unsigned towers() const { return count_.size(); }
+
+  // removes all matches, only resetting the towers that had any
+  void clear();
+
+private:
+  // matches in the order they were added, before build()
+  std::vector<unsigned> added_tower_;
+  std::vector<unsigned> added_track_;
+
+  // per tower - zero for all towers that are not in touched_
+  std::vector<unsigned> count_;
+  std::vector<unsigned> offset_;
+  std::vector<unsigned> touched_;
+
+  // matched tracks, sorted by tower
+  std::vector<unsigned> tracks_;
+};
+
+} // namespace jetreader
+
+#endif // JETREADER_READER_TOWER_MATCHES_H
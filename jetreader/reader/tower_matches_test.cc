@@ -0,0 +1,53 @@
+#include "gtest/gtest.h"
+
+#include "jetreader/lib/assert.h"
+#include "jetreader/reader/tower_matches.h"
+
+#include <vector>
+
+namespace {
+std::vector<unsigned> Tracks(const jetreader::TowerMatches &matches,
+                             unsigned tow_idx) {
+  auto tracks = matches.tracks(tow_idx);
+  return std::vector<unsigned>(tracks.begin(), tracks.end());
+}
+} // namespace
+
+TEST(TowerMatches, Build) {
+  jetreader::TowerMatches matches(10);
+  matches.add(7, 0);
+  matches.add(2, 1);
+  matches.add(7, 3);
+  matches.add(9, 4);
+  matches.add(7, 6);
+  matches.build();
+
+  EXPECT_EQ(matches.size(), 5);
+  EXPECT_EQ(matches.touched(), (std::vector<unsigned>{7, 2, 9}));
+  EXPECT_EQ(Tracks(matches, 7), (std::vector<unsigned>{0, 3, 6}));
+  EXPECT_EQ(Tracks(matches, 2), (std::vector<unsigned>{1}));
+  EXPECT_EQ(Tracks(matches, 9), (std::vector<unsigned>{4}));
+  EXPECT_EQ(matches.count(7), 3);
+  EXPECT_EQ(matches.count(0), 0);
+  EXPECT_TRUE(matches.tracks(0).empty());
+
+  EXPECT_THROW(matches.add(10, 7), jetreader::AssertionFailure);
+}
+
+TEST(TowerMatches, Clear) {
+  jetreader::TowerMatches matches(10);
+  matches.add(4, 1);
+  matches.add(4, 2);
+  matches.build();
+  matches.clear();
+  EXPECT_EQ(matches.size(), 0);
+  EXPECT_TRUE(matches.touched().empty());
+  EXPECT_EQ(matches.count(4), 0);
+
+  // the next event starts from an empty table
+  matches.add(5, 3);
+  matches.add(4, 8);
+  matches.build();
+  EXPECT_EQ(Tracks(matches, 4), (std::vector<unsigned>{8}));
+  EXPECT_EQ(Tracks(matches, 5), (std::vector<unsigned>{3}));
+}
@@ -0,0 +1,273 @@
+#include "benchmark/benchmark.h"
+
+#include "jetreader/lib/memory.h"
+#include "jetreader/reader/bemc_helper.h"
+#include "jetreader/reader/reader_utils.h"
+#include "jetreader/reader/tower_kinematics.h"
+#include "jetreader/reader/tower_selector.h"
+
+#include <random>
+#include <vector>
+
+#include "StPicoEvent/StPicoBTowHit.h"
+
+// compares selecting every BEMC tower of an event through the virtual
+// TowerSelector::select(), as the Reader does for custom selectors, to the
+// TowerSelector::Kernel for the active cuts, as it does for the default
+// selector, with and without cut-flow counting.
+//
+// The tower loop benchmarks select every tower of an event with a new vertex,
+// as Reader::selectTowers() does, computing the vertex corrected eta either
+// per tower, through BemcHelper::vertexCorrectedEta(), or per eta ring,
+// through TowerKinematics. The dense and sparse loops compare selecting
+// every tower of an event in which most towers have no energy to selecting
+// only the towers found by FindTowerHits().
+//
+// The correction benchmarks subtract the momentum of matched tracks from every
+// tower and select it again on its corrected energy, either one tower at a
+// time through the kernel, as Reader::selectTowers() did before, or for all
+// towers at once through TowerSelector::Kernel::selectCorrected().
+
+constexpr unsigned TOWERS = 4800;
+
+struct BenchmarkTowers {
+  std::vector<StPicoBTowHit> towers;
+  std::vector<double> eta;
+};
+
+BenchmarkTowers MakeBenchmarkTowers() {
+  std::mt19937 gen(3);
+  std::exponential_distribution<double> energy(1.0);
+  std::uniform_real_distribution<double> eta(-1.0, 1.0);
+
+  BenchmarkTowers ret;
+  ret.towers.resize(TOWERS);
+  for (auto &tower : ret.towers) {
+    tower.setEnergy(energy(gen));
+    ret.eta.push_back(eta(gen));
+  }
+  return ret;
+}
+
+jetreader::unique_ptr<jetreader::TowerSelector> MakeBenchmarkSelector() {
+  auto selector = jetreader::make_unique<jetreader::TowerSelector>();
+  for (unsigned id = 1; id <= TOWERS; id += 40)
+    selector->addBadTower(id);
+  selector->setEtMin(0.2);
+  selector->setEtMax(30.0);
+  return selector;
+}
+
+static void BM_TowerSelectionVirtual(benchmark::State &state) {
+  BenchmarkTowers towers = MakeBenchmarkTowers();
+  auto selector = MakeBenchmarkSelector();
+  for (auto _ : state) {
+    unsigned accepted = 0;
+    for (unsigned i = 0; i < TOWERS; ++i)
+      accepted += selector->select(&towers.towers[i], i + 1, towers.eta[i]) ==
+                  jetreader::TowerStatus::acceptTower;
+    benchmark::DoNotOptimize(accepted);
+  }
+}
+
+static void BM_TowerSelectionKernel(benchmark::State &state) {
+  BenchmarkTowers towers = MakeBenchmarkTowers();
+  auto selector = MakeBenchmarkSelector();
+  for (auto _ : state) {
+    unsigned accepted = 0;
+    selector->withKernel([&](const auto &kernel) {
+      for (unsigned i = 0; i < TOWERS; ++i)
+        accepted += kernel(towers.towers[i], i + 1, towers.eta[i]) ==
+                    jetreader::TowerStatus::acceptTower;
+    });
+    benchmark::DoNotOptimize(accepted);
+  }
+}
+
+static void BM_TowerSelectionKernelCutFlow(benchmark::State &state) {
+  BenchmarkTowers towers = MakeBenchmarkTowers();
+  auto selector = MakeBenchmarkSelector();
+  selector->cutFlow().setActive(true, state.range(0));
+  for (auto _ : state) {
+    unsigned accepted = 0;
+    selector->withKernel([&](const auto &kernel) {
+      for (unsigned i = 0; i < TOWERS; ++i)
+        accepted += kernel(towers.towers[i], i + 1, towers.eta[i]) ==
+                    jetreader::TowerStatus::acceptTower;
+    });
+    benchmark::DoNotOptimize(accepted);
+  }
+}
+
+static void BM_TowerLoopPerTower(benchmark::State &state) {
+  BenchmarkTowers towers = MakeBenchmarkTowers();
+  auto selector = MakeBenchmarkSelector();
+  jetreader::BemcHelper helper;
+  double vz = -30.0;
+  for (auto _ : state) {
+    vz = vz < 30.0 ? vz + 0.1 : -30.0;
+    double et = 0.0;
+    selector->withKernel([&](const auto &kernel) {
+      for (unsigned i = 0; i < TOWERS; ++i) {
+        double eta = helper.vertexCorrectedEta(i + 1, vz);
+        if (kernel(towers.towers[i], i + 1, eta) ==
+            jetreader::TowerStatus::acceptTower)
+          et += towers.towers[i].energy() / cosh(eta);
+      }
+    });
+    benchmark::DoNotOptimize(et);
+  }
+}
+
+static void BM_TowerLoopPerRing(benchmark::State &state) {
+  BenchmarkTowers towers = MakeBenchmarkTowers();
+  auto selector = MakeBenchmarkSelector();
+  jetreader::TowerKinematics kinematics;
+  double vz = -30.0;
+  for (auto _ : state) {
+    vz = vz < 30.0 ? vz + 0.1 : -30.0;
+    kinematics.setVertex(vz);
+    double et = 0.0;
+    selector->withKernel([&](const auto &kernel) {
+      for (unsigned i = 0; i < TOWERS; ++i) {
+        double cosh_eta = kinematics.coshEta(i);
+        if (kernel(towers.towers[i], i + 1, kinematics.correctedEta(i),
+                   cosh_eta) == jetreader::TowerStatus::acceptTower)
+          et += towers.towers[i].energy() / cosh_eta;
+      }
+    });
+    benchmark::DoNotOptimize(et);
+  }
+}
+
+// an event in which only one tower in occupancy has energy
+BenchmarkTowers MakeSparseTowers(unsigned occupancy) {
+  BenchmarkTowers ret = MakeBenchmarkTowers();
+  for (unsigned i = 0; i < TOWERS; ++i)
+    if (i % occupancy != 0)
+      ret.towers[i].setEnergy(0.0);
+  return ret;
+}
+
+static void BM_TowerLoopDense(benchmark::State &state) {
+  BenchmarkTowers towers = MakeSparseTowers(state.range(0));
+  auto selector = MakeBenchmarkSelector();
+  jetreader::TowerKinematics kinematics;
+  kinematics.setVertex(0.0);
+  for (auto _ : state) {
+    double et = 0.0;
+    selector->withKernel([&](const auto &kernel) {
+      for (unsigned i = 0; i < TOWERS; ++i) {
+        StPicoBTowHit tower = towers.towers[i];
+        if (kernel(tower, i + 1, kinematics.correctedEta(i),
+                   kinematics.coshEta(i)) ==
+            jetreader::TowerStatus::acceptTower)
+          et += tower.energy() / kinematics.coshEta(i);
+      }
+    });
+    benchmark::DoNotOptimize(et);
+  }
+}
+
+static void BM_TowerLoopSparse(benchmark::State &state) {
+  BenchmarkTowers towers = MakeSparseTowers(state.range(0));
+  auto selector = MakeBenchmarkSelector();
+  jetreader::TowerKinematics kinematics;
+  kinematics.setVertex(0.0);
+  std::vector<float> energy(TOWERS);
+  std::vector<unsigned> hits(TOWERS);
+  for (auto _ : state) {
+    double et = 0.0;
+    for (unsigned i = 0; i < TOWERS; ++i)
+      energy[i] = towers.towers[i].energy();
+    size_t n_hits =
+        jetreader::FindTowerHits(energy.data(), TOWERS, 0.0, hits.data());
+    selector->withKernel([&](const auto &kernel) {
+      for (size_t hit = 0; hit < n_hits; ++hit) {
+        unsigned i = hits[hit];
+        StPicoBTowHit tower = towers.towers[i];
+        if (kernel(tower, i + 1, kinematics.correctedEta(i),
+                   kinematics.coshEta(i)) ==
+            jetreader::TowerStatus::acceptTower)
+          et += tower.energy() / kinematics.coshEta(i);
+      }
+    });
+    benchmark::DoNotOptimize(et);
+  }
+}
+
+// total momentum of the tracks matched to each tower, one in five towers has
+// matches
+std::vector<double> MakeMatchedMomentum() {
+  std::mt19937 gen(5);
+  std::exponential_distribution<double> p(2.0);
+  std::vector<double> ret(TOWERS, 0.0);
+  for (unsigned i = 0; i < TOWERS; i += 5)
+    ret[i] = p(gen);
+  return ret;
+}
+
+static void BM_TowerCorrectionPerTower(benchmark::State &state) {
+  BenchmarkTowers towers = MakeBenchmarkTowers();
+  std::vector<double> matched_p = MakeMatchedMomentum();
+  auto selector = MakeBenchmarkSelector();
+  jetreader::TowerKinematics kinematics;
+  kinematics.setVertex(0.0);
+  for (auto _ : state) {
+    unsigned accepted = 0;
+    selector->withKernel([&](const auto &kernel) {
+      for (unsigned i = 0; i < TOWERS; ++i) {
+        StPicoBTowHit tower = towers.towers[i];
+        double e_corr = tower.energy() - matched_p[i];
+        tower.setEnergy(e_corr);
+        accepted += e_corr > 0.0 &&
+                    kernel(tower, i + 1, kinematics.correctedEta(i),
+                           kinematics.coshEta(i)) ==
+                        jetreader::TowerStatus::acceptTower;
+      }
+    });
+    benchmark::DoNotOptimize(accepted);
+  }
+}
+
+static void BM_TowerCorrectionBatch(benchmark::State &state) {
+  BenchmarkTowers towers = MakeBenchmarkTowers();
+  std::vector<double> matched_p = MakeMatchedMomentum();
+  auto selector = MakeBenchmarkSelector();
+  jetreader::TowerKinematics kinematics;
+  kinematics.setVertex(0.0);
+  std::vector<float> energy(TOWERS);
+  for (unsigned i = 0; i < TOWERS; ++i)
+    energy[i] = towers.towers[i].energy();
+  std::vector<double> e_corr(TOWERS);
+  std::vector<double> cosh_eta(TOWERS);
+  std::vector<uint8_t> accept(TOWERS);
+  for (auto _ : state) {
+    unsigned accepted = 0;
+    for (unsigned i = 0; i < TOWERS; ++i) {
+      e_corr[i] = energy[i] - matched_p[i];
+      cosh_eta[i] = kinematics.coshEta(i);
+      accept[i] = e_corr[i] > 0.0;
+    }
+    selector->withKernel([&](const auto &kernel) {
+      kernel.selectCorrected(e_corr.data(), cosh_eta.data(), TOWERS,
+                             accept.data());
+    });
+    for (unsigned i = 0; i < TOWERS; ++i)
+      accepted += accept[i];
+    benchmark::DoNotOptimize(accepted);
+  }
+}
+
+BENCHMARK(BM_TowerSelectionVirtual);
+BENCHMARK(BM_TowerSelectionKernel);
+// argument: 1 to time each cut as well
+BENCHMARK(BM_TowerSelectionKernelCutFlow)->Arg(0)->Arg(1);
+BENCHMARK(BM_TowerLoopPerTower);
+BENCHMARK(BM_TowerLoopPerRing);
+// argument: one tower in N has energy
+BENCHMARK(BM_TowerLoopDense)->Arg(1)->Arg(10);
+BENCHMARK(BM_TowerLoopSparse)->Arg(1)->Arg(10);
+BENCHMARK(BM_TowerCorrectionPerTower);
+BENCHMARK(BM_TowerCorrectionBatch);
+BENCHMARK_MAIN();
@@ -5,29 +5,63 @@
 
 #include <cmath>
 #include <iostream>
+#include <limits>
 
 namespace jetreader {
 
-TowerSelector::TowerSelector() { clear(); }
+constexpr unsigned TowerSelector::MAX_TOWER_MASK_SIZE;
+
+TowerSelector::TowerSelector() : cut_flow_(cutNames()) { clear(); }
+
+const std::vector<std::string> &TowerSelector::cutNames() {
+  static const std::vector<std::string> names{"badTowers", "EtMin",
+                                              "expressions", "EtMax"};
+  return names;
+}
 
 TowerStatus TowerSelector::select(StPicoBTowHit *tower, unsigned id,
                                   double eta) {
-  if ((bad_towers_active_ && !checkBadTowers(tower, id)) ||
-      (et_min_active_ && !checkEtMin(tower, eta)))
-    return TowerStatus::rejectTower;
+  bool needs_et = et_min_active_ || et_max_active_ || !expressions_.empty();
+  return TowerSelector::select(tower, id, eta, needs_et ? cosh(eta) : 1.0);
+}
 
-  if ((et_max_active_ && !checkEtMax(tower, eta))) {
+TowerStatus TowerSelector::select(StPicoBTowHit *tower, unsigned id,
+                                  double eta, double cosh_eta) {
+  CutFlow &flow = cut_flow_;
+  TowerStatus status = TowerStatus::acceptTower;
+  if ((bad_towers_active_ &&
+       !flow.check(badTowersCut, [&] { return checkBadTowers(tower, id); })) ||
+      (et_min_active_ &&
+       !flow.check(etMinCut,
+                   [&] { return checkEtMin(tower, eta, cosh_eta); })) ||
+      (!expressions_.empty() && !flow.check(expressionsCut, [&] {
+        return checkExpressions(tower, id, eta, cosh_eta);
+      }))) {
+    status = TowerStatus::rejectTower;
+  } else if (et_max_active_ && !flow.check(etMaxCut, [&] {
+               return checkEtMax(tower, eta, cosh_eta);
+             })) {
     if (reject_event_on_et_failure_)
-      return TowerStatus::rejectEvent;
+      status = TowerStatus::rejectEvent;
     else
-      return TowerStatus::rejectTower;
+      status = TowerStatus::rejectTower;
   }
-  return TowerStatus::acceptTower;
+
+  flow.count(status == TowerStatus::acceptTower);
+  return status;
+}
+
+double TowerSelector::energyFloor() const {
+  // ET <= E only holds for positive energies
+  if (et_min_active_ && et_min_ >= 0.0)
+    return et_min_;
+  return -std::numeric_limits<double>::infinity();
 }
 
 void TowerSelector::addBadTower(unsigned tower_id) {
   bad_towers_.insert(tower_id);
   bad_towers_active_ = true;
+  updateBadTowerMask();
 }
 
 void TowerSelector::addBadTowers(std::vector<unsigned> tower_ids) {
@@ -35,6 +69,7 @@ void TowerSelector::addBadTowers(std::vector<unsigned> tower_ids) {
     bad_towers_.insert(tow);
   if (bad_towers_.size() > 0)
     bad_towers_active_ = true;
+  updateBadTowerMask();
 }
 
 void TowerSelector::addBadTowers(std::string filename) {
@@ -45,6 +80,7 @@ void TowerSelector::addBadTowers(std::string filename) {
   }
   if (bad_towers_.size() > 0)
     bad_towers_active_ = true;
+  updateBadTowerMask();
 
   bad_tower_files_.insert(filename);
 }
@@ -65,6 +101,15 @@ void TowerSelector::setEtMin(double min) {
   et_min_active_ = true;
 }
 
+const std::vector<std::string> &TowerSelector::expressionFields() {
+  static const std::vector<std::string> fields{"id", "adc", "e", "et", "eta"};
+  return fields;
+}
+
+void TowerSelector::addExpression(const std::string &expression) {
+  expressions_.emplace_back(expression, expressionFields());
+}
+
 void TowerSelector::clear() {
   bad_towers_active_ = false;
   et_max_active_ = false;
@@ -74,23 +119,66 @@ void TowerSelector::clear() {
 
   bad_towers_.clear();
   bad_tower_files_.clear();
+  bad_tower_mask_.clear();
 
   et_max_ = 0.0;
   et_min_ = 0.0;
+
+  expressions_.clear();
 }
 
 bool TowerSelector::checkBadTowers(StPicoBTowHit *tower, unsigned id) {
-  return (bad_towers_.find(id) == bad_towers_.end());
+  return !isBadTower(id);
+}
+
+void TowerSelector::updateBadTowerMask() {
+  if (bad_towers_.empty()) {
+    bad_tower_mask_.clear();
+    return;
+  }
+  unsigned max_id = *bad_towers_.rbegin();
+  unsigned size =
+      max_id < MAX_TOWER_MASK_SIZE ? max_id + 1 : MAX_TOWER_MASK_SIZE;
+  bad_tower_mask_.assign(size, 0);
+  for (auto &id : bad_towers_)
+    if (id < size)
+      bad_tower_mask_[id] = 1;
 }
 
 bool TowerSelector::checkEtMax(StPicoBTowHit *tower, double eta) {
-  double et = tower->energy() / cosh(eta);
-  return et < et_max_;
+  return checkEtMax(tower, eta, cosh(eta));
 }
 
 bool TowerSelector::checkEtMin(StPicoBTowHit *tower, double eta) {
-  double et = tower->energy() / cosh(eta);
+  return checkEtMin(tower, eta, cosh(eta));
+}
+
+bool TowerSelector::checkExpressions(StPicoBTowHit *tower, unsigned id,
+                                     double eta) {
+  return checkExpressions(tower, id, eta, cosh(eta));
+}
+
+bool TowerSelector::checkEtMax(StPicoBTowHit *tower, double eta,
+                               double cosh_eta) {
+  double et = tower->energy() / cosh_eta;
+  return et < et_max_;
+}
+
+bool TowerSelector::checkEtMin(StPicoBTowHit *tower, double eta,
+                               double cosh_eta) {
+  double et = tower->energy() / cosh_eta;
   return et > et_min_;
 }
 
-} // namespace jetreader
\ No newline at end of file
+bool TowerSelector::checkExpressions(StPicoBTowHit *tower, unsigned id,
+                                     double eta, double cosh_eta) {
+  // in the order of expressionFields()
+  double values[] = {(double)id, (double)tower->adc(), tower->energy(),
+                     tower->energy() / cosh_eta, eta};
+  for (auto &expression : expressions_)
+    if (!expression.evaluate(values))
+      return false;
+  return true;
+}
+
+} // namespace jetreader
@@ -1,10 +1,16 @@
 #ifndef JETREADER_READER_TOWER_SELECTOR_H
 #define JETREADER_READER_TOWER_SELECTOR_H
 
+#include "jetreader/reader/cut_expression.h"
+#include "jetreader/reader/cut_flow.h"
+
 #include "StPicoEvent/StPicoBTowHit.h"
 
+#include <cmath>
+#include <cstdint>
 #include <set>
 #include <string>
+#include <vector>
 
 namespace jetreader {
 
@@ -25,6 +31,24 @@ public:
   // corrected for vertex position
   virtual TowerStatus select(StPicoBTowHit *tower, unsigned id, double eta);
 
+  // the same as the above, with cosh(eta) given by the caller, e.g. from the
+  // TowerKinematics of the event, instead of computed for each tower. Used by
+  // the Reader for TowerSelectors that do not override select()
+  TowerStatus select(StPicoBTowHit *tower, unsigned id, double eta,
+                     double cosh_eta);
+
+  // the selection of TowerSelector::select() for a fixed set of active cuts,
+  // chosen at compile time. Kernel::operator() has the same result as
+  // select(), but has no virtual dispatch and no per-tower checks of which
+  // cuts are active, so it can be inlined into a loop over all towers.
+  // Expressions are not included: use select() if expressions() is not empty
+  template <bool BadTowers, bool EtMin, bool EtMax> class Kernel;
+
+  // calls f(kernel) with the Kernel matching the currently active cuts. The
+  // kernel refers to this selector, and is only valid while its cuts are not
+  // changed
+  template <class F> void withKernel(F &&f) const;
+
   // add bad towers to the bad tower list (a bad tower is generally a tower that
   // is masked out at the analysis level due to faulty hardware, poor
   // calibration, etc)
@@ -42,18 +66,65 @@ public:
   // entire event is rejected. This is turned on by default
   void rejectEventOnEtFailure(bool flag = true);
 
-  // resets all selection criteria to default (off)
+  // adds a cut given as an expression over the fields in expressionFields(),
+  // for instance "adc > 4 && et < 20" (see CutExpression for the syntax).
+  // Towers are rejected if the expression is zero. Throws an AssertionFailure
+  // if the expression is not valid
+  void addExpression(const std::string &expression);
+  const std::vector<CutExpression> &expressions() const {
+    return expressions_;
+  }
+
+  // the tower fields that can be used in expressions. eta is the vertex
+  // corrected eta passed to select(), and et is computed from it
+  static const std::vector<std::string> &expressionFields();
+
+  // counts the towers tested and passed by each cut, and by the selector as a
+  // whole (see CutFlow), in both select() and the Kernel. Counting is off by
+  // default
+  CutFlow &cutFlow() { return cut_flow_; }
+  const CutFlow &cutFlow() const { return cut_flow_; }
+
+  // names of the cuts in cutFlow(), in the order they are applied
+  static const std::vector<std::string> &cutNames();
+
+  // resets all selection criteria to default (off). The cut flow counts are
+  // kept
   void clear();
 
   // access to the bad tower list - used by the EventSelector
   const std::set<unsigned> &badTowers() { return bad_towers_; }
 
+  // towers with an energy at or below energyFloor() always fail the ET min
+  // cut, since ET <= E. -infinity if there is no such cut
+  double energyFloor() const;
+
 protected:
   bool checkBadTowers(StPicoBTowHit *tower, unsigned id);
   bool checkEtMax(StPicoBTowHit *tower, double eta);
   bool checkEtMin(StPicoBTowHit *tower, double eta);
+  bool checkExpressions(StPicoBTowHit *tower, unsigned id, double eta);
+
+  // the same, with a precomputed cosh(eta)
+  bool checkEtMax(StPicoBTowHit *tower, double eta, double cosh_eta);
+  bool checkEtMin(StPicoBTowHit *tower, double eta, double cosh_eta);
+  bool checkExpressions(StPicoBTowHit *tower, unsigned id, double eta,
+                        double cosh_eta);
 
 private:
+  // indices into cutNames()
+  enum Cut : unsigned { badTowersCut, etMinCut, expressionsCut, etMaxCut };
+
+  // bad_tower_mask_ covers all bad towers with ids below MAX_TOWER_MASK_SIZE,
+  // the bad tower set is only searched for larger ids
+  static constexpr unsigned MAX_TOWER_MASK_SIZE = 1 << 16;
+  bool isBadTower(unsigned id) const {
+    if (id < bad_tower_mask_.size())
+      return bad_tower_mask_[id];
+    return id >= MAX_TOWER_MASK_SIZE && bad_towers_.count(id);
+  }
+  void updateBadTowerMask();
+
   bool bad_towers_active_;
   bool et_max_active_;
   bool et_min_active_;
@@ -62,11 +133,124 @@ private:
 
   std::set<unsigned> bad_towers_;
   std::set<std::string> bad_tower_files_;
+  // bad_tower_mask_[id] is 1 for bad towers, for constant time lookup
+  std::vector<uint8_t> bad_tower_mask_;
 
   double et_max_;
   double et_min_;
+
+  std::vector<CutExpression> expressions_;
+
+  // counted by the Kernel as well
+  mutable CutFlow cut_flow_;
+};
+
+template <bool BadTowers, bool EtMin, bool EtMax>
+class TowerSelector::Kernel {
+public:
+  explicit Kernel(const TowerSelector &selector) : selector_(selector) {}
+
+  TowerStatus operator()(const StPicoBTowHit &tower, unsigned id,
+                         double eta) const {
+    return (*this)(tower, id, eta, EtMin || EtMax ? cosh(eta) : 1.0);
+  }
+
+  // the same, with a precomputed cosh(eta)
+  TowerStatus operator()(const StPicoBTowHit &tower, unsigned id, double eta,
+                         double cosh_eta) const {
+    // counting is checked once, so that the loop without counting is the same
+    // as before the cut flow existed
+    if (selector_.cut_flow_.active())
+      return select<true>(tower, id, cosh_eta);
+    return select<false>(tower, id, cosh_eta);
+  }
+
+  // the ET cuts for n towers that were accepted before their energy was
+  // corrected, and so already passed the bad tower cut. Clears accept[i] for
+  // towers with energy[i] failing the cuts. Towers rejected here are only
+  // rejected, never the event, and are not counted in the cut flow
+  void selectCorrected(const double *energy, const double *cosh_eta, size_t n,
+                       uint8_t *accept) const {
+    // no branches, so that the compiler can vectorize the loop at -O3. The
+    // thresholds are copied to locals, since the uint8_t stores may alias
+    // them, and the mask is updated with a select rather than &=, which GCC
+    // does not vectorize for a double compare
+    double et_min = selector_.et_min_;
+    double et_max = selector_.et_max_;
+    for (size_t i = 0; i < n; ++i) {
+      double et = energy[i] / cosh_eta[i];
+      uint8_t keep = accept[i];
+      if (EtMin)
+        keep = et > et_min ? keep : 0;
+      if (EtMax)
+        keep = et < et_max ? keep : 0;
+      accept[i] = keep;
+    }
+  }
+
+private:
+  template <bool Count, class F> bool check(unsigned cut, F &&f) const {
+    return Count ? selector_.cut_flow_.check(cut, f) : f();
+  }
+
+  template <bool Count>
+  TowerStatus select(const StPicoBTowHit &tower, unsigned id,
+                     double cosh_eta) const {
+    TowerStatus status = TowerStatus::acceptTower;
+    if (BadTowers && !check<Count>(badTowersCut, [&] {
+          return !selector_.isBadTower(id);
+        })) {
+      status = TowerStatus::rejectTower;
+    } else if (EtMin || EtMax) {
+      double et = tower.energy() / cosh_eta;
+      if (EtMin &&
+          !check<Count>(etMinCut, [&] { return et > selector_.et_min_; }))
+        status = TowerStatus::rejectTower;
+      else if (EtMax &&
+               !check<Count>(etMaxCut, [&] { return et < selector_.et_max_; }))
+        status = selector_.reject_event_on_et_failure_
+                     ? TowerStatus::rejectEvent
+                     : TowerStatus::rejectTower;
+    }
+    if (Count)
+      selector_.cut_flow_.count(status == TowerStatus::acceptTower);
+    return status;
+  }
+
+  const TowerSelector &selector_;
 };
 
+template <class F> void TowerSelector::withKernel(F &&f) const {
+  unsigned cuts = (bad_towers_active_ ? 4 : 0) | (et_min_active_ ? 2 : 0) |
+                  (et_max_active_ ? 1 : 0);
+  switch (cuts) {
+  case 0:
+    f(Kernel<false, false, false>(*this));
+    break;
+  case 1:
+    f(Kernel<false, false, true>(*this));
+    break;
+  case 2:
+    f(Kernel<false, true, false>(*this));
+    break;
+  case 3:
+    f(Kernel<false, true, true>(*this));
+    break;
+  case 4:
+    f(Kernel<true, false, false>(*this));
+    break;
+  case 5:
+    f(Kernel<true, false, true>(*this));
+    break;
+  case 6:
+    f(Kernel<true, true, false>(*this));
+    break;
+  default:
+    f(Kernel<true, true, true>(*this));
+    break;
+  }
+}
+
 } // namespace jetreader
 
 #endif // JETREADER_READER_TOWER_SELECTOR_H
\ No newline at end of file
@@ -1,6 +1,9 @@
 #include "gtest/gtest.h"
 
+#include <cmath>
 #include <cstdio>
+#include <random>
+#include <vector>
 
 #include "jetreader/lib/parse_csv.h"
 #include "jetreader/reader/tower_selector.h"
@@ -95,4 +98,134 @@ TEST(TowerSelector, EtMin) {
   EXPECT_EQ(jetreader::TowerStatus::acceptTower,
             selector.select(&good_tow, 4000, 0.0));
   EXPECT_EQ(jetreader::TowerStatus::rejectTower, selector.select(&bad_tow, 5, 0.0));
-}
\ No newline at end of file
+}
+void ExpectKernelMatchesSelect(jetreader::TowerSelector &selector) {
+  std::default_random_engine gen(7);
+  std::uniform_real_distribution<double> energy(0.0, 20.0);
+  std::uniform_real_distribution<double> eta(-1.0, 1.0);
+  std::uniform_int_distribution<unsigned> id(1, 4800);
+
+  for (int i = 0; i < 1000; ++i) {
+    StPicoBTowHit tower;
+    tower.setEnergy(energy(gen));
+    unsigned tower_id = id(gen);
+    double tower_eta = eta(gen);
+    auto expected = selector.select(&tower, tower_id, tower_eta);
+    selector.withKernel([&](const auto &kernel) {
+      EXPECT_EQ(expected, kernel(tower, tower_id, tower_eta));
+    });
+  }
+}
+
+TEST(TowerSelector, Kernel) {
+  jetreader::TowerSelector selector;
+  ExpectKernelMatchesSelect(selector);
+
+  for (unsigned id = 1; id <= 4800; id += 7)
+    selector.addBadTower(id);
+  ExpectKernelMatchesSelect(selector);
+
+  selector.setEtMin(0.2);
+  ExpectKernelMatchesSelect(selector);
+
+  selector.setEtMax(15.0);
+  ExpectKernelMatchesSelect(selector);
+
+  selector.rejectEventOnEtFailure(false);
+  ExpectKernelMatchesSelect(selector);
+
+  selector.clear();
+  selector.setEtMax(15.0);
+  ExpectKernelMatchesSelect(selector);
+}
+
+TEST(TowerSelector, KernelSelectCorrected) {
+  jetreader::TowerSelector selector;
+  selector.setEtMin(0.2);
+  selector.setEtMax(15.0);
+  selector.rejectEventOnEtFailure(false);
+
+  std::default_random_engine gen(11);
+  std::uniform_real_distribution<double> energy(0.0, 20.0);
+  std::uniform_real_distribution<double> eta(-1.0, 1.0);
+  std::vector<StPicoBTowHit> towers(1000);
+  std::vector<double> energies, etas, cosh_etas;
+  std::vector<uint8_t> accept;
+  for (int i = 0; i < 1000; ++i) {
+    // the energy as stored in the tower
+    towers[i].setEnergy(energy(gen));
+    energies.push_back(towers[i].energy());
+    etas.push_back(eta(gen));
+    cosh_etas.push_back(cosh(etas.back()));
+    accept.push_back(i % 3 != 0);
+  }
+  std::vector<uint8_t> initial = accept;
+  selector.withKernel([&](const auto &kernel) {
+    kernel.selectCorrected(energies.data(), cosh_etas.data(), accept.size(),
+                           accept.data());
+  });
+
+  for (size_t i = 0; i < accept.size(); ++i) {
+    bool expected = initial[i] && selector.select(&towers[i], 1, etas[i]) ==
+                                      jetreader::TowerStatus::acceptTower;
+    EXPECT_EQ(expected, (bool)accept[i]);
+  }
+}
+
+TEST(TowerSelector, LargeBadTowerId) {
+  TestSelector selector;
+  selector.addBadTower(5);
+  selector.addBadTower(4294967295u);
+
+  StPicoBTowHit hit;
+  EXPECT_FALSE(selector.checkBadTowers(&hit, 5));
+  EXPECT_TRUE(selector.checkBadTowers(&hit, 6));
+  EXPECT_TRUE(selector.checkBadTowers(&hit, 100000));
+  EXPECT_FALSE(selector.checkBadTowers(&hit, 4294967295u));
+}
+
+TEST(TowerSelector, Expressions) {
+  jetreader::TowerSelector selector;
+  selector.addExpression("adc > 4 && et < 20");
+  ASSERT_EQ(selector.expressions().size(), 1);
+  EXPECT_ANY_THROW(selector.addExpression("pt > 1"));
+
+  StPicoBTowHit tower;
+  tower.setAdc(10);
+  tower.setEnergy(5.0);
+  EXPECT_EQ(selector.select(&tower, 1, 0.0),
+            jetreader::TowerStatus::acceptTower);
+  tower.setAdc(2);
+  EXPECT_EQ(selector.select(&tower, 1, 0.0),
+            jetreader::TowerStatus::rejectTower);
+  tower.setAdc(10);
+  tower.setEnergy(30.0);
+  EXPECT_EQ(selector.select(&tower, 1, 0.0),
+            jetreader::TowerStatus::rejectTower);
+
+  selector.clear();
+  EXPECT_EQ(selector.expressions().size(), 0);
+  EXPECT_EQ(selector.select(&tower, 1, 0.0),
+            jetreader::TowerStatus::acceptTower);
+}
+
+TEST(TowerSelector, CutFlow) {
+  jetreader::TowerSelector selector;
+  for (unsigned id = 1; id <= 4800; id += 7)
+    selector.addBadTower(id);
+  selector.setEtMin(0.2);
+  selector.setEtMax(15.0);
+  selector.cutFlow().setActive(true);
+
+  // select() and the kernel count each tower once per call
+  ExpectKernelMatchesSelect(selector);
+  const jetreader::CutFlow &flow = selector.cutFlow();
+  EXPECT_EQ(flow.tested(), 2000);
+  for (auto &cut : flow.cuts()) {
+    EXPECT_EQ(cut.tested % 2, 0);
+    EXPECT_EQ(cut.passed % 2, 0);
+  }
+  EXPECT_EQ(flow.cuts()[flow.index("badTowers")].tested, 2000);
+  EXPECT_EQ(flow.cuts()[flow.index("expressions")].tested, 0);
+  EXPECT_LT(flow.accepted(), flow.tested());
+}
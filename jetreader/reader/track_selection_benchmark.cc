@@ -0,0 +1,142 @@
+#include "benchmark/benchmark.h"
+
+#include "jetreader/reader/reader_utils.h"
+#include "jetreader/reader/track_selector.h"
+#include "jetreader/reader/track_table.h"
+#include "jetreader/reader/vector_info_pool.h"
+
+#include <random>
+#include <vector>
+
+#include "fastjet/PseudoJet.hh"
+
+#include "StPicoEvent/StPicoTrack.h"
+
+#include "TVector3.h"
+
+// compares the per-track path, where the selector, MakePseudoJet() and the
+// hadronic correction each recompute the DCA and momentum of a track, to
+// filling a TrackTable once per event and sharing it between all three. Also
+// compares the fixed and adaptive cut order of TrackSelector::select().
+
+constexpr unsigned TRACKS = 1000;
+
+std::vector<StPicoTrack> MakeBenchmarkTracks() {
+  std::mt19937 gen(5);
+  std::uniform_real_distribution<double> mom(-5.0, 5.0);
+  std::uniform_real_distribution<double> origin(-1.0, 1.0);
+  std::uniform_int_distribution<int> nhits(10, 45);
+  std::uniform_int_distribution<int> nhits_poss(45, 50);
+  std::uniform_real_distribution<double> chi2(0.0, 5.0);
+  std::bernoulli_distribution positive(0.5);
+  std::bernoulli_distribution is_primary(0.8);
+  std::uniform_int_distribution<int> tower(-1, 4799);
+
+  std::vector<StPicoTrack> tracks(TRACKS);
+  for (auto &track : tracks) {
+    TVector3 p(mom(gen), mom(gen), mom(gen));
+    track.setGlobalMomentum(p);
+    if (is_primary(gen))
+      track.setPrimaryMomentum(p);
+    track.setOrigin(origin(gen), origin(gen), origin(gen));
+    track.setNHitsFit(positive(gen) ? nhits(gen) : -nhits(gen));
+    track.setNHitsPossible(nhits_poss(gen));
+    track.setChi2(chi2(gen));
+    track.setBEmcMatchedTowerIndex(tower(gen));
+  }
+  return tracks;
+}
+
+static void BM_TrackSelectionPerTrack(benchmark::State &state) {
+  std::vector<StPicoTrack> tracks = MakeBenchmarkTracks();
+  TVector3 vertex(0.1, -0.2, 0.5);
+  jetreader::TrackSelector selector;
+  jetreader::VectorInfoPool pool;
+  std::vector<fastjet::PseudoJet> pseudojets;
+  std::vector<int> accepted;
+  double total = 0.0;
+  for (auto _ : state) {
+    pseudojets.clear();
+    accepted.clear();
+    pool.reset();
+    for (int i = 0; i < tracks.size(); ++i) {
+      if (selector.select(&tracks[i], vertex, true) !=
+          jetreader::TrackStatus::acceptTrack)
+        continue;
+      pseudojets.push_back(
+          jetreader::MakePseudoJet(pool, tracks[i], vertex, true));
+      accepted.push_back(i);
+    }
+    // hadronic correction
+    for (auto &i : accepted)
+      if (tracks[i].bemcTowerIndex() >= 0)
+        total += tracks[i].pPtot();
+    benchmark::DoNotOptimize(total);
+  }
+}
+
+static void BM_TrackSelectionTrackTable(benchmark::State &state) {
+  std::vector<StPicoTrack> tracks = MakeBenchmarkTracks();
+  TVector3 vertex(0.1, -0.2, 0.5);
+  jetreader::TrackSelector selector;
+  jetreader::VectorInfoPool pool;
+  jetreader::TrackTable table;
+  std::vector<uint8_t> mask;
+  std::vector<fastjet::PseudoJet> pseudojets;
+  std::vector<int> accepted;
+  double total = 0.0;
+  for (auto _ : state) {
+    pseudojets.clear();
+    accepted.clear();
+    pool.reset();
+    table.clear();
+    table.reserve(tracks.size());
+    for (auto &track : tracks)
+      table.add(track, vertex, true);
+    selector.selectBatch(table, true, mask);
+    for (int i = 0; i < tracks.size(); ++i) {
+      if (!mask[i])
+        continue;
+      table.setKinematics(i, tracks[i], true);
+      pseudojets.push_back(
+          jetreader::MakePseudoJet(pool, tracks[i], table, i, true,
+                                   tracks[i].bemcTowerIndex()));
+      accepted.push_back(i);
+    }
+    // hadronic correction
+    for (auto &i : accepted)
+      if (tracks[i].bemcTowerIndex() >= 0)
+        total += table.p()[i];
+    benchmark::DoNotOptimize(total);
+  }
+}
+
+static void BM_TrackSelectionCutOrder(benchmark::State &state) {
+  std::vector<StPicoTrack> tracks = MakeBenchmarkTracks();
+  TVector3 vertex(0.1, -0.2, 0.5);
+  jetreader::TrackSelector selector;
+  // the DCA cut comes first by default, but the cheaper nHits cut rejects
+  // more tracks
+  selector.setDcaMax(3.0);
+  selector.setNHitsMin(35);
+  selector.setChi2Max(4.0);
+  selector.addExpression("abs(eta) < 1");
+  if (state.range(0))
+    selector.useAdaptiveCutOrder(true, 1000);
+  for (auto &track : tracks)
+    selector.select(&track, vertex, true);
+
+  for (auto _ : state) {
+    unsigned accepted = 0;
+    for (auto &track : tracks)
+      accepted += selector.select(&track, vertex, true) ==
+                  jetreader::TrackStatus::acceptTrack;
+    benchmark::DoNotOptimize(accepted);
+  }
+}
+
+BENCHMARK(BM_TrackSelectionPerTrack);
+BENCHMARK(BM_TrackSelectionTrackTable);
+// argument: 1 for the adaptive cut order
+BENCHMARK(BM_TrackSelectionCutOrder)->Arg(0)->Arg(1);
+BENCHMARK_MAIN();
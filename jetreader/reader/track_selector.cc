@@ -2,30 +2,342 @@
 
 #include "jetreader/lib/assert.h"
 
+#include <algorithm>
+
 namespace jetreader {
 
-TrackSelector::TrackSelector() { clear(); }
+namespace {
 
-TrackStatus TrackSelector::select(StPicoTrack *track, TVector3 vertex,
-                                  bool primary) {
-  if (primary && !track->isPrimary())
-    return TrackStatus::rejectTrack;
+// indices into TrackSelector::expressionFields()
+enum TrackField : unsigned {
+  ptField,
+  etaField,
+  phiField,
+  pField,
+  dcaField,
+  dcaXYField,
+  dcaZField,
+  nHitsField,
+  nHitsFitField,
+  nHitsMaxField,
+  nHitsDedxField,
+  nHitsFracField,
+  chi2Field,
+  chargeField,
+  dEdxField,
+  nSigmaPionField,
+  nSigmaKaonField,
+  nSigmaProtonField,
+  nSigmaElectronField
+};
+
+double TrackFieldValue(unsigned field, const StPicoTrack &track,
+                       const TVector3 &vertex, bool primary) {
+  switch (field) {
+  case ptField:
+    return primary ? track.pPt() : track.gPt();
+  case etaField:
+    return (primary ? track.pMom() : track.gMom()).Eta();
+  case phiField:
+    return (primary ? track.pMom() : track.gMom()).Phi();
+  case pField:
+    return primary ? track.pPtot() : track.gPtot();
+  case dcaField:
+    return track.gDCA(vertex).Mag();
+  case dcaXYField:
+    return track.gDCAxy(vertex.X(), vertex.Y());
+  case dcaZField:
+    return track.gDCAz(vertex.Z());
+  case nHitsField:
+    return track.nHits();
+  case nHitsFitField:
+    return track.nHitsFit();
+  case nHitsMaxField:
+    return track.nHitsMax();
+  case nHitsDedxField:
+    return track.nHitsDedx();
+  case nHitsFracField:
+    return (double)track.nHits() / track.nHitsPoss();
+  case chi2Field:
+    return track.chi2();
+  case chargeField:
+    return track.charge();
+  case dEdxField:
+    return track.dEdx();
+  case nSigmaPionField:
+    return track.nSigmaPion();
+  case nSigmaKaonField:
+    return track.nSigmaKaon();
+  case nSigmaProtonField:
+    return track.nSigmaProton();
+  default:
+    return track.nSigmaElectron();
+  }
+}
+
+// indices into TrackSelector::cutNames()
+enum TrackCut : unsigned {
+  primaryCut,
+  dcaCut,
+  nHitsCut,
+  nHitsFracCut,
+  chi2Cut,
+  ptMinCut,
+  expressionsCut,
+  ptMaxCut
+};
 
-  if ((dca_active_ && !checkDca(track, vertex)) ||
-      (nhits_active_ && !checkNHits(track)) ||
-      (nhits_frac_active_ && !checkNHitsFrac(track)) ||
-      (chi2_active_ && !checkChi2(track)) ||
-      (pt_min_active_ && !checkPtMin(track, primary)))
-    return TrackStatus::rejectTrack;
+// clear accept[i] where pass[i] is zero
+void CutUnset(const uint8_t *pass, uint8_t *accept, size_t n) {
+  for (size_t i = 0; i < n; ++i)
+    accept[i] &= pass[i];
+}
+
+// clear accept[i] for values[i] not below max, or not above min. The threshold
+// is a parameter rather than a member, and the mask is updated with a select,
+// since GCC does not vectorize the loop otherwise: the uint8_t stores may alias
+// a member, and it does not vectorize accept[i] &= (values[i] < max) for a
+// double column
+template <typename T>
+void CutAtOrAbove(const T *values, T max, uint8_t *accept, size_t n) {
+  for (size_t i = 0; i < n; ++i)
+    accept[i] = values[i] < max ? accept[i] : 0;
+}
 
-  if (pt_max_active_ && !checkPtMax(track, primary)) {
+template <typename T>
+void CutAtOrBelow(const T *values, T min, uint8_t *accept, size_t n) {
+  for (size_t i = 0; i < n; ++i)
+    accept[i] = values[i] > min ? accept[i] : 0;
+}
+
+// as CutAtOrAbove(), but returns true if a track that was still accepted fails
+// the cut
+bool CutAtOrAboveAny(const double *values, double max, uint8_t *accept,
+                     size_t n) {
+  uint8_t failed = 0;
+  for (size_t i = 0; i < n; ++i) {
+    uint8_t fail = values[i] < max ? 0 : accept[i];
+    failed |= fail;
+    accept[i] ^= fail;
+  }
+  return failed;
+}
+
+} // namespace
+
+const std::vector<std::string> &TrackSelector::cutNames() {
+  static const std::vector<std::string> names{
+      "primary", "dca",   "nHits",       "nHitsFrac",
+      "chi2",    "ptMin", "expressions", "ptMax"};
+  return names;
+}
+
+const std::vector<std::string> &TrackSelector::expressionFields() {
+  static const std::vector<std::string> fields{
+      "pt",         "eta",          "phi",           "p",
+      "dca",        "gDCAxy",       "gDCAz",         "nHits",
+      "nHitsFit",   "nHitsMax",     "nHitsDedx",     "nHitsFrac",
+      "chi2",       "charge",       "dEdx",          "nSigmaPion",
+      "nSigmaKaon", "nSigmaProton", "nSigmaElectron"};
+  return fields;
+}
+
+TrackSelector::TrackSelector()
+    : cut_flow_(cutNames()), cut_order_(cutNames().size()) {
+  clear();
+}
+
+TrackStatus TrackSelector::select(StPicoTrack *track, TVector3 vertex,
+                                  bool primary) {
+  TrackStatus status = TrackStatus::acceptTrack;
+  if (!checkOrdered(track, vertex, primary)) {
+    status = TrackStatus::rejectTrack;
+  } else if (pt_max_active_ && !cut_flow_.check(ptMaxCut, [&] {
+               return checkPtMax(track, primary);
+             })) {
     if (reject_event_on_pt_failure_)
-      return TrackStatus::rejectEvent;
+      status = TrackStatus::rejectEvent;
     else
-      return TrackStatus::rejectTrack;
+      status = TrackStatus::rejectTrack;
   }
 
-  return TrackStatus::acceptTrack;
+  cut_flow_.count(status == TrackStatus::acceptTrack);
+  return status;
+}
+
+bool TrackSelector::checkOrdered(StPicoTrack *track, const TVector3 &vertex,
+                                 bool primary) {
+  // select() is called for every track, so the default order is written out
+  // rather than looked up for each cut
+  CutFlow &flow = cut_flow_;
+  if (!cut_order_.adaptive())
+    return !(
+        (primary &&
+         !flow.check(primaryCut, [&] { return track->isPrimary(); })) ||
+        (dca_active_ &&
+         !flow.check(dcaCut, [&] { return checkDca(track, vertex); })) ||
+        (nhits_active_ &&
+         !flow.check(nHitsCut, [&] { return checkNHits(track); })) ||
+        (nhits_frac_active_ &&
+         !flow.check(nHitsFracCut, [&] { return checkNHitsFrac(track); })) ||
+        (chi2_active_ &&
+         !flow.check(chi2Cut, [&] { return checkChi2(track); })) ||
+        (pt_min_active_ &&
+         !flow.check(ptMinCut, [&] { return checkPtMin(track, primary); })) ||
+        (!expressions_.empty() && !flow.check(expressionsCut, [&] {
+          return checkExpressions(track, vertex, primary);
+        })));
+
+  if (!cut_order_.warmingUp()) {
+    for (auto &cut : cut_order_.order())
+      if (cut != ptMaxCut && cutActive(cut, primary) &&
+          !flow.check(cut,
+                      [&] { return checkCut(cut, track, vertex, primary); }))
+        return false;
+    return true;
+  }
+
+  // during the warmup, every cut is evaluated to measure how often it rejects
+  // tracks. The cut flow only counts cuts up to the first failure, as usual
+  bool pass = true;
+  for (auto &cut : cut_order_.order()) {
+    if (cut == ptMaxCut || !cutActive(cut, primary))
+      continue;
+    bool cut_pass = cut_order_.measure(
+        cut, [&] { return checkCut(cut, track, vertex, primary); });
+    if (pass)
+      flow.record(cut, 1, cut_pass);
+    pass = pass && cut_pass;
+  }
+  cut_order_.next();
+  return pass;
+}
+
+bool TrackSelector::cutActive(unsigned cut, bool primary) const {
+  switch (cut) {
+  case primaryCut:
+    return primary;
+  case dcaCut:
+    return dca_active_;
+  case nHitsCut:
+    return nhits_active_;
+  case nHitsFracCut:
+    return nhits_frac_active_;
+  case chi2Cut:
+    return chi2_active_;
+  case ptMinCut:
+    return pt_min_active_;
+  case expressionsCut:
+    return !expressions_.empty();
+  default:
+    return pt_max_active_;
+  }
+}
+
+bool TrackSelector::checkCut(unsigned cut, StPicoTrack *track,
+                             const TVector3 &vertex, bool primary) {
+  switch (cut) {
+  case primaryCut:
+    return track->isPrimary();
+  case dcaCut:
+    return checkDca(track, vertex);
+  case nHitsCut:
+    return checkNHits(track);
+  case nHitsFracCut:
+    return checkNHitsFrac(track);
+  case chi2Cut:
+    return checkChi2(track);
+  case ptMinCut:
+    return checkPtMin(track, primary);
+  case expressionsCut:
+    return checkExpressions(track, vertex, primary);
+  default:
+    return checkPtMax(track, primary);
+  }
+}
+
+bool TrackSelector::selectBatch(const TrackTable &tracks, bool primary,
+                                std::vector<uint8_t> &mask) const {
+  size_t n = tracks.size();
+  mask.assign(n, 1);
+  uint8_t *accept = mask.data();
+  CutFlow &flow = cut_flow_;
+
+  // each cut is a separate loop over one column, without branches. With the
+  // release build's -O3, GCC vectorizes these loops; at -O2, GCC 12's default
+  // cost model does not vectorize loops of unknown length
+  if (primary)
+    flow.checkBatch(primaryCut, accept, n, [&] {
+      CutUnset(tracks.isPrimary().data(), accept, n);
+    });
+  if (dca_active_)
+    flow.checkBatch(dcaCut, accept, n, [&] {
+      CutAtOrAbove(tracks.dca().data(), dca_max_, accept, n);
+    });
+  if (nhits_active_)
+    flow.checkBatch(nHitsCut, accept, n, [&] {
+      CutAtOrBelow(tracks.nhits().data(), nhits_min_, accept, n);
+    });
+  if (nhits_frac_active_)
+    flow.checkBatch(nHitsFracCut, accept, n, [&] {
+      CutAtOrBelow(tracks.nhitsFrac().data(), nhits_frac_min_, accept, n);
+    });
+  if (chi2_active_)
+    flow.checkBatch(chi2Cut, accept, n, [&] {
+      CutAtOrAbove(tracks.chi2().data(), chi2_max_, accept, n);
+    });
+  const double *pt = tracks.pt().data();
+  if (pt_min_active_)
+    flow.checkBatch(ptMinCut, accept, n,
+                    [&] { CutAtOrBelow(pt, pt_min_, accept, n); });
+
+  // expressions are evaluated over columns of the fields they use. Fields
+  // that are cached in the table are used directly
+  if (!expressions_.empty()) {
+    flow.checkBatch(expressionsCut, accept, n, [&] {
+      std::vector<const double *> &columns = expression_columns_;
+      std::vector<std::vector<double>> &storage = expression_storage_;
+      columns.assign(expressionFields().size(), nullptr);
+      storage.resize(expression_fields_.size());
+      for (size_t f = 0; f < expression_fields_.size(); ++f) {
+        unsigned field = expression_fields_[f];
+        if (field == ptField) {
+          columns[field] = pt;
+        } else if (field == dcaField) {
+          columns[field] = tracks.dca().data();
+        } else if (field == nHitsFracField) {
+          columns[field] = tracks.nhitsFrac().data();
+        } else if (field == chi2Field) {
+          columns[field] = tracks.chi2().data();
+        } else {
+          storage[f].resize(n);
+          for (size_t i = 0; i < n; ++i)
+            storage[f][i] = TrackFieldValue(field, *tracks.tracks()[i],
+                                            tracks.vertex(), primary);
+          columns[field] = storage[f].data();
+        }
+      }
+      for (auto &expression : expressions_)
+        expression.evaluate(columns, n, accept);
+    });
+  }
+
+  // as in select(), the pT max cut is checked last: only tracks that pass
+  // every other cut can reject the event
+  bool reject_event = false;
+  if (pt_max_active_) {
+    flow.checkBatch(ptMaxCut, accept, n, [&] {
+      reject_event = CutAtOrAboveAny(pt, pt_max_, accept, n);
+    });
+  }
+
+  if (flow.active()) {
+    uint64_t accepted = 0;
+    for (size_t i = 0; i < n; ++i)
+      accepted += accept[i];
+    flow.count(n, accepted);
+  }
+  return !(reject_event && reject_event_on_pt_failure_);
 }
 
 void TrackSelector::setDcaMax(double max) {
@@ -69,6 +381,20 @@ void TrackSelector::rejectEventOnPtFailure(bool flag) {
   reject_event_on_pt_failure_ = flag;
 }
 
+void TrackSelector::useAdaptiveCutOrder(bool flag, unsigned warmup) {
+  cut_order_.setAdaptive(flag, warmup);
+}
+
+void TrackSelector::addExpression(const std::string &expression) {
+  expressions_.emplace_back(expression, expressionFields());
+  for (auto &field : expressions_.back().fields())
+    expression_fields_.push_back(field);
+  std::sort(expression_fields_.begin(), expression_fields_.end());
+  expression_fields_.erase(
+      std::unique(expression_fields_.begin(), expression_fields_.end()),
+      expression_fields_.end());
+}
+
 void TrackSelector::clear() {
   dca_active_ = false;
   nhits_active_ = false;
@@ -85,6 +411,12 @@ void TrackSelector::clear() {
   chi2_max_ = 0.0;
   pt_max_ = 0.0;
   pt_min_ = 0.0;
+
+  expressions_.clear();
+  expression_fields_.clear();
+
+  // measurements of the previous cuts don't apply anymore
+  cut_order_.reset();
 }
 
 bool TrackSelector::checkDca(StPicoTrack *track, TVector3 vertex) {
@@ -124,4 +456,15 @@ bool TrackSelector::checkPtMin(StPicoTrack *track, bool is_primary) {
   return pt > pt_min_;
 }
 
-} // namespace jetreader
\ No newline at end of file
+bool TrackSelector::checkExpressions(StPicoTrack *track, TVector3 vertex,
+                                     bool is_primary) {
+  double values[nSigmaElectronField + 1];
+  for (auto &field : expression_fields_)
+    values[field] = TrackFieldValue(field, *track, vertex, is_primary);
+  for (auto &expression : expressions_)
+    if (!expression.evaluate(values))
+      return false;
+  return true;
+}
+
+} // namespace jetreader
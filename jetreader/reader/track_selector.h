@@ -1,6 +1,15 @@
 #ifndef JETREADER_READER_TRACK_SELECTOR_H
 #define JETREADER_READER_TRACK_SELECTOR_H
 
+#include "jetreader/reader/cut_expression.h"
+#include "jetreader/reader/cut_flow.h"
+#include "jetreader/reader/cut_order.h"
+#include "jetreader/reader/track_table.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
 #include "StPicoEvent/StPicoTrack.h"
 
 namespace jetreader {
@@ -24,6 +33,14 @@ public:
   virtual TrackStatus select(StPicoTrack *track, TVector3 vertex,
                              bool primary = true);
 
+  // selects all tracks of an event at once. On return, mask[i] is 1 if track i
+  // is accepted and 0 otherwise. Returns false if a track rejects the whole
+  // event. The result is identical to calling TrackSelector::select() on each
+  // track, but each cut is evaluated over all tracks in a single branch-free
+  // loop. Used by the Reader unless select() is overridden
+  bool selectBatch(const TrackTable &tracks, bool primary,
+                   std::vector<uint8_t> &mask) const;
+
   // select on DCA (DCA = distance of closest approach of the track helix to the
   // primary vertex)
   void setDcaMax(double max);
@@ -52,7 +69,42 @@ public:
   // entire event is rejected. This is turned on by default
   void rejectEventOnPtFailure(bool flag = true);
 
-  // clears all selection criteria back to default (no cut)
+  // adds a cut given as an expression over the fields in expressionFields(),
+  // for instance "nHitsFit / nHitsMax > 0.52 && abs(gDCAz) < 1" (see
+  // CutExpression for the syntax). Tracks are rejected if the expression is
+  // zero. Throws an AssertionFailure if the expression is not valid
+  void addExpression(const std::string &expression);
+  const std::vector<CutExpression> &expressions() const {
+    return expressions_;
+  }
+
+  // the track fields that can be used in expressions. pt, eta, phi and p use
+  // primary or global momentum, the same as the other cuts
+  static const std::vector<std::string> &expressionFields();
+
+  // counts the tracks tested and passed by each cut, and by the selector as a
+  // whole (see CutFlow), in both select() and selectBatch(). Counting is off
+  // by default
+  CutFlow &cutFlow() { return cut_flow_; }
+  const CutFlow &cutFlow() const { return cut_flow_; }
+
+  // names of the cuts in cutFlow(), in the order they are applied by default
+  static const std::vector<std::string> &cutNames();
+
+  // turns on adaptive cut ordering in select() (see CutOrder): after
+  // measuring the first warmup tracks, the cuts are applied in the order that
+  // rejects tracks with the least work. The pT max cut is always applied last,
+  // since only tracks passing every other cut can reject the event. Accepted
+  // tracks are the same in either mode. selectBatch() evaluates every cut for
+  // every track, so it is not affected
+  void useAdaptiveCutOrder(bool flag, unsigned warmup = 1000);
+  bool adaptiveCutOrder() const { return cut_order_.adaptive(); }
+
+  // the order in which the cuts are applied, as indices into cutNames()
+  const CutOrder &cutOrder() const { return cut_order_; }
+
+  // clears all selection criteria back to default (no cut). The cut flow
+  // counts are kept
   void clear();
 
 protected:
@@ -62,8 +114,17 @@ protected:
   bool checkChi2(StPicoTrack *track);
   bool checkPtMax(StPicoTrack *track, bool is_primary);
   bool checkPtMin(StPicoTrack *track, bool is_primary);
+  bool checkExpressions(StPicoTrack *track, TVector3 vertex, bool is_primary);
 
 private:
+  // whether cut (an index into cutNames()) is active, and its result
+  bool cutActive(unsigned cut, bool primary) const;
+  bool checkCut(unsigned cut, StPicoTrack *track, const TVector3 &vertex,
+                bool primary);
+
+  // applies all active cuts except the pT max cut in the order of cut_order_
+  bool checkOrdered(StPicoTrack *track, const TVector3 &vertex, bool primary);
+
   bool dca_active_;
   bool nhits_active_;
   bool nhits_frac_active_;
@@ -79,6 +140,19 @@ private:
   double chi2_max_;
   double pt_max_;
   double pt_min_;
+
+  std::vector<CutExpression> expressions_;
+  // all fields used by any of the expressions
+  std::vector<unsigned> expression_fields_;
+  // the columns the expressions are evaluated over by selectBatch(), and the
+  // values of the fields that are not cached in the TrackTable. Reused between
+  // events
+  mutable std::vector<const double *> expression_columns_;
+  mutable std::vector<std::vector<double>> expression_storage_;
+
+  // counted by the const selectBatch() as well
+  mutable CutFlow cut_flow_;
+  CutOrder cut_order_;
 };
 
 } // namespace jetreader
@@ -1,6 +1,12 @@
 #include "gtest/gtest.h"
 
+#include "jetreader/lib/assert.h"
 #include "jetreader/reader/track_selector.h"
+#include "jetreader/reader/track_table.h"
+
+#include <cstdint>
+#include <random>
+#include <vector>
 
 #include "StPicoEvent/StPicoTrack.h"
 
@@ -200,4 +206,196 @@ TEST(TrackSelector, PtMin) {
   StPicoTrack global_track;
   global_track.setGlobalMomentum(20.0, 0, 0);
   EXPECT_EQ(false, selector.checkPtMin(&global_track));
-}
\ No newline at end of file
+}
+// random tracks, with a mix of primary and global-only tracks
+std::vector<StPicoTrack> MakeRandomTracks(size_t n, unsigned seed) {
+  std::default_random_engine gen(seed);
+  std::uniform_real_distribution<double> mom(-15.0, 15.0);
+  std::uniform_real_distribution<double> origin(-2.0, 2.0);
+  std::uniform_int_distribution<int> nhits(-45, 45);
+  std::uniform_int_distribution<int> nhits_poss(0, 50);
+  std::uniform_real_distribution<double> chi2(0.0, 5.0);
+  std::uniform_real_distribution<double> prob(0.0, 1.0);
+
+  std::vector<StPicoTrack> tracks(n);
+  for (auto &track : tracks) {
+    TVector3 p(mom(gen), mom(gen), mom(gen));
+    track.setGlobalMomentum(p);
+    if (prob(gen) < 0.8)
+      track.setPrimaryMomentum(p);
+    track.setOrigin(origin(gen), origin(gen), origin(gen));
+    track.setNHitsFit(nhits(gen));
+    track.setNHitsPossible(nhits_poss(gen));
+    track.setChi2(chi2(gen));
+  }
+  return tracks;
+}
+
+void ExpectBatchMatchesSelect(jetreader::TrackSelector &selector,
+                              std::vector<StPicoTrack> &tracks, bool primary) {
+  TVector3 vertex(0.1, -0.2, 0.5);
+  jetreader::TrackTable table;
+  for (auto &track : tracks)
+    table.add(track, vertex, primary);
+  ASSERT_EQ(table.size(), tracks.size());
+
+  std::vector<uint8_t> mask;
+  bool accept_event = selector.selectBatch(table, primary, mask);
+  ASSERT_EQ(mask.size(), tracks.size());
+
+  bool expected_accept_event = true;
+  for (size_t i = 0; i < tracks.size(); ++i) {
+    auto status = selector.select(&tracks[i], vertex, primary);
+    EXPECT_EQ(mask[i] == 1, status == jetreader::TrackStatus::acceptTrack);
+    if (status == jetreader::TrackStatus::rejectEvent)
+      expected_accept_event = false;
+  }
+  EXPECT_EQ(accept_event, expected_accept_event);
+}
+
+TEST(TrackSelector, SelectBatch) {
+  std::vector<StPicoTrack> tracks = MakeRandomTracks(1000, 11);
+
+  for (bool primary : {true, false}) {
+    jetreader::TrackSelector selector;
+    ExpectBatchMatchesSelect(selector, tracks, primary);
+
+    selector.setDcaMax(1.5);
+    ExpectBatchMatchesSelect(selector, tracks, primary);
+    selector.setNHitsMin(15);
+    ExpectBatchMatchesSelect(selector, tracks, primary);
+    selector.setNHitsFracMin(0.52);
+    ExpectBatchMatchesSelect(selector, tracks, primary);
+    selector.setChi2Max(3.0);
+    ExpectBatchMatchesSelect(selector, tracks, primary);
+    selector.setPtMin(0.2);
+    ExpectBatchMatchesSelect(selector, tracks, primary);
+
+    // with a pT max cut, some tracks reject the event
+    selector.setPtMax(15.0);
+    ExpectBatchMatchesSelect(selector, tracks, primary);
+    selector.rejectEventOnPtFailure(false);
+    ExpectBatchMatchesSelect(selector, tracks, primary);
+  }
+
+  jetreader::TrackSelector selector;
+  jetreader::TrackTable empty;
+  std::vector<uint8_t> mask{1, 1};
+  EXPECT_TRUE(selector.selectBatch(empty, true, mask));
+  EXPECT_TRUE(mask.empty());
+}
+
+TEST(TrackSelector, Expressions) {
+  StPicoTrack track;
+  track.setPrimaryMomentum(TVector3(1.0, 0, 0));
+  track.setOrigin(0.0, 0.0, 0.5);
+  track.setNHitsFit(17);
+  track.setNHitsPossible(30);
+  TVector3 vertex(0, 0, 0);
+
+  jetreader::TrackSelector selector;
+  selector.addExpression("nHitsFit / nHitsMax > 0.52 && abs(gDCAz) < 1");
+  EXPECT_EQ(jetreader::TrackStatus::acceptTrack,
+            selector.select(&track, vertex));
+
+  track.setOrigin(0.0, 0.0, -1.5);
+  EXPECT_EQ(jetreader::TrackStatus::rejectTrack,
+            selector.select(&track, vertex));
+  track.setOrigin(0.0, 0.0, 0.5);
+  track.setNHitsFit(15);
+  EXPECT_EQ(jetreader::TrackStatus::rejectTrack,
+            selector.select(&track, vertex));
+
+  EXPECT_THROW(selector.addExpression("pT > 1"), jetreader::AssertionFailure);
+  EXPECT_EQ(selector.expressions().size(), 1);
+  selector.clear();
+  EXPECT_TRUE(selector.expressions().empty());
+}
+
+TEST(TrackSelector, SelectBatchExpressions) {
+  std::vector<StPicoTrack> tracks = MakeRandomTracks(1000, 13);
+
+  for (bool primary : {true, false}) {
+    jetreader::TrackSelector selector;
+    selector.addExpression("abs(gDCAz) < 1.5 && pt * chi2 < 10");
+    ExpectBatchMatchesSelect(selector, tracks, primary);
+    selector.addExpression("abs(eta) < 1 || nHitsFrac > 0.6");
+    ExpectBatchMatchesSelect(selector, tracks, primary);
+
+    selector.setDcaMax(2.5);
+    selector.setPtMax(12.0);
+    ExpectBatchMatchesSelect(selector, tracks, primary);
+  }
+}
+
+TEST(TrackSelector, CutFlow) {
+  std::vector<StPicoTrack> tracks = MakeRandomTracks(1000, 13);
+  TVector3 vertex(0.1, -0.2, 0.5);
+  jetreader::TrackTable table;
+  for (auto &track : tracks)
+    table.add(track, vertex, true);
+
+  // select() and selectBatch() count the same tracks for every cut
+  jetreader::TrackSelector per_track;
+  jetreader::TrackSelector batch;
+  for (auto selector : {&per_track, &batch}) {
+    selector->setDcaMax(1.5);
+    selector->setNHitsMin(15);
+    selector->setChi2Max(3.0);
+    selector->setPtMax(15.0);
+    selector->rejectEventOnPtFailure(false);
+    selector->addExpression("abs(eta) < 0.8");
+    selector->cutFlow().setActive(true);
+  }
+
+  unsigned accepted = 0;
+  for (auto &track : tracks)
+    accepted += per_track.select(&track, vertex, true) ==
+                jetreader::TrackStatus::acceptTrack;
+  std::vector<uint8_t> mask;
+  batch.selectBatch(table, true, mask);
+
+  const jetreader::CutFlow &flow = per_track.cutFlow();
+  EXPECT_EQ(flow.tested(), tracks.size());
+  EXPECT_EQ(flow.accepted(), accepted);
+  EXPECT_EQ(flow.cuts()[flow.index("primary")].tested, tracks.size());
+  EXPECT_EQ(flow.cuts()[flow.index("nHitsFrac")].tested, 0);
+  for (size_t i = 0; i < flow.cuts().size(); ++i) {
+    EXPECT_EQ(flow.cuts()[i].tested, batch.cutFlow().cuts()[i].tested);
+    EXPECT_EQ(flow.cuts()[i].passed, batch.cutFlow().cuts()[i].passed);
+  }
+  EXPECT_EQ(batch.cutFlow().tested(), tracks.size());
+  EXPECT_EQ(batch.cutFlow().accepted(), accepted);
+}
+
+TEST(TrackSelector, AdaptiveCutOrder) {
+  std::vector<StPicoTrack> tracks = MakeRandomTracks(1000, 17);
+  TVector3 vertex(0.1, -0.2, 0.5);
+
+  for (bool primary : {true, false}) {
+    jetreader::TrackSelector fixed;
+    jetreader::TrackSelector adaptive;
+    for (auto selector : {&fixed, &adaptive}) {
+      selector->setDcaMax(1.5);
+      selector->setNHitsMin(15);
+      selector->setNHitsFracMin(0.52);
+      selector->setChi2Max(3.0);
+      selector->setPtMax(15.0);
+      selector->addExpression("abs(eta) < 0.8");
+      selector->cutFlow().setActive(true);
+    }
+    adaptive.useAdaptiveCutOrder(true, 100);
+
+    // the decisions, including events rejected by the pT max cut, are the
+    // same during and after the warmup
+    for (auto &track : tracks)
+      EXPECT_EQ(fixed.select(&track, vertex, primary),
+                adaptive.select(&track, vertex, primary));
+    EXPECT_FALSE(adaptive.cutOrder().warmingUp());
+    EXPECT_EQ(fixed.cutFlow().accepted(), adaptive.cutFlow().accepted());
+
+    auto ptmax = fixed.cutFlow().index("ptMax");
+    EXPECT_EQ(fixed.cutFlow().cuts()[ptmax].tested,
+              adaptive.cutFlow().cuts()[ptmax].tested);
+  }
+}
@@ -0,0 +1,54 @@
+#include "jetreader/reader/track_table.h"
+
+namespace jetreader {
+
+void TrackTable::add(const StPicoTrack &track, const TVector3 &vertex,
+                     bool primary) {
+  is_primary_.push_back(track.isPrimary());
+  dca_.push_back(track.gDCA(vertex).Mag());
+  nhits_.push_back(track.nHits());
+  nhits_frac_.push_back((double)track.nHits() / track.nHitsPoss());
+  chi2_.push_back(track.chi2());
+  pt_.push_back(primary ? track.pPt() : track.gPt());
+  eta_.push_back(0.0);
+  phi_.push_back(0.0);
+  p_.push_back(0.0);
+  tracks_.push_back(&track);
+  vertex_ = vertex;
+}
+
+void TrackTable::setKinematics(size_t idx, const StPicoTrack &track,
+                               bool primary) {
+  TVector3 mom = primary ? track.pMom() : track.gMom();
+  eta_[idx] = mom.Eta();
+  phi_[idx] = mom.Phi();
+  p_[idx] = primary ? track.pPtot() : track.gPtot();
+}
+
+void TrackTable::clear() {
+  is_primary_.clear();
+  dca_.clear();
+  nhits_.clear();
+  nhits_frac_.clear();
+  chi2_.clear();
+  pt_.clear();
+  eta_.clear();
+  phi_.clear();
+  p_.clear();
+  tracks_.clear();
+}
+
+void TrackTable::reserve(size_t n) {
+  is_primary_.reserve(n);
+  dca_.reserve(n);
+  nhits_.reserve(n);
+  nhits_frac_.reserve(n);
+  chi2_.reserve(n);
+  pt_.reserve(n);
+  eta_.reserve(n);
+  phi_.reserve(n);
+  p_.reserve(n);
+  tracks_.reserve(n);
+}
+
+} // namespace jetreader
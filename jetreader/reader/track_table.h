@@ -0,0 +1,68 @@
+#ifndef JETREADER_READER_TRACK_TABLE_H
+#define JETREADER_READER_TRACK_TABLE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "StPicoEvent/StPicoTrack.h"
+
+#include "TVector3.h"
+
+namespace jetreader {
+
+// per-event cache of the derived track quantities, for every track of an
+// event, with one contiguous array per quantity. Filled once per event, then
+// shared by TrackSelector::selectBatch(), the PseudoJet/EventView conversion
+// and the hadronic correction, so that e.g. the DCA or the momentum of a track
+// is only computed once. Entry i describes track i of the StPicoDst.
+class TrackTable {
+public:
+  // appends a track. Quantities are computed exactly as the per-track checks
+  // of the TrackSelector and MakePseudoJet() compute them, with primary or
+  // global momentum. eta, phi and p are left at zero until setKinematics()
+  void add(const StPicoTrack &track, const TVector3 &vertex, bool primary);
+
+  // computes eta, phi and p of entry idx, which must have been added from
+  // track with the same primary flag. These are only needed for accepted
+  // tracks, so they are not computed for every track by add()
+  void setKinematics(size_t idx, const StPicoTrack &track, bool primary);
+
+  void clear();
+  void reserve(size_t n);
+  size_t size() const { return pt_.size(); }
+
+  // 1 if the track has a primary momentum, 0 otherwise
+  const std::vector<uint8_t> &isPrimary() const { return is_primary_; }
+  const std::vector<double> &dca() const { return dca_; }
+  const std::vector<unsigned> &nhits() const { return nhits_; }
+  const std::vector<double> &nhitsFrac() const { return nhits_frac_; }
+  const std::vector<double> &chi2() const { return chi2_; }
+  const std::vector<double> &pt() const { return pt_; }
+  const std::vector<double> &eta() const { return eta_; }
+  const std::vector<double> &phi() const { return phi_; }
+  // total momentum
+  const std::vector<double> &p() const { return p_; }
+
+  // the tracks and vertex the table was filled from, for quantities that are
+  // not cached in the table
+  const std::vector<const StPicoTrack *> &tracks() const { return tracks_; }
+  const TVector3 &vertex() const { return vertex_; }
+
+private:
+  std::vector<uint8_t> is_primary_;
+  std::vector<double> dca_;
+  std::vector<unsigned> nhits_;
+  std::vector<double> nhits_frac_;
+  std::vector<double> chi2_;
+  std::vector<double> pt_;
+  std::vector<double> eta_;
+  std::vector<double> phi_;
+  std::vector<double> p_;
+
+  std::vector<const StPicoTrack *> tracks_;
+  TVector3 vertex_;
+};
+
+} // namespace jetreader
+
+#endif // JETREADER_READER_TRACK_TABLE_H
@@ -0,0 +1,50 @@
+#include "jetreader/reader/track_tower_matcher.h"
+
+#include "jetreader/lib/assert.h"
+
+#include <cmath>
+
+namespace jetreader {
+
+TrackTowerMatcher::TrackTowerMatcher()
+    : eta_(bemc_helper_.towerEtas()), phi_(bemc_helper_.towerPhis()),
+      max_distance_(0.05), vz_(0.0), b_field_(0.0) {}
+
+void TrackTowerMatcher::setMaxDistance(double distance) {
+  JETREADER_ASSERT(distance > 0.0,
+                   "track-tower match distance must be positive, but is ",
+                   distance);
+  max_distance_ = distance;
+}
+
+int TrackTowerMatcher::match(double pt, double eta, double phi,
+                             int charge) const {
+  double barrel_eta, barrel_phi;
+  if (!bemc_helper_.projectToBarrel(pt, eta, phi, charge, vz_, b_field_,
+                                    barrel_eta, barrel_phi))
+    return -1;
+  unsigned cell = bemc_helper_.towerContaining(barrel_eta, barrel_phi);
+  if (cell == 0)
+    return -1;
+
+  int nearest = -1;
+  double nearest_dist2 = max_distance_ * max_distance_;
+  auto check = [&](unsigned tow_id) {
+    unsigned tow_idx = tow_id - 1;
+    double d_eta = barrel_eta - eta_[tow_idx];
+    double d_phi = std::abs(barrel_phi - phi_[tow_idx]);
+    if (d_phi > M_PI)
+      d_phi = 2.0 * M_PI - d_phi;
+    double dist2 = d_eta * d_eta + d_phi * d_phi;
+    if (dist2 < nearest_dist2) {
+      nearest = tow_idx;
+      nearest_dist2 = dist2;
+    }
+  };
+  check(cell);
+  for (unsigned tow_id : bemc_helper_.towerNeighbours(cell))
+    check(tow_id);
+  return nearest;
+}
+
+} // namespace jetreader
@@ -0,0 +1,51 @@
+#ifndef JETREADER_READER_TRACK_TOWER_MATCHER_H
+#define JETREADER_READER_TRACK_TOWER_MATCHER_H
+
+#include "jetreader/reader/bemc_helper.h"
+
+namespace jetreader {
+
+// matches tracks to BEMC towers geometrically, without the tower index stored
+// in the StPicoTrack: each track is projected along its helix to the barrel
+// radius, and matched to the nearest tower within maxDistance() in eta-phi.
+// Only the tower whose eta-phi grid cell contains the projection and its
+// neighbours are compared, so matching takes constant time per track. Towers
+// are indexed by tower id - 1.
+class TrackTowerMatcher {
+public:
+  TrackTowerMatcher();
+
+  // maximum distance sqrt(d_eta^2 + d_phi^2) between the projected track and
+  // the center of its tower. Throws an AssertionFailure unless distance > 0.
+  // Only neighbouring towers are searched, so distances larger than a tower
+  // width (0.05) do not match any further towers. Default 0.05
+  void setMaxDistance(double distance);
+  double maxDistance() const { return max_distance_; }
+
+  // the vertex position along the beam line and the magnetic field (kGauss)
+  // of the event that tracks are matched in
+  void setEvent(double vz, double b_field) {
+    vz_ = vz;
+    b_field_ = b_field;
+  }
+
+  // the index of the tower nearest to the projection of a track with
+  // transverse momentum pt, eta and phi at the vertex, or -1 if the track
+  // does not reach the barrel or no tower is within maxDistance()
+  int match(double pt, double eta, double phi, int charge) const;
+
+  const BemcHelper &bemcHelper() const { return bemc_helper_; }
+
+private:
+  BemcHelper bemc_helper_;
+  Span<const double> eta_;
+  Span<const double> phi_;
+
+  double max_distance_;
+  double vz_;
+  double b_field_;
+};
+
+} // namespace jetreader
+
+#endif // JETREADER_READER_TRACK_TOWER_MATCHER_H
@@ -0,0 +1,79 @@
+#include "gtest/gtest.h"
+
+#include "jetreader/lib/assert.h"
+#include "jetreader/reader/track_tower_matcher.h"
+
+#include <cmath>
+#include <random>
+
+namespace {
+// the nearest tower to (eta, phi) within max_distance, searching all towers
+int NearestTower(const jetreader::BemcHelper &helper, double eta, double phi,
+                 double max_distance) {
+  int nearest = -1;
+  double nearest_dist2 = max_distance * max_distance;
+  for (unsigned tow_id = 1; tow_id <= jetreader::BemcHelper::TOWERS;
+       ++tow_id) {
+    double d_eta = eta - helper.towerEta(tow_id);
+    double d_phi = std::abs(phi - helper.towerPhi(tow_id));
+    if (d_phi > M_PI)
+      d_phi = 2.0 * M_PI - d_phi;
+    double dist2 = d_eta * d_eta + d_phi * d_phi;
+    if (dist2 < nearest_dist2) {
+      nearest = tow_id - 1;
+      nearest_dist2 = dist2;
+    }
+  }
+  return nearest;
+}
+} // namespace
+
+TEST(TrackTowerMatcher, TowerCenters) {
+  jetreader::TrackTowerMatcher matcher;
+  const jetreader::BemcHelper &helper = matcher.bemcHelper();
+  // neutral tracks from the center of the detector point at the towers
+  for (unsigned tow_id = 1; tow_id <= jetreader::BemcHelper::TOWERS; ++tow_id)
+    EXPECT_EQ(matcher.match(1.0, helper.towerEta(tow_id),
+                            helper.towerPhi(tow_id), 0),
+              (int)tow_id - 1);
+
+  matcher.setMaxDistance(0.01);
+  EXPECT_EQ(matcher.match(1.0, helper.towerEta(1) + 0.02, helper.towerPhi(1),
+                          0),
+            -1);
+  EXPECT_EQ(matcher.match(1.0, 1.5, 0.0, 0), -1);
+}
+
+TEST(TrackTowerMatcher, MatchesNearestTower) {
+  std::default_random_engine gen(13);
+  std::uniform_real_distribution<double> pt(0.2, 10.0);
+  std::uniform_real_distribution<double> eta(-1.2, 1.2);
+  std::uniform_real_distribution<double> phi(-M_PI, M_PI);
+  std::uniform_real_distribution<double> vz(-30.0, 30.0);
+
+  jetreader::TrackTowerMatcher matcher;
+  matcher.setMaxDistance(0.04);
+  const jetreader::BemcHelper &helper = matcher.bemcHelper();
+  for (int i = 0; i < 2000; ++i) {
+    double track_pt = pt(gen), track_eta = eta(gen), track_phi = phi(gen);
+    int charge = i % 2 ? 1 : -1;
+    double event_vz = vz(gen);
+    matcher.setEvent(event_vz, 4.98);
+
+    int expected = -1;
+    double barrel_eta, barrel_phi;
+    if (helper.projectToBarrel(track_pt, track_eta, track_phi, charge,
+                               event_vz, 4.98, barrel_eta, barrel_phi) &&
+        helper.towerContaining(barrel_eta, barrel_phi) != 0)
+      expected = NearestTower(helper, barrel_eta, barrel_phi, 0.04);
+    EXPECT_EQ(matcher.match(track_pt, track_eta, track_phi, charge), expected);
+  }
+}
+
+TEST(TrackTowerMatcher, MaxDistance) {
+  jetreader::TrackTowerMatcher matcher;
+  EXPECT_DOUBLE_EQ(matcher.maxDistance(), 0.05);
+  matcher.setMaxDistance(0.03);
+  EXPECT_DOUBLE_EQ(matcher.maxDistance(), 0.03);
+  EXPECT_THROW(matcher.setMaxDistance(0.0), jetreader::AssertionFailure);
+}
@@ -13,28 +13,53 @@ VectorInfo::VectorInfo(const StPicoBTowHit &hit, unsigned idx, double raw_eta,
 
 void VectorInfo::setTrack(const StPicoTrack &track, TVector3 vtx,
                           bool primary) {
-  clear();
-  is_tpc_track_ = true;
-  is_primary_ = primary;
-  track_id_ = track.id();
-  dca_ = track.gDCA(vtx).Mag();
-  nhits_ = track.nHitsFit();
-  nhits_poss_ = track.nHitsPoss();
-  matched_tower_ = track.bemcTowerIndex();
-  charge_ = track.charge();
+  setTrack(track.id(), primary, track.charge(), track.gDCA(vtx).Mag(),
+           track.nHitsFit(), track.nHitsPoss(), track.bemcTowerIndex());
 }
 
 void VectorInfo::setTower(const StPicoBTowHit &hit, unsigned idx,
                           double raw_eta,
                           std::vector<unsigned> &matched_tracks) {
+  setTower(idx, hit.adc(), raw_eta, hit.energy(), matched_tracks);
+}
+
+void VectorInfo::setTower(const StPicoBTowHit &hit, unsigned idx,
+                          double raw_eta,
+                          Span<const unsigned> matched_tracks) {
+  setTower(idx, hit.adc(), raw_eta, hit.energy(), matched_tracks);
+}
+
+void VectorInfo::setTrack(unsigned track_id, bool primary, int charge,
+                          double dca, unsigned nhits, unsigned nhits_poss,
+                          unsigned matched_tower) {
+  clear();
+  is_tpc_track_ = true;
+  is_primary_ = primary;
+  track_id_ = track_id;
+  dca_ = dca;
+  nhits_ = nhits;
+  nhits_poss_ = nhits_poss;
+  matched_tower_ = matched_tower;
+  charge_ = charge;
+}
+
+void VectorInfo::setTower(unsigned idx, unsigned adc, double raw_eta,
+                          double raw_e,
+                          const std::vector<unsigned> &matched_tracks) {
+  setTower(idx, adc, raw_eta, raw_e,
+           Span<const unsigned>(matched_tracks.data(), matched_tracks.size()));
+}
+
+void VectorInfo::setTower(unsigned idx, unsigned adc, double raw_eta,
+                          double raw_e, Span<const unsigned> matched_tracks) {
   clear();
   is_bemc_tower_ = true;
   tower_id_ = idx;
-  tower_adc_ = hit.adc();
+  tower_adc_ = adc;
   tower_raw_eta_ = raw_eta;
-  tower_raw_e_ = hit.energy();
+  tower_raw_e_ = raw_e;
   charge_ = 0;
-  matched_tracks_ = matched_tracks;
+  matched_tracks_.assign(matched_tracks.begin(), matched_tracks.end());
 }
 
 void VectorInfo::clear() {
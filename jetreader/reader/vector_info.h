@@ -1,6 +1,8 @@
 #ifndef JETREADER_READER_VECTOR_INFO_H
 #define JETREADER_READER_VECTOR_INFO_H
 
+#include "jetreader/lib/span.h"
+
 #include "fastjet/PseudoJet.hh"
 
 #include "StPicoEvent/StPicoBTowHit.h"
@@ -28,12 +30,27 @@ public:
   void setTower(const StPicoBTowHit &hit, unsigned idx, double raw_eta,
                 std::vector<unsigned> &matched_tracks);
 
+  // same as above, with the matched tracks copied from a view, such as a row
+  // of the Reader's TowerMatches. The VectorInfo keeps its own copy, so it
+  // stays valid after the event, and reused VectorInfos do not allocate
+  void setTower(const StPicoBTowHit &hit, unsigned idx, double raw_eta,
+                Span<const unsigned> matched_tracks);
+
+  // same as above, from the individual fields, as stored in an EventView
+  void setTrack(unsigned track_id, bool primary, int charge, double dca,
+                unsigned nhits, unsigned nhits_poss, unsigned matched_tower);
+  void setTower(unsigned idx, unsigned adc, double raw_eta, double raw_e,
+                const std::vector<unsigned> &matched_tracks);
+  void setTower(unsigned idx, unsigned adc, double raw_eta, double raw_e,
+                Span<const unsigned> matched_tracks);
+
   // clears current state
   void clear();
 
   bool isPrimary() const { return is_tpc_track_ && is_primary_; }
   bool isGlobal() const { return is_tpc_track_ && !is_primary_; }
-  bool isBemcTower() { return is_bemc_tower_; }
+  bool isBemcTower() const { return is_bemc_tower_; }
+  int charge() const { return charge_; }
   unsigned trackId() const { return track_id_; }
   double dca() const { return dca_; }
   unsigned nhits() const { return nhits_; }
@@ -43,7 +60,7 @@ public:
   unsigned towerAdc() const { return tower_adc_; }
   double towerRawEta() const { return tower_raw_eta_; }
   double towerRawE() const { return tower_raw_e_; }
-  std::vector<unsigned> matchedTracks() const { return matched_tracks_; }
+  const std::vector<unsigned> &matchedTracks() const { return matched_tracks_; }
 
 private:
   // global info
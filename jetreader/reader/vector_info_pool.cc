@@ -0,0 +1,28 @@
+#include "jetreader/reader/vector_info_pool.h"
+
+namespace jetreader {
+
+VectorInfo &VectorInfoPool::attach(fastjet::PseudoJet &pj) {
+  if (next_ == slots_.size()) {
+    slots_.emplace_back(new VectorInfo);
+    ++allocations_;
+  } else if (slots_[next_].use_count() > 1) {
+    // still in use by a copy of an older PseudoJet - leave it to that copy
+    slots_[next_].reset(new VectorInfo);
+    ++allocations_;
+  }
+
+  pj.set_user_info_shared_ptr(slots_[next_]);
+  return static_cast<VectorInfo &>(*slots_[next_++]);
+}
+
+void VectorInfoPool::unshare() {
+  for (auto &slot : slots_) {
+    if (slot.use_count() > 1) {
+      slot.reset(new VectorInfo);
+      ++allocations_;
+    }
+  }
+}
+
+} // namespace jetreader
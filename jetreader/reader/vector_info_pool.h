@@ -0,0 +1,54 @@
+#ifndef JETREADER_READER_VECTOR_INFO_POOL_H
+#define JETREADER_READER_VECTOR_INFO_POOL_H
+
+#include <cstddef>
+#include <vector>
+
+#include "jetreader/reader/vector_info.h"
+
+#include "fastjet/PseudoJet.hh"
+
+namespace jetreader {
+
+// owns the VectorInfo objects attached to the PseudoJets of an event, and
+// reuses them for the next event. After the first few events, building the
+// user info for an event requires no heap allocation.
+//
+// A VectorInfo is only reused once nothing outside of the pool references it.
+// If the user keeps copies of an event's PseudoJets, the slot is handed over to
+// those copies, and a new VectorInfo is allocated in its place.
+class VectorInfoPool {
+public:
+  VectorInfoPool() : next_(0), allocations_(0) {}
+
+  // attaches an unused VectorInfo to pj as its user info, and returns it to be
+  // filled by the caller
+  VectorInfo &attach(fastjet::PseudoJet &pj);
+
+  // called at the start of each event - all VectorInfos attached during the
+  // previous event become available again
+  void reset() { next_ = 0; }
+
+  // replaces every VectorInfo that is still referenced outside of the pool by
+  // a new one, leaving the old one to its PseudoJets. Afterwards no reference
+  // count is shared with a PseudoJet, so the pool can be handed to another
+  // thread
+  void unshare();
+
+  // number of VectorInfos owned by the pool
+  size_t size() const { return slots_.size(); }
+
+  // number of VectorInfos the pool has allocated, either to grow or to
+  // replace one handed over to a user copy. Once the pool is large enough,
+  // this stays constant between events
+  size_t allocations() const { return allocations_; }
+
+private:
+  std::vector<fastjet::SharedPtr<fastjet::PseudoJet::UserInfoBase>> slots_;
+  size_t next_;
+  size_t allocations_;
+};
+
+} // namespace jetreader
+
+#endif // JETREADER_READER_VECTOR_INFO_POOL_H
@@ -0,0 +1,131 @@
+#include "gtest/gtest.h"
+
+#include "jetreader/reader/reader_utils.h"
+#include "jetreader/reader/vector_info.h"
+#include "jetreader/reader/vector_info_pool.h"
+
+#include <vector>
+
+#include "fastjet/PseudoJet.hh"
+
+#include "StPicoEvent/StPicoBTowHit.h"
+#include "StPicoEvent/StPicoTrack.h"
+
+#include "TVector3.h"
+
+// a synthetic event, built the same way the Reader builds pseudojets
+struct TestEvent {
+  TestEvent() : tracks(500), towers(300), matched(300) {
+    for (unsigned i = 0; i < tracks.size(); ++i) {
+      tracks[i].setId(i);
+      tracks[i].setPrimaryMomentum(TVector3(1.0, 0.5 + 0.01 * i, 2.0));
+      tracks[i].setGlobalMomentum(TVector3(1.0, 0.5 + 0.01 * i, 2.0));
+      tracks[i].setOrigin(TVector3(0.1, 0.1, 0.0));
+      tracks[i].setNHitsFit(20);
+      tracks[i].setNHitsPossible(30);
+    }
+    for (unsigned i = 0; i < towers.size(); ++i) {
+      towers[i].setAdc(20);
+      towers[i].setEnergy(1.0 + 0.01 * i);
+      if (i % 3 == 0)
+        matched[i] = {i, i + 1};
+    }
+  }
+
+  void build(jetreader::VectorInfoPool &pool,
+             std::vector<fastjet::PseudoJet> &pseudojets) {
+    TVector3 vertex(0, 0, 0);
+    pool.reset();
+    pseudojets.clear();
+    for (auto &track : tracks)
+      pseudojets.push_back(jetreader::MakePseudoJet(pool, track, vertex));
+    for (unsigned i = 0; i < towers.size(); ++i)
+      pseudojets.push_back(jetreader::MakePseudoJet(
+          pool, towers[i], i + 1, 0.5, 1.0, 0.5, 2.0, matched[i]));
+  }
+
+  std::vector<StPicoTrack> tracks;
+  std::vector<StPicoBTowHit> towers;
+  std::vector<std::vector<unsigned>> matched;
+};
+
+TEST(VectorInfoPool, NoAllocationAfterWarmup) {
+  TestEvent event;
+  jetreader::VectorInfoPool pool;
+  std::vector<fastjet::PseudoJet> pseudojets;
+
+  // the first event fills the pool
+  event.build(pool, pseudojets);
+  EXPECT_EQ(pool.size(), event.tracks.size() + event.towers.size());
+
+  size_t before = pool.allocations();
+  EXPECT_EQ(before, pool.size());
+  for (int i = 0; i < 10; ++i)
+    event.build(pool, pseudojets);
+  EXPECT_EQ(pool.allocations(), before);
+  EXPECT_EQ(pool.size(), event.tracks.size() + event.towers.size());
+}
+
+TEST(VectorInfoPool, UserInfo) {
+  TestEvent event;
+  jetreader::VectorInfoPool pool;
+  std::vector<fastjet::PseudoJet> pseudojets;
+  event.build(pool, pseudojets);
+  event.build(pool, pseudojets);
+
+  auto &track_info = pseudojets[10].user_info<jetreader::VectorInfo>();
+  EXPECT_TRUE(track_info.isPrimary());
+  EXPECT_EQ(track_info.trackId(), 10);
+  EXPECT_EQ(track_info.nhits(), 20);
+  EXPECT_NEAR(track_info.dca(), TVector3(0.1, 0.1, 0.0).Mag(), 1e-5);
+
+  auto &tower_info =
+      pseudojets[event.tracks.size() + 3].user_info<jetreader::VectorInfo>();
+  EXPECT_EQ(tower_info.towerId(), 4);
+  EXPECT_EQ(tower_info.matchedTracks(), event.matched[3]);
+  auto &unmatched_info =
+      pseudojets[event.tracks.size() + 4].user_info<jetreader::VectorInfo>();
+  EXPECT_TRUE(unmatched_info.matchedTracks().empty());
+}
+
+TEST(VectorInfoPool, UserCopiesAreKept) {
+  TestEvent event;
+  jetreader::VectorInfoPool pool;
+  std::vector<fastjet::PseudoJet> pseudojets;
+  event.build(pool, pseudojets);
+
+  // a copy of the first track outlives its event - its user info must not be
+  // reused for the next event
+  fastjet::PseudoJet kept = pseudojets[0];
+  event.tracks[0].setId(1000);
+  event.build(pool, pseudojets);
+
+  EXPECT_EQ(kept.user_info<jetreader::VectorInfo>().trackId(), 0);
+  EXPECT_EQ(pseudojets[0].user_info<jetreader::VectorInfo>().trackId(), 1000);
+  EXPECT_NE(kept.user_info_shared_ptr().get(),
+            pseudojets[0].user_info_shared_ptr().get());
+  // only the kept VectorInfo was replaced
+  EXPECT_EQ(pool.allocations(), pool.size() + 1);
+}
+
+TEST(VectorInfoPool, Unshare) {
+  TestEvent event;
+  jetreader::VectorInfoPool pool;
+  std::vector<fastjet::PseudoJet> pseudojets;
+  event.build(pool, pseudojets);
+
+  fastjet::PseudoJet kept = pseudojets[0];
+  pseudojets.clear();
+  size_t allocations = pool.allocations();
+  pool.unshare();
+
+  // only the VectorInfo of the kept copy is replaced, and the copy is the
+  // only owner of its VectorInfo
+  EXPECT_EQ(pool.allocations(), allocations + 1);
+  EXPECT_EQ(kept.user_info_shared_ptr().use_count(), 1);
+  EXPECT_EQ(kept.user_info<jetreader::VectorInfo>().trackId(), 0);
+
+  // the pool still reuses the rest without allocating
+  event.build(pool, pseudojets);
+  EXPECT_EQ(pool.allocations(), allocations + 1);
+}